@@ -2,6 +2,7 @@
 #extension GL_EXT_buffer_reference : require
 #extension GL_EXT_shader_explicit_arithmetic_types : require
 #extension GL_EXT_scalar_block_layout : require
+#extension GL_GOOGLE_include_directive : require
 
 
 struct Vertex {
@@ -13,9 +14,7 @@ struct Vertex {
 
 layout(push_constant, scalar) uniform PushConstants {
     uint64_t vertexBufferAddress;
-    uint32_t baseColorTextureIndex;
-    uint32_t metalRoughTextureIndex;
-    uint32_t normalTextureIndex;
+    uint64_t primitiveBufferAddress;
     uint32_t textureCount;
     vec3 modelScale;
 } pushConstants;
@@ -24,10 +23,14 @@ layout(buffer_reference, scalar) readonly buffer VertexBuffer {
     Vertex vertices[];
 };
 
+#include "primitive_data.glsl"
+
 layout(binding = 0, scalar) uniform UniformBufferObject {
     mat4 model;
     mat4 view;
     mat4 proj;
+    mat4 invView;
+    mat4 invProj;
     vec3 cameraPosition;
 } ubo;
 
@@ -35,13 +38,16 @@ layout(binding = 0, scalar) uniform UniformBufferObject {
 layout(location = 0) out vec2 vTexCoord;
 layout(location = 1) flat out uint vMaterial;
 
+// Must match gbuffer.vert bit for bit: the G-buffer pass tests against this depth with EQUAL
+invariant gl_Position;
+
 void main() {
     VertexBuffer vertexBuffer = VertexBuffer(pushConstants.vertexBufferAddress);
     Vertex v = vertexBuffer.vertices[gl_VertexIndex];
 
     vec3 scaledPos = v.pos;
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(scaledPos, 1.0);//ubo.proj * ubo.view * ubo.model * vec4(scaledPos, 1.0);
+    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(scaledPos, 1.0);
 
     vTexCoord = v.texCoord;
-    vMaterial = pushConstants.baseColorTextureIndex;
+    vMaterial = PrimitiveBuffer(pushConstants.primitiveBufferAddress).primitives[gl_InstanceIndex].baseColorTextureIndex;
 }
\ No newline at end of file
@@ -1,5 +1,8 @@
 #version 450
 #extension GL_EXT_nonuniform_qualifier : enable
+#extension GL_GOOGLE_include_directive : require
+
+#include "octahedral.glsl"
 
 // Inputs from vertex shader
 layout(location = 0) in vec3 vWorldPos;     // For depth if needed or lighting
@@ -17,9 +20,10 @@ layout(binding = 2) uniform sampler2D normalTextures[];
 layout(binding = 5) uniform sampler2D metallicRoughnessTextures[];
 
 // G-Buffer outputs
-layout(location = 0) out vec4 outAlbedo;   // Albedo (RGBA, VK_FORMAT_R8G8B8A8_UNORM)
-layout(location = 1) out vec4 outNormal;   // Normal.xyz (RGB16F, VK_FORMAT_R16G16B16A16_SFLOAT)
-layout(location = 2) out vec2 outParams;   // Roughness/Metallic (RG8, VK_FORMAT_R8G8_UNORM)
+// Formats come from GBufferFormats
+layout(location = 0) out vec4 outAlbedo;   // Albedo (RGBA8 sRGB)
+layout(location = 1) out vec2 outNormal;   // Octahedral world normal (RG16 or RG8 UNORM)
+layout(location = 2) out vec2 outParams;   // Roughness/Metallic (RG8 UNORM)
 
 // Normal map intensity - you can make this a uniform if needed
 const float normalMapStrength = 1.0;
@@ -34,9 +38,10 @@ void main() {
     vec3 worldNormal = normalize(vNormal);
 
     if (normalTextureIndex < textureCount) {
-        // 1) Sample normal map with proper mipmapping
-        vec3 tspaceNormal = textureLod(normalTextures[normalTextureIndex], vTexCoord, 1.0).xyz;
-        tspaceNormal = tspaceNormal * 2.0 - 1.0;
+        // 1) Sample normal map with proper mipmapping; only XY is used so two-channel (BC5) maps work too
+        vec3 tspaceNormal;
+        tspaceNormal.xy = texture(normalTextures[normalTextureIndex], vTexCoord).xy * 2.0 - 1.0;
+        tspaceNormal.z = sqrt(max(1.0 - dot(tspaceNormal.xy, tspaceNormal.xy), 0.0));
 
         // 2) Apply adjustable strength with normalization
         tspaceNormal.xy *= normalMapStrength;
@@ -56,8 +61,8 @@ void main() {
         worldNormal = (lenSq > 0.001) ? normalize(mappedNormal) : worldNormal;
     }
 
-    // 6) Encode with reduced precision (avoids storage artifacts)
-    outNormal = vec4(worldNormal * 0.5 + 0.5, 1.0);
+    // 6) Octahedral encode into two UNORM channels
+    outNormal = octEncode(worldNormal) * 0.5 + 0.5;
 
     // --- Metallic / Roughness ---
     vec4 mr = texture(metallicRoughnessTextures[metalRoughTextureIndex], vTexCoord);
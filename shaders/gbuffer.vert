@@ -2,13 +2,12 @@
 #extension GL_EXT_buffer_reference : require
 #extension GL_EXT_shader_explicit_arithmetic_types : require
 #extension GL_EXT_scalar_block_layout : require
+#extension GL_GOOGLE_include_directive : require
 
 // Push‑constants mirror your C++ PushConstants struct
 layout(push_constant, scalar) uniform PushConstants {
     uint64_t vertexBufferAddress;  // SSBO address for vertex pulling
-    uint32_t baseColorTextureIndex;
-    uint32_t metalRoughTextureIndex;
-    uint32_t normalTextureIndex;
+    uint64_t primitiveBufferAddress;
     uint32_t textureCount;
     vec3     modelScale;           // Scale applied in model space
 } pc;
@@ -25,11 +24,15 @@ layout(buffer_reference, scalar) readonly buffer VertexBuffer {
     Vertex vertices[];
 };
 
+#include "primitive_data.glsl"
+
 // UBO for transforms
 layout(binding = 0, scalar) uniform UniformBufferObject {
     mat4 model;
     mat4 view;
     mat4 proj;
+    mat4 invView;
+    mat4 invProj;
     vec3 cameraPosition;
 } ubo;
 
@@ -43,11 +46,15 @@ layout(location = 5) flat out uint metalRoughTextureIndex;
 layout(location = 6) flat out uint normalTextureIndex;
 layout(location = 7) flat out uint textureCount;
 
+// Must match depth.vert bit for bit: depth is tested with EQUAL against the prepass
+invariant gl_Position;
+
 void main() {
     // --- MATERIALS ---
-    baseColorTexture        = pc.baseColorTextureIndex;
-    metalRoughTextureIndex  = pc.metalRoughTextureIndex;
-    normalTextureIndex      = pc.normalTextureIndex;
+    PrimitiveData primitive = PrimitiveBuffer(pc.primitiveBufferAddress).primitives[gl_InstanceIndex];
+    baseColorTexture        = primitive.baseColorTextureIndex;
+    metalRoughTextureIndex  = primitive.metalRoughTextureIndex;
+    normalTextureIndex      = primitive.normalTextureIndex;
     textureCount            = pc.textureCount;
 
     // --- VERTICES ---
@@ -72,5 +79,6 @@ void main() {
     vTexCoord = v.texCoord;
 
     // --- FINAL POSITION ---
-    gl_Position = ubo.proj * ubo.view * worldPos4;
+    // Same expression as depth.vert so both passes produce identical depth
+    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(scaledPos, 1.0);
 }
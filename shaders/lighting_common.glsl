@@ -0,0 +1,270 @@
+// Deferred lighting shared by lighting.frag and lighting.comp: G-buffer decoding, the BRDF,
+// the directional light with its shadow map, IBL and the evaluation of one LightData.
+// Requires GL_EXT_scalar_block_layout and GL_GOOGLE_include_directive.
+
+#include "octahedral.glsl"
+
+layout(binding = 0, scalar) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+    mat4 invView;
+    mat4 invProj;
+    vec3 cameraPosition;
+} ubo;
+
+// Mirrors LightData
+struct LightData {
+    vec3  position;
+    float range;
+    vec3  color;
+    float intensity;  // In lumens
+    vec3  direction;
+    float spotCosOuter;
+    float spotCosInner;
+    uint  type;
+};
+const uint LIGHT_TYPE_SPOT = 1;
+
+layout(binding = 5, scalar) readonly buffer LightBuffer {
+    LightData lights[];
+};
+
+// Built by cluster_lights.comp; mirrors LightClusterer::Header and the cluster lists after it
+const uint MAX_LIGHTS_PER_CLUSTER = 128;
+struct ClusterHeader {
+    uvec3 gridSize;
+    uint  lightCount;
+    vec2  tileSize;
+    float sliceScale;
+    float sliceBias;
+};
+struct Cluster {
+    uint lightCount;
+    uint lightIndices[MAX_LIGHTS_PER_CLUSTER];
+};
+layout(binding = 10, scalar) readonly buffer ClusterBuffer {
+    ClusterHeader header;
+    Cluster clusters[];
+} lightClusters;
+
+const uint SHADOW_CASCADE_COUNT = 4;    // Must match SHADOW_CASCADE_COUNT
+
+layout(binding = 8, scalar) uniform DirectionalLightData {
+    mat4 cascadeViewProj[SHADOW_CASCADE_COUNT];
+    vec4 cascadeSplits;                 // View-space far distance of each cascade
+    vec3 directionalLightDirection;
+    float directionalLightIntensity;    // In lux (lumens/m²)
+    vec3 directionalLightColor;
+    float cascadeBlendWidth;            // Fraction of a cascade blended into the next one
+} directionalLight;
+
+// G-buffer textures
+layout(binding = 1) uniform sampler2D gAlbedo;
+layout(binding = 2) uniform sampler2D gNormal;
+layout(binding = 3) uniform sampler2D gParams;
+layout(binding = 4) uniform sampler2D gDepth;
+layout(binding = 6) uniform samplerCube gCubeMap;
+layout(binding = 7) uniform samplerCube gIrradianceMap;
+layout(binding = 9) uniform sampler2DArrayShadow gShadowMap;  // One layer per cascade
+
+const float PI = 3.141592653589793;
+const float MAX_REFLECTION_LOD = 4.0; // Adjust based on your prefiltered mip levels
+
+// PBR Functions
+float DistributionGGX(vec3 N, vec3 H, float roughness) {
+    float a = roughness * roughness;
+    float a2 = a * a;
+    float NdotH = max(dot(N, H), 0.0);
+    float NdotH2 = NdotH * NdotH;
+    float denom = (NdotH2 * (a2 - 1.0) + 1.0);
+    denom = PI * denom * denom;
+    return a2 / denom;
+}
+
+float GeometrySchlickGGX_Direct(float NdotV, float roughness) {
+    float r = (roughness + 1.0);
+    float k = (r * r) / 8.0;
+    return NdotV / (NdotV * (1.0 - k) + k);
+}
+
+float GeometrySchlickGGX_IBL(float NdotV, float roughness) {
+    float k = (roughness * roughness) / 2.0;
+    return NdotV / (NdotV * (1.0 - k) + k);
+}
+
+float GeometrySmith(vec3 N, vec3 V, vec3 L, float roughness, bool isIBL) {
+    float NdotV = max(dot(N, V), 0.0);
+    float NdotL = max(dot(N, L), 0.0);
+
+    float ggx2, ggx1;
+    if (isIBL) {
+        ggx2 = GeometrySchlickGGX_IBL(NdotV, roughness);
+        ggx1 = GeometrySchlickGGX_IBL(NdotL, roughness);
+    } else {
+        ggx2 = GeometrySchlickGGX_Direct(NdotV, roughness);
+        ggx1 = GeometrySchlickGGX_Direct(NdotL, roughness);
+    }
+
+    return ggx1 * ggx2;
+}
+
+vec3 fresnelSchlick(float cosTheta, vec3 F0) {
+    return F0 + (1.0 - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
+}
+
+vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness) {
+    return F0 + (max(vec3(1.0 - roughness), F0) - F0) *
+    pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
+}
+
+// Calculate direct light contribution with PBR
+vec3 calculateDirectLighting(vec3 N, vec3 V, vec3 L, vec3 albedo,
+float metallic, float roughness, vec3 radiance) {
+    vec3 H = normalize(V + L);
+    vec3 F0 = mix(vec3(0.04), albedo, metallic);
+
+    // Cook-Torrance BRDF
+    float NDF = DistributionGGX(N, H, roughness);
+    float G = GeometrySmith(N, V, L, roughness, false); // false = direct lighting
+    vec3 F = fresnelSchlick(max(dot(H, V), 0.0), F0);
+
+    vec3 numerator = NDF * G * F;
+    float denominator = 4.0 * max(dot(N, V), 0.0) * max(dot(N, L), 0.0) + 0.0001;
+    vec3 specular = numerator / denominator;
+
+    // Energy conservation: kD is reduced by both Fresnel and metallicness
+    vec3 kD = (vec3(1.0) - F) * (1.0 - metallic);
+    vec3 diffuse = kD * albedo / PI;
+
+    float NdotL = max(dot(N, L), 0.0);
+    return (diffuse + specular) * radiance * NdotL;
+}
+
+float calculatePointLightAttenuation(vec3 lightPos, vec3 fragPos, float lightRadius) {
+    float distance = length(lightPos - fragPos);
+    float attenuation = 1.0 / max(distance * distance, 0.0001);
+
+    // Optional: soft cutoff at radius to avoid artifacts
+    float cutoff = 1.0 - smoothstep(lightRadius * 0.8, lightRadius, distance);
+    return attenuation * cutoff;
+}
+
+// 3x3 taps of hardware 2x2 PCF, a 4x4 texel footprint. Explicit zero gradients: the map has no mips,
+// and compute shaders (and the non-uniform cascade branch) have no implicit derivatives.
+float sampleCascade(uint cascade, vec3 worldPos) {
+    vec4 lightSpacePos = directionalLight.cascadeViewProj[cascade] * vec4(worldPos, 1.0);
+    vec3 shadowUV = vec3(lightSpacePos.xy * 0.5 + 0.5, lightSpacePos.z);
+
+    vec2 texelSize = 1.0 / vec2(textureSize(gShadowMap, 0).xy);
+    float lit = 0.0;
+    for (int y = -1; y <= 1; ++y) {
+        for (int x = -1; x <= 1; ++x) {
+            vec2 uv = shadowUV.xy + vec2(x, y) * texelSize;
+            lit += textureGrad(gShadowMap, vec4(uv, float(cascade), shadowUV.z), vec2(0.0), vec2(0.0));
+        }
+    }
+    return lit / 9.0;
+}
+
+float ShadowCalculation(vec3 worldPos) {
+    // Cascades are picked by view depth; past the last one there is no shadow
+    float viewDepth = -(ubo.view * vec4(worldPos, 1.0)).z;
+    uint cascade = 0;
+    while (cascade < SHADOW_CASCADE_COUNT && viewDepth > directionalLight.cascadeSplits[cascade]) {
+        ++cascade;
+    }
+    if (cascade == SHADOW_CASCADE_COUNT) {
+        return 1.0;
+    }
+
+    float shadow = sampleCascade(cascade, worldPos);
+
+    // Near the far end of a cascade, fade into the next one so the resolution change has no seam
+    float cascadeStart = cascade == 0 ? 0.0 : directionalLight.cascadeSplits[cascade - 1];
+    float cascadeEnd = directionalLight.cascadeSplits[cascade];
+    float blendStart = cascadeEnd - (cascadeEnd - cascadeStart) * directionalLight.cascadeBlendWidth;
+    if (cascade + 1 < SHADOW_CASCADE_COUNT && viewDepth > blendStart) {
+        float blend = (viewDepth - blendStart) / (cascadeEnd - blendStart);
+        shadow = mix(shadow, sampleCascade(cascade + 1, worldPos), blend);
+    }
+    return shadow;
+}
+
+vec3 GetWorldPositionFromDepth(float depth, ivec2 fragCoords, ivec2 resolution) {
+    vec2 ndc;
+    ndc.x = (float(fragCoords.x) / float(resolution.x)) * 2.0 - 1.0;
+    ndc.y = (float(fragCoords.y) / float(resolution.y)) * 2.0 - 1.0;
+
+    vec4 clipPos = vec4(ndc, depth, 1.0);
+    vec4 viewPos = ubo.invProj * clipPos;
+    viewPos /= viewPos.w;
+    vec4 worldPos = ubo.invView * viewPos;
+    return worldPos.xyz;
+}
+
+const float ENV_INTENSITY = 5000.0; // Adjustable ( based on HDR environment )
+
+struct Surface {
+    vec3 worldPos;
+    vec3 N;
+    vec3 V;
+    vec3 albedo;
+    float roughness;
+    float metallic;
+};
+
+vec3 skyColor(ivec2 texCoord, ivec2 resolution) {
+    vec3 worldPos = GetWorldPositionFromDepth(1.0, texCoord, resolution);
+    vec3 sampleDirection = normalize(worldPos);
+    return textureLod(gCubeMap, sampleDirection, 0.0).rgb * ENV_INTENSITY;
+}
+
+Surface decodeSurface(ivec2 texCoord, ivec2 resolution, float depth) {
+    vec2 encodedNormal = texelFetch(gNormal, texCoord, 0).rg;
+    vec2 params = texelFetch(gParams, texCoord, 0).rg;
+
+    Surface surface;
+    surface.worldPos = GetWorldPositionFromDepth(depth, texCoord, resolution);
+    surface.N = octDecode(encodedNormal * 2.0 - 1.0);
+    surface.V = normalize(ubo.cameraPosition - surface.worldPos);
+    surface.albedo = texelFetch(gAlbedo, texCoord, 0).rgb;
+    surface.roughness = params.x;
+    surface.metallic = params.y;
+    return surface;
+}
+
+// Directional light (shadowed) plus diffuse IBL
+vec3 shadeDirectionalAndAmbient(Surface s) {
+    vec3 L_dir = normalize(-directionalLight.directionalLightDirection);
+    float shadowTerm = ShadowCalculation(s.worldPos);
+    vec3 radiance_dir = directionalLight.directionalLightColor *
+    directionalLight.directionalLightIntensity;
+    vec3 Lo = shadowTerm * calculateDirectLighting(s.N, s.V, L_dir, s.albedo,
+    s.metallic, s.roughness, radiance_dir);
+
+    vec3 F0 = mix(vec3(0.04), s.albedo, s.metallic);
+    vec3 F = fresnelSchlickRoughness(max(dot(s.N, s.V), 0.0), F0, s.roughness);
+
+    // Energy conservation
+    vec3 kS = F;  // Specular contribution
+    vec3 kD = (vec3(1.0) - kS) * (1.0 - s.metallic);  // Diffuse contribution
+
+    // Diffuse IBL
+    vec3 irradiance = textureLod(gIrradianceMap, vec3(s.N.x, -s.N.y, s.N.z), 0.0).rgb;
+    vec3 ambient = kD * irradiance * s.albedo * ENV_INTENSITY;
+
+    return Lo + ambient;
+}
+
+// Point or spot light
+vec3 shadeLight(LightData light, Surface s) {
+    vec3 L = normalize(light.position - s.worldPos);
+    float attenuation = calculatePointLightAttenuation(light.position, s.worldPos, light.range);
+    if (light.type == LIGHT_TYPE_SPOT) {
+        attenuation *= smoothstep(light.spotCosOuter, light.spotCosInner, dot(-L, light.direction));
+    }
+    // Convert lumens to radiance
+    vec3 radiance = light.color * attenuation * (light.intensity / (4.0 * PI));
+    return calculateDirectLighting(s.N, s.V, L, s.albedo, s.metallic, s.roughness, radiance);
+}
@@ -0,0 +1,17 @@
+// Per-draw primitive data, shared by the geometry passes and the GPU culler.
+// Requires GL_EXT_buffer_reference, GL_EXT_scalar_block_layout and GL_GOOGLE_include_directive.
+
+// Mirrors GLTFPrimitiveData; the geometry passes select an entry with gl_InstanceIndex (firstInstance)
+struct PrimitiveData {
+    uint  indexOffset;
+    uint  indexCount;
+    uint  baseColorTextureIndex;
+    uint  metalRoughTextureIndex;
+    uint  normalTextureIndex;
+    vec3  boundsCenter;
+    vec3  boundsExtents;
+};
+
+layout(buffer_reference, scalar) readonly buffer PrimitiveBuffer {
+    PrimitiveData primitives[];
+};
@@ -2,6 +2,7 @@
 #extension GL_EXT_buffer_reference : require
 #extension GL_EXT_shader_explicit_arithmetic_types : require
 #extension GL_EXT_scalar_block_layout : require
+#extension GL_GOOGLE_include_directive : require
 
 struct Vertex {
     vec3 pos;      // Model-space position
@@ -12,21 +13,26 @@ struct Vertex {
 
 layout(push_constant, scalar) uniform PushConstants {
     uint64_t vertexBufferAddress;   // GPU address of vertex buffer
+    uint64_t primitiveBufferAddress;
     vec3 modelScale;                // Scale factor for the model
-    uint32_t baseColorTextureIndex;
+    uint cascadeIndex;              // Cascade being rendered
 } pushConstants;
 
 layout(buffer_reference, scalar) readonly buffer VertexBuffer {
     Vertex vertices[];
 };
 
+#include "primitive_data.glsl"
+
+const uint SHADOW_CASCADE_COUNT = 4;    // Must match SHADOW_CASCADE_COUNT
+
 layout(binding = 0, scalar) uniform DirectionalLightData {
-    vec3 directionalLightPosition;
+    mat4 cascadeViewProj[SHADOW_CASCADE_COUNT];
+    vec4 cascadeSplits;
     vec3 directionalLightDirection;
-    vec3 directionalLightColor;
     float directionalLightIntensity;
-    mat4 view;
-    mat4 projection;
+    vec3 directionalLightColor;
+    float cascadeBlendWidth;
 } directionalLight;
 
 layout(location = 0) out vec2 vTexCoord;
@@ -38,7 +44,7 @@ void main() {
 
     // Apply model scaling and transform to light space
     vec3 scaledPos = v.pos;
-    vec4 clipPos = directionalLight.projection * directionalLight.view * vec4(scaledPos, 1.0);
+    vec4 clipPos = directionalLight.cascadeViewProj[pushConstants.cascadeIndex] * vec4(scaledPos, 1.0);
 
     // PERSPECTIVE DIVIDE: Transform from clip space to NDC
     gl_Position = clipPos;
@@ -46,5 +52,5 @@ void main() {
 
     // Pass through texture coordinates and material index for alpha testing
     vTexCoord = v.texCoord;
-    vMaterial = pushConstants.baseColorTextureIndex;
+    vMaterial = PrimitiveBuffer(pushConstants.primitiveBufferAddress).primitives[gl_InstanceIndex].baseColorTextureIndex;
 }
\ No newline at end of file
@@ -1,9 +1,92 @@
 #include "application.h"
+#include <chrono>
 #include <stdexcept>
 #include <iostream>
+#include "config.h"
 #include "deletion_queue.h"
+#include "shared/render_settings.h"
+
+ApplicationConfig ApplicationConfig::fromCommandLine(int argc, char** argv) {
+    ApplicationConfig config;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto nextValue = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--headless") {
+            config.headless = true;
+        } else if (arg == "--frames") {
+            config.benchmark.frameCount = static_cast<uint32_t>(std::stoul(nextValue()));
+        } else if (arg == "--warmup") {
+            config.benchmark.warmupFrames = static_cast<uint32_t>(std::stoul(nextValue()));
+        } else if (arg == "--width") {
+            config.benchmark.width = static_cast<uint32_t>(std::stoul(nextValue()));
+        } else if (arg == "--height") {
+            config.benchmark.height = static_cast<uint32_t>(std::stoul(nextValue()));
+        } else if (arg == "--resize-storm") {
+            config.benchmark.resizeStorm = static_cast<uint32_t>(std::stoul(nextValue()));
+        } else if (arg == "--output") {
+            config.benchmark.outputDirectory = nextValue();
+        } else if (arg == "--lights") {
+            config.stressLights = static_cast<uint32_t>(std::stoul(nextValue()));
+        } else if (arg == "--compute-lighting") {
+            config.computeLighting = true;
+        } else if (arg == "--no-pipeline-cache") {
+            config.pipelineCache = false;
+        } else if (arg == "--no-shader-reload") {
+            config.shaderHotReload = false;
+        } else if (arg == "--record-threads") {
+            config.recordingThreads = static_cast<uint32_t>(std::stoul(nextValue()));
+        } else if (arg == "--cpu-culling") {
+            config.cpuCulling = true;
+        } else if (arg == "--hdr-format") {
+            const std::string value = nextValue();
+            if (value == "r11g11b10f") {
+                config.hdrFormat = VK_FORMAT_B10G11R11_UFLOAT_PACK32;
+            } else if (value == "rgba16f") {
+                config.hdrFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+            } else if (value == "rgba32f") {
+                config.hdrFormat = VK_FORMAT_R32G32B32A32_SFLOAT;
+            } else {
+                throw std::invalid_argument("Unknown HDR format: " + value);
+            }
+        } else if (arg == "--normal-format") {
+            const std::string value = nextValue();
+            if (value == "rg16") {
+                config.normalFormat = VK_FORMAT_R16G16_UNORM;
+            } else if (value == "rg8") {
+                config.normalFormat = VK_FORMAT_R8G8_UNORM;
+            } else {
+                throw std::invalid_argument("Unknown normal format: " + value);
+            }
+        } else {
+            throw std::invalid_argument("Unknown argument: " + arg);
+        }
+    }
+    return config;
+}
+
+VulkanApplication::VulkanApplication(ApplicationConfig config)
+    : m_config(std::move(config)) {
+}
 
 void VulkanApplication::run() {
+    renderSettings.stressLights = m_config.stressLights;
+    renderSettings.computeLighting = m_config.computeLighting;
+    renderSettings.hdrFormat = m_config.hdrFormat;
+    renderSettings.normalFormat = m_config.normalFormat;
+    renderSettings.recordingThreads = m_config.recordingThreads;
+    renderSettings.forceCpuCulling = m_config.cpuCulling;
+
+    if (m_config.headless) {
+        runHeadless();
+        return;
+    }
+
     createWindowAndContext();
 
     // Setup camera
@@ -16,7 +99,10 @@ void VulkanApplication::run() {
     createAllocator();
 
     // Create renderer and register its cleanup
-    m_renderer = std::make_unique<Renderer>(m_context.get(), m_window.get(), m_allocator, &m_camera);
+    createRenderer(m_window.get(), {0, 0});
+    if (m_config.shaderHotReload) {
+        m_renderer->enableShaderHotReload();
+    }
 
     // On window resize callback, notify renderer
     m_window->setResizeCallback([this]() {
@@ -31,10 +117,51 @@ void VulkanApplication::run() {
     DeletionQueue::get().flush();
 }
 
+void VulkanApplication::runHeadless() {
+    // No window: no surface, no swapchain, no ImGui
+    m_context = std::make_unique<Context>(nullptr, enableValidationLayers(), pipelineCachePath());
+
+    m_camera = Camera(glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(0.f, 1.f, 0.f), 0.f, 0.f, 0.f);
+
+    createAllocator();
+
+    createRenderer(nullptr, VkExtent2D{ m_config.benchmark.width, m_config.benchmark.height });
+
+    HeadlessBenchmark benchmark(m_config.benchmark);
+    benchmark.run(*m_renderer, m_camera);
+
+    vkDeviceWaitIdle(m_context->device());
+    m_renderer.reset();
+
+    DeletionQueue::get().flush();
+}
+
 void VulkanApplication::createWindowAndContext() {
     m_window = std::make_unique<Window>(WIDTH, HEIGHT, "Salamander");
 
-    m_context = std::make_unique<Context>(m_window.get(), enableValidationLayers());
+    m_context = std::make_unique<Context>(m_window.get(), enableValidationLayers(), pipelineCachePath());
+}
+
+std::string VulkanApplication::pipelineCachePath() const {
+    return m_config.pipelineCache ? std::string(BUILD_RESOURCE_DIR) + "/pipeline_cache.bin" : std::string();
+}
+
+void VulkanApplication::createRenderer(Window* window, VkExtent2D offscreenExtent) {
+    // Startup report: run once with --no-pipeline-cache (or without a cache file) and once warm to compare
+    const auto start = std::chrono::steady_clock::now();
+    m_renderer = std::make_unique<Renderer>(m_context.get(), window, m_allocator, &m_camera, offscreenExtent);
+    const std::chrono::duration<double, std::milli> startup = std::chrono::steady_clock::now() - start;
+
+    std::cout << "Renderer startup: " << startup.count() << " ms, pipeline creation (summed over workers): "
+              << m_context->pipelineCreationMs() << " ms (pipeline cache: ";
+    if (!m_config.pipelineCache) {
+        std::cout << "disabled";
+    } else if (m_context->pipelineCacheLoadedBytes() == 0) {
+        std::cout << "cold";
+    } else {
+        std::cout << "warm, " << m_context->pipelineCacheLoadedBytes() << " bytes";
+    }
+    std::cout << ")" << std::endl;
 }
 
 void VulkanApplication::createAllocator() {
@@ -47,7 +174,7 @@ void VulkanApplication::createAllocator() {
         throw std::runtime_error("Failed to create VMA allocator!");
     }
     // Register allocator destruction
-    DeletionQueue::get().pushFunction("Allocator", [this]() {
+    DeletionQueue::get().push([this]() {
         vmaDestroyAllocator(m_allocator);
         });
 }
@@ -3,18 +3,46 @@
 #include "window.h"
 #include "context.h"
 #include "renderer.h"
+#include "benchmark/headless_benchmark.h"
 
 
 constexpr uint32_t WIDTH = 1100;
 constexpr uint32_t HEIGHT = 900;
 
+struct ApplicationConfig {
+    bool headless = false;
+    BenchmarkConfig benchmark{};
+    uint32_t stressLights = 0;
+    bool computeLighting = false;
+    VkFormat hdrFormat = VK_FORMAT_B10G11R11_UFLOAT_PACK32;
+    VkFormat normalFormat = VK_FORMAT_R16G16_UNORM;
+    bool pipelineCache = true;
+    bool shaderHotReload = true;
+    uint32_t recordingThreads = 0;
+    bool cpuCulling = false;
+
+    // --headless [--frames N] [--warmup N] [--width W] [--height H] [--output DIR]
+    // --lights N: stress-test light count, windowed or headless
+    // --compute-lighting: start with the tiled compute lighting pass
+    // --hdr-format r11g11b10f|rgba16f|rgba32f, --normal-format rg16|rg8: preferred deferred target formats
+    // --no-pipeline-cache: neither load nor save the on-disk pipeline cache (cold startup timing)
+    // --no-shader-reload: do not watch shaders/ for edits (windowed only; headless never reloads)
+    // --record-threads N: cap on threads recording geometry passes (0 = every worker plus the main thread)
+    // --cpu-culling: cull on the CPU even where indirect count is supported, so draws can be recorded in parallel
+    static ApplicationConfig fromCommandLine(int argc, char** argv);
+};
+
 class VulkanApplication {
 public:
+    explicit VulkanApplication(ApplicationConfig config = {});
     void run();
 private:
+    void runHeadless();
     void createWindowAndContext();
     void createAllocator();
     void mainLoop();
+    void createRenderer(Window* window, VkExtent2D offscreenExtent);
+    std::string pipelineCachePath() const;
 
     static bool enableValidationLayers() {
 #ifdef NDEBUG
@@ -24,6 +52,8 @@ private:
 #endif
     }
 
+    ApplicationConfig m_config;
+
     // Resources
     std::unique_ptr<Window> m_window;
     std::unique_ptr<Context> m_context;
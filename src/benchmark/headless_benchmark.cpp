@@ -0,0 +1,187 @@
+#include "headless_benchmark.h"
+#include "camera/camera_path.h"
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "stb_image_write.h"
+
+namespace {
+    struct Distribution {
+        double mean = 0.0;
+        double min = 0.0;
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double max = 0.0;
+    };
+
+    Distribution computeDistribution(std::vector<double> samples) {
+        Distribution result;
+        if (samples.empty()) {
+            return result;
+        }
+        std::ranges::sort(samples);
+        auto percentile = [&samples](double p) {
+            return samples[static_cast<size_t>(p * static_cast<double>(samples.size() - 1))];
+        };
+
+        double sum = 0.0;
+        for (double sample : samples) {
+            sum += sample;
+        }
+        result.mean = sum / static_cast<double>(samples.size());
+        result.min = samples.front();
+        result.p50 = percentile(0.50);
+        result.p95 = percentile(0.95);
+        result.max = samples.back();
+        return result;
+    }
+}
+
+HeadlessBenchmark::HeadlessBenchmark(BenchmarkConfig config)
+    : m_config(std::move(config)) {
+    if (m_config.frameCount == 0) {
+        throw std::invalid_argument("Benchmark needs at least one frame!");
+    }
+}
+
+void HeadlessBenchmark::run(Renderer& renderer, Camera& camera) const {
+    const CameraPath path = CameraPath::sponzaFlythrough();
+
+    renderer.setFrameTimingCapture(true);
+    for (uint32_t frame = 0; frame < m_config.frameCount; ++frame) {
+        // Time is derived from the frame index, never the wall clock
+        const float t = m_config.frameCount > 1
+            ? static_cast<float>(frame) / static_cast<float>(m_config.frameCount - 1)
+            : 0.0f;
+        path.apply(camera, t);
+        renderer.drawFrame();
+    }
+    renderer.resolveFrameTimings();
+    renderer.setFrameTimingCapture(false);
+
+    std::filesystem::create_directories(m_config.outputDirectory);
+
+    // setFrameTimingCapture(false) keeps the captured data until the next capture starts
+    const std::vector<FrameTiming>& timings = renderer.frameTimings();
+    writeTimingsCsv(timings, renderer.profiler());
+    writeFramePng(renderer.captureLastFrame(), renderer.extent());
+    printSummary(timings, renderer.profiler());
+
+    if (m_config.resizeStorm > 0) {
+        runResizeStorm(renderer);
+    }
+}
+
+void HeadlessBenchmark::runResizeStorm(Renderer& renderer) const {
+    // Enough frames for everything retired before them to be collected
+    auto settle = [&renderer]() {
+        for (int frame = 0; frame <= MAX_FRAMES_IN_FLIGHT; ++frame) {
+            renderer.drawFrame();
+        }
+    };
+
+    const VkExtent2D original = renderer.extent();
+    settle();
+    const Renderer::MemoryUsage before = renderer.memoryUsage();
+
+    constexpr std::array<float, 4> scales = { 0.5f, 0.75f, 1.25f, 1.0f };
+    for (uint32_t i = 0; i < m_config.resizeStorm; ++i) {
+        const float scale = scales[i % scales.size()];
+        renderer.resize({
+            std::max(1u, static_cast<uint32_t>(static_cast<float>(original.width) * scale)),
+            std::max(1u, static_cast<uint32_t>(static_cast<float>(original.height) * scale))
+        });
+        renderer.drawFrame();
+    }
+
+    renderer.resize(original);
+    settle();
+    const Renderer::MemoryUsage after = renderer.memoryUsage();
+
+    std::cout << "Resize storm (" << m_config.resizeStorm << " resizes): "
+              << before.allocationCount << " -> " << after.allocationCount << " allocations, "
+              << before.allocationBytes / 1024 << " -> " << after.allocationBytes / 1024 << " KiB, "
+              << after.renderTargetAllocations - before.renderTargetAllocations << " render targets created, "
+              << before.deletionEntries << " -> " << after.deletionEntries << " deletion entries\n";
+
+    if (after.allocationCount > before.allocationCount || after.allocationBytes > before.allocationBytes) {
+        throw std::runtime_error("GPU memory grew across the resize storm!");
+    }
+    if (after.deletionEntries > before.deletionEntries) {
+        throw std::runtime_error("Deletion queue entries grew across the resize storm!");
+    }
+}
+
+void HeadlessBenchmark::writeTimingsCsv(const std::vector<FrameTiming>& timings, const GpuProfiler& profiler) const {
+    const auto path = std::filesystem::path(m_config.outputDirectory) / "frame_timings.csv";
+    std::ofstream csv(path);
+    if (!csv) {
+        throw std::runtime_error("Failed to open " + path.string());
+    }
+
+    const auto& scopes = profiler.scopeStats();
+    csv << "frame,warmup,cpu_ms,gpu_ms";
+    for (const auto& scope : scopes) {
+        csv << ',' << scope.name << "_ms";
+    }
+    csv << '\n';
+
+    for (size_t i = 0; i < timings.size(); ++i) {
+        csv << i << ',' << (i < m_config.warmupFrames ? 1 : 0) << ','
+            << timings[i].cpuMs << ',' << timings[i].gpuMs;
+        for (size_t scope = 0; scope < scopes.size(); ++scope) {
+            // Scopes first seen after this frame have no sample
+            csv << ',' << (scope < timings[i].passGpuMs.size() ? timings[i].passGpuMs[scope] : 0.0);
+        }
+        csv << '\n';
+    }
+}
+
+void HeadlessBenchmark::writeFramePng(const std::vector<uint8_t>& pixels, VkExtent2D extent) const {
+    const auto path = std::filesystem::path(m_config.outputDirectory) / "final_frame.png";
+    const int stride = static_cast<int>(extent.width) * 4;
+    if (!stbi_write_png(path.string().c_str(), static_cast<int>(extent.width), static_cast<int>(extent.height),
+                        4, pixels.data(), stride)) {
+        throw std::runtime_error("Failed to write " + path.string());
+    }
+}
+
+void HeadlessBenchmark::printSummary(const std::vector<FrameTiming>& timings, const GpuProfiler& profiler) const {
+    std::vector<double> cpu;
+    std::vector<double> gpu;
+    for (size_t i = m_config.warmupFrames; i < timings.size(); ++i) {
+        cpu.push_back(timings[i].cpuMs);
+        gpu.push_back(timings[i].gpuMs);
+    }
+
+    auto print = [](const char* label, const Distribution& d) {
+        std::cout << label
+                  << " mean " << d.mean << " ms"
+                  << " | min " << d.min
+                  << " | p50 " << d.p50
+                  << " | p95 " << d.p95
+                  << " | max " << d.max << '\n';
+    };
+
+    std::cout << "Headless benchmark: " << cpu.size() << " measured frames at "
+              << m_config.width << 'x' << m_config.height << '\n';
+    print("  CPU", computeDistribution(std::move(cpu)));
+    print("  GPU", computeDistribution(std::move(gpu)));
+
+    const auto& scopes = profiler.scopeStats();
+    for (size_t scope = 0; scope < scopes.size(); ++scope) {
+        std::vector<double> samples;
+        for (size_t i = m_config.warmupFrames; i < timings.size(); ++i) {
+            if (scope < timings[i].passGpuMs.size()) {
+                samples.push_back(timings[i].passGpuMs[scope]);
+            }
+        }
+        print(("    " + scopes[scope].name).c_str(), computeDistribution(std::move(samples)));
+    }
+    std::cout << "  Results written to " << std::filesystem::absolute(m_config.outputDirectory).string() << std::endl;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "renderer.h"
+
+struct BenchmarkConfig {
+    uint32_t frameCount = 300;
+    uint32_t warmupFrames = 10;   // Rendered and written to the CSV, excluded from the summary
+    uint32_t width = 1920;
+    uint32_t height = 1080;
+    std::string outputDirectory = "benchmark";
+    uint32_t resizeStorm = 0;     // Resizes to run after the benchmark, checking that GPU memory stays flat
+};
+
+// Renders a fixed camera path headless and writes per-frame timings (frame_timings.csv,
+// one GPU column per profiled pass) and the final image (final_frame.png) to the output directory.
+// With resizeStorm set it then resizes repeatedly and throws if VMA reports more memory in use
+// once it is back at the original extent.
+class HeadlessBenchmark {
+public:
+    explicit HeadlessBenchmark(BenchmarkConfig config);
+
+    void run(Renderer& renderer, Camera& camera) const;
+
+private:
+    void writeTimingsCsv(const std::vector<FrameTiming>& timings, const GpuProfiler& profiler) const;
+    void writeFramePng(const std::vector<uint8_t>& pixels, VkExtent2D extent) const;
+    void printSummary(const std::vector<FrameTiming>& timings, const GpuProfiler& profiler) const;
+    void runResizeStorm(Renderer& renderer) const;
+
+    BenchmarkConfig m_config;
+};
@@ -1,10 +1,29 @@
 #include "context.h"
 #include <iostream>
+#include <filesystem>
+#include <fstream>
 #include <vector>
 #include <set>
 #include <cstring>
 #include "deletion_queue.h"
 
+namespace {
+    // Written in front of the driver's cache data. The driver validates its own header too, but a
+    // mismatching blob is rejected up front so a driver update or a different GPU starts clean.
+    struct PipelineCacheFileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vendorID;
+        uint32_t deviceID;
+        uint32_t driverVersion;
+        uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+        uint64_t dataSize;
+    };
+
+    constexpr uint32_t PIPELINE_CACHE_MAGIC = 0x43504C53;  // "SLPC"
+    constexpr uint32_t PIPELINE_CACHE_FILE_VERSION = 1;
+}
+
 // Checks if all the requested validation layers are available on the system
 bool Context::checkValidationLayerSupport() const
 {
@@ -53,12 +72,14 @@ bool Context::isDeviceSuitable(VkPhysicalDevice device) const {
         return false;
     }
 
-    // Check swap chain support
-    SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
-    bool swapChainAdequate = !swapChainSupport.formats.empty() &&
-                             !swapChainSupport.presentModes.empty();
-    if (!swapChainAdequate) {
-        return false;
+    // Check swap chain support (nothing to present to in headless mode)
+    if (!m_headless) {
+        SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
+        bool swapChainAdequate = !swapChainSupport.formats.empty() &&
+                                 !swapChainSupport.presentModes.empty();
+        if (!swapChainAdequate) {
+            return false;
+        }
     }
 
     // Query and validate features
@@ -169,12 +190,14 @@ bool Context::validateRequiredFeatures(const SupportedDeviceFeatures& features)
     return true;
 }
 
-std::vector<const char*> Context::getRequiredInstanceExtensions(bool enableValidation) {
-    uint32_t glfwExtensionCount = 0;
-    const char** glfwExtensions = nullptr;
-    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-
-    std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+std::vector<const char*> Context::getRequiredInstanceExtensions(bool enableValidation, bool headless) {
+    std::vector<const char*> extensions;
+    if (!headless) {
+        uint32_t glfwExtensionCount = 0;
+        const char** glfwExtensions = nullptr;
+        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
     if (enableValidation) {
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
     }
@@ -183,16 +206,26 @@ std::vector<const char*> Context::getRequiredInstanceExtensions(bool enableValid
 
 /* Initializes the Vulkan instance, debug messenger,
    creates the surface from the provided Window, selects a physical device,
-   creates the logical device. */
-Context::Context(Window* window, bool enableValidation)
-    : m_enableValidation(enableValidation)
+   creates the logical device.
+   A null window creates a headless context (offscreen rendering only). */
+Context::Context(Window* window, bool enableValidation, std::string pipelineCachePath)
+    : m_enableValidation(enableValidation), m_headless(window == nullptr), m_pipelineCachePath(std::move(pipelineCachePath))
 {
+    if (m_headless) {
+        std::erase_if(m_deviceExtensions, [](const char* name) {
+            return std::strcmp(name, VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0;
+        });
+    }
+
     createInstance();
     m_debugMessenger = new DebugMessenger(m_instance, enableValidation);
-    createSurface(window);
+    if (!m_headless) {
+        createSurface(window);
+    }
     selectPhysicalDevice();
     createLogicalDevice();
     m_debugMessenger->setupDeviceFunctions(m_device);
+    createPipelineCache();
 }
 
 // cleans up all Vulkan resources
@@ -215,7 +248,7 @@ void Context::createInstance() {
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.apiVersion = VK_API_VERSION_1_3;
 
-    auto extensions = getRequiredInstanceExtensions(m_enableValidation);
+    auto extensions = getRequiredInstanceExtensions(m_enableValidation, m_headless);
 
     VkInstanceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -234,7 +267,7 @@ void Context::createInstance() {
     if (vkCreateInstance(&createInfo, nullptr, &m_instance) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create Vulkan instance!");
     }
-	DeletionQueue::get().pushFunction("Instance", [this]() {
+	DeletionQueue::get().push([this]() {
 		if (m_instance != VK_NULL_HANDLE) {
 			vkDestroyInstance(m_instance, nullptr);
 		}
@@ -249,7 +282,7 @@ void Context::createSurface(Window* window)
         throw std::runtime_error("Failed to create window surface!");
     }
 
-    DeletionQueue::get().pushFunction("Surface", [this]() {
+    DeletionQueue::get().push([this]() {
         if (m_surface != VK_NULL_HANDLE) {
             vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
         }
@@ -272,6 +305,7 @@ void Context::selectPhysicalDevice() {
             m_physicalDevice = device;
             m_queueFamilies = findQueueFamilies(device);
             m_supportedFeatures = queryDeviceFeatures(device);
+            vkGetPhysicalDeviceProperties(device, &m_deviceProperties);
             break;
         }
     }
@@ -330,6 +364,16 @@ void Context::createLogicalDevice() {
     // Enable core features
     enabledFeatures.features.samplerAnisotropy = VK_TRUE;
     enabledFeatures.features.shaderInt64 = VK_TRUE;
+    // Optional: only cooked scenes use BCn textures, and they fall back to glTF without it
+    enabledFeatures.features.textureCompressionBC = m_supportedFeatures.coreFeatures.features.textureCompressionBC;
+    // Optional: only feeds the overdraw statistics in the Stats panel
+    enabledFeatures.features.pipelineStatisticsQuery = m_supportedFeatures.coreFeatures.features.pipelineStatisticsQuery;
+    // Optional: lets secondary command buffers run inside that statistics query
+    enabledFeatures.features.inheritedQueries = m_supportedFeatures.coreFeatures.features.inheritedQueries;
+    // Optional: storage image writes without a format qualifier, for compute passes that write whatever HDR format was picked
+    enabledFeatures.features.shaderStorageImageWriteWithoutFormat = m_supportedFeatures.coreFeatures.features.shaderStorageImageWriteWithoutFormat;
+    // Optional: without indirect count the scene is culled on the CPU instead
+    enabledFeatures.features.drawIndirectFirstInstance = supportsIndirectCount() ? VK_TRUE : VK_FALSE;
 
     // Vulkan 1.2 features
     VkPhysicalDeviceVulkan12Features enabled12{};
@@ -337,6 +381,7 @@ void Context::createLogicalDevice() {
     enabled12.bufferDeviceAddress = VK_TRUE;
     enabled12.runtimeDescriptorArray = VK_TRUE;
     enabled12.scalarBlockLayout = VK_TRUE;
+    enabled12.drawIndirectCount = supportsIndirectCount() ? VK_TRUE : VK_FALSE;
 
     void* pNext = &enabled12; // Start building the chain
 
@@ -389,7 +434,7 @@ void Context::createLogicalDevice() {
         throw std::runtime_error("Failed to create logical device!");
     }
 
-    DeletionQueue::get().pushFunction("Device", [this]() {
+    DeletionQueue::get().push([this]() {
         if (m_device != VK_NULL_HANDLE) {
             vkDestroyDevice(m_device, nullptr);
         }
@@ -400,6 +445,102 @@ void Context::createLogicalDevice() {
 }
 
 
+void Context::createPipelineCache() {
+    const std::vector<char> initialData = loadPipelineCacheData();
+
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = initialData.size();
+    cacheInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+    if (vkCreatePipelineCache(m_device, &cacheInfo, nullptr, &m_pipelineCache) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create pipeline cache!");
+    }
+    m_pipelineCacheLoadedBytes = initialData.size();
+
+    // Registered after the device, so it runs before the device is destroyed and after every pipeline
+    DeletionQueue::get().push([this]() {
+        savePipelineCache();
+        vkDestroyPipelineCache(m_device, m_pipelineCache, nullptr);
+        m_pipelineCache = VK_NULL_HANDLE;
+    });
+}
+
+std::vector<char> Context::loadPipelineCacheData() const {
+    if (m_pipelineCachePath.empty()) {
+        return {};
+    }
+    std::ifstream file(m_pipelineCachePath, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return {};
+    }
+    const auto fileSize = static_cast<size_t>(file.tellg());
+    file.seekg(0);
+
+    PipelineCacheFileHeader header{};
+    if (fileSize < sizeof(header) || !file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        std::cerr << "Pipeline cache " << m_pipelineCachePath << " is truncated, starting cold" << std::endl;
+        return {};
+    }
+    if (header.magic != PIPELINE_CACHE_MAGIC || header.version != PIPELINE_CACHE_FILE_VERSION ||
+        header.dataSize != fileSize - sizeof(header)) {
+        std::cerr << "Pipeline cache " << m_pipelineCachePath << " is not a valid cache file, starting cold" << std::endl;
+        return {};
+    }
+    if (header.vendorID != m_deviceProperties.vendorID || header.deviceID != m_deviceProperties.deviceID ||
+        header.driverVersion != m_deviceProperties.driverVersion ||
+        std::memcmp(header.pipelineCacheUUID, m_deviceProperties.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+        std::cout << "Pipeline cache was written by another device or driver, starting cold" << std::endl;
+        return {};
+    }
+
+    std::vector<char> data(header.dataSize);
+    if (!file.read(data.data(), static_cast<std::streamsize>(data.size()))) {
+        return {};
+    }
+    return data;
+}
+
+void Context::savePipelineCache() const {
+    if (m_pipelineCachePath.empty() || m_pipelineCache == VK_NULL_HANDLE) {
+        return;
+    }
+
+    size_t dataSize = 0;
+    if (vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0) {
+        return;
+    }
+    std::vector<char> data(dataSize);
+    if (vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, data.data()) != VK_SUCCESS) {
+        return;
+    }
+
+    PipelineCacheFileHeader header{};
+    header.magic = PIPELINE_CACHE_MAGIC;
+    header.version = PIPELINE_CACHE_FILE_VERSION;
+    header.vendorID = m_deviceProperties.vendorID;
+    header.deviceID = m_deviceProperties.deviceID;
+    header.driverVersion = m_deviceProperties.driverVersion;
+    std::memcpy(header.pipelineCacheUUID, m_deviceProperties.pipelineCacheUUID, VK_UUID_SIZE);
+    header.dataSize = dataSize;
+
+    // Written next to the target and renamed, so an interrupted save never leaves a torn file
+    const std::string tempPath = m_pipelineCachePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.write(reinterpret_cast<const char*>(&header), sizeof(header)) ||
+            !file.write(data.data(), static_cast<std::streamsize>(dataSize))) {
+            std::cerr << "Failed to write pipeline cache " << tempPath << std::endl;
+            return;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(tempPath, m_pipelineCachePath, error);
+    if (error) {
+        std::cerr << "Failed to save pipeline cache " << m_pipelineCachePath << ": " << error.message() << std::endl;
+    }
+}
+
 // Queries the available queue families for the physical device and returns the ones that support both graphics and presentation.
 QueueFamilyIndices Context::findQueueFamilies(VkPhysicalDevice device) const {
     QueueFamilyIndices indices;
@@ -411,9 +552,15 @@ QueueFamilyIndices Context::findQueueFamilies(VkPhysicalDevice device) const {
     int i = 0;
     for (const auto& queueFamily : queueFamilies) {
         VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, m_surface, &presentSupport);
-        if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+        if (m_surface != VK_NULL_HANDLE) {
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, m_surface, &presentSupport);
+        }
+        if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
             indices.graphicsFamily = i;
+            // Headless: the "present" queue is only used for submission, so alias graphics
+            if (m_headless)
+                presentSupport = true;
+        }
         if (presentSupport)
             indices.presentFamily = i;
         if (indices.isComplete())
@@ -2,6 +2,9 @@
 
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
+#include <atomic>
+#include <chrono>
+#include <string>
 #include <vector>
 #include <optional>
 
@@ -38,7 +41,9 @@ struct QueueFamilyIndices {
 
 class Context final {
 public:
-    Context(Window* window, bool enableValidation);
+    // pipelineCachePath: file the shared pipeline cache is loaded from and saved to at shutdown;
+    // empty keeps the cache in memory only
+    Context(Window* window, bool enableValidation, std::string pipelineCachePath = {});
     ~Context();
     Context(const Context&) = delete;
     Context& operator=(const Context&) = delete;
@@ -54,9 +59,35 @@ public:
     VkQueue presentQueue() const { return m_presentQueue; }
     VkInstance instance() const { return m_instance; }
     VkSurfaceKHR surface() const { return m_surface; }
+    const VkPhysicalDeviceProperties& deviceProperties() const { return m_deviceProperties; }
+    bool supportsTextureCompressionBC() const { return m_supportedFeatures.coreFeatures.features.textureCompressionBC == VK_TRUE; }
+    bool supportsPipelineStatistics() const { return m_supportedFeatures.coreFeatures.features.pipelineStatisticsQuery == VK_TRUE; }
+    bool supportsInheritedQueries() const { return m_supportedFeatures.coreFeatures.features.inheritedQueries == VK_TRUE; }
+    bool supportsStorageImageWriteWithoutFormat() const {
+        return m_supportedFeatures.coreFeatures.features.shaderStorageImageWriteWithoutFormat == VK_TRUE;
+    }
+    // GPU-driven culling writes indirect draws whose firstInstance selects the primitive
+    bool supportsIndirectCount() const {
+        return m_supportedFeatures.features12.drawIndirectCount == VK_TRUE &&
+               m_supportedFeatures.coreFeatures.features.drawIndirectFirstInstance == VK_TRUE;
+    }
+
+    // True when created without a window: no surface, no swapchain extension
+    bool isHeadless() const { return m_headless; }
 
     DebugMessenger* debugMessenger() const { return m_debugMessenger; }
 
+    // Passed to every vkCreate*Pipelines call
+    VkPipelineCache pipelineCache() const { return m_pipelineCache; }
+    // Size of the cache data accepted from disk at startup; 0 means every pipeline compiled cold
+    size_t pipelineCacheLoadedBytes() const { return m_pipelineCacheLoadedBytes; }
+
+    // Time spent inside vkCreate*Pipelines summed over every thread, for the startup report
+    void addPipelineCreationTime(std::chrono::steady_clock::duration duration) {
+        m_pipelineCreationNs += std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    }
+    double pipelineCreationMs() const { return static_cast<double>(m_pipelineCreationNs.load()) / 1.0e6; }
+
     SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice device) const;
 
 private:
@@ -64,6 +95,10 @@ private:
     void createSurface(Window* window);
     void selectPhysicalDevice();
     void createLogicalDevice();
+    void createPipelineCache();
+    void savePipelineCache() const;
+    // Cache data from pipelineCachePath, or nothing when the file is missing or was written by another device or driver
+    std::vector<char> loadPipelineCacheData() const;
 
     bool checkValidationLayerSupport() const;
     bool checkDeviceExtensionSupport(VkPhysicalDevice device) const;
@@ -75,7 +110,7 @@ private:
     // Validate that required features are supported
     static bool validateRequiredFeatures(const SupportedDeviceFeatures& features);
 
-    static std::vector<const char*> getRequiredInstanceExtensions(bool enableValidation);
+    static std::vector<const char*> getRequiredInstanceExtensions(bool enableValidation, bool headless);
 
     VkInstance m_instance = VK_NULL_HANDLE;
     VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
@@ -86,6 +121,13 @@ private:
     QueueFamilyIndices m_queueFamilies;
     DebugMessenger* m_debugMessenger;
     bool m_enableValidation = false;
+    bool m_headless = false;
+    VkPhysicalDeviceProperties m_deviceProperties{};
+
+    std::string m_pipelineCachePath;
+    VkPipelineCache m_pipelineCache = VK_NULL_HANDLE;
+    size_t m_pipelineCacheLoadedBytes = 0;
+    std::atomic<int64_t> m_pipelineCreationNs{0};
 
 
     SupportedDeviceFeatures m_supportedFeatures {};
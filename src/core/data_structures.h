@@ -33,6 +33,8 @@ struct UniformBufferObject {
     glm::mat4 model;
     glm::mat4 view;
     glm::mat4 proj;
+    glm::mat4 invView;              // Precomputed for position reconstruction in the lighting passes
+    glm::mat4 invProj;
     glm::vec3 cameraPosition;
 };
 
@@ -50,7 +52,13 @@ struct GLTFPrimitiveData {
     uint32_t materialIndex;
     uint32_t metalRoughTextureIndex;
     uint32_t normalTextureIndex;
+
+    // Bounding volumes in world space, used for culling
+    glm::vec3 boundsCenter;
+    glm::vec3 boundsExtents;    // Half size of the AABB
 };
+// Uploaded as is and read with scalar layout by the cull and geometry shaders
+static_assert(sizeof(GLTFPrimitiveData) == 44);
 
 static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
 
@@ -62,23 +70,38 @@ struct Frame {
     ManagedTexture depthTexture;
 };
 
-struct PointLightData {
-    glm::vec3 pointLightPosition;
-    float pointLightIntensity;  // In lumens
-    glm::vec3 pointLightColor;
-    float pointLightRadius;     // Maximum radius of influence for optimization
+enum class LightType : uint32_t {
+    Point = 0,
+    Spot = 1
+};
+
+// One entry of the light SSBO, mirrored by LightData in cluster_lights.comp and lighting.frag
+struct LightData {
+    glm::vec3 position;
+    float range;                // Radius of influence; lights are binned into clusters by this sphere
+    glm::vec3 color;
+    float intensity;            // In lumens
+    glm::vec3 direction;        // Spot lights only
+    float spotCosOuter;         // Spot lights only; cosine of the cone half-angles
+    float spotCosInner;
+    LightType type;
 };
+static_assert(sizeof(LightData) == 56);
+
+inline constexpr uint32_t SHADOW_CASCADE_COUNT = 4;
 
+// Laid out so the scalar-layout UBO in the shaders matches without padding
 inline struct DirectionalLightData {
-    glm::vec3 directionalLightPosition; // well kind of
+    glm::mat4 cascadeViewProj[SHADOW_CASCADE_COUNT];    // Light view-projection of each cascade, refitted every frame
+    glm::vec4 cascadeSplits;                            // View-space far distance of each cascade
     glm::vec3 directionalLightDirection;
-    glm::vec3 directionalLightColor;
     float directionalLightIntensity;
-    glm::mat4 view;
-    glm::mat4 projection;
-} directionalLight { glm::vec3{0.f, 0.f, 0.f}, glm::normalize(glm::vec3{0.f, -1.f, 0.f}),
-    glm::vec3{ 1.f, 1.f, 1.f}, 100000.f,
-    glm::mat4{ 1.f }, glm::mat4{ 1.f } };
+    glm::vec3 directionalLightColor;
+    float cascadeBlendWidth;                            // Fraction of a cascade blended into the next one
+} directionalLight { {}, glm::vec4{ 0.f },
+    glm::normalize(glm::vec3{0.f, -1.f, 0.f}), 100000.f,
+    glm::vec3{ 1.f, 1.f, 1.f}, 0.1f };
+static_assert(sizeof(DirectionalLightData) == 304);
 
 inline struct CameraExposure {
     float aperture;
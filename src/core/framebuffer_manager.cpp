@@ -37,11 +37,9 @@ FramebufferManager::FramebufferSet FramebufferManager::createFramebuffersForRend
         // Register cleanup for each framebuffer
         VkDevice device = m_context->device();
         VkFramebuffer framebuffer = set.framebuffers[i];
-        DeletionQueue::get().pushFunction(
-            "Framebuffer_" + std::to_string(i) + "_" + std::to_string(reinterpret_cast<uint64_t>(renderPass)),
-            [device, framebuffer]() {
+        m_deletions.push_back(DeletionQueue::get().push([device, framebuffer]() {
                 vkDestroyFramebuffer(device, framebuffer, nullptr);
-            });
+            }));
     }
 
     m_framebufferSets[renderPass] = set;
@@ -63,5 +61,9 @@ void FramebufferManager::cleanup() {
             vkDestroyFramebuffer(m_context->device(), framebuffer, nullptr);
         }
     }
+    for (auto deletion : m_deletions) {
+        DeletionQueue::get().cancel(deletion);
+    }
     m_framebufferSets.clear();
+    m_deletions.clear();
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 // framebuffer_manager.h
 #pragma once
 #include "context.h"
+#include "deletion_queue.h"
 #include <vector>
 #include <unordered_map>
 
@@ -33,4 +34,5 @@ private:
     VkExtent2D m_extent;
     VkImageView m_depthView;
     std::unordered_map<VkRenderPass, FramebufferSet> m_framebufferSets;
+    std::vector<DeletionQueue::Handle> m_deletions;
 };
\ No newline at end of file
@@ -38,12 +38,11 @@ void ImageViews::createImageViews(const std::vector<VkImage>& images) {
         }
     }
 
-    int imageViewIndex = 0;
     for (auto imageView : m_imageViews) {
         VkDevice device = m_context->device();
-        DeletionQueue::get().pushFunction("ImageView_" + std::to_string(imageViewIndex++), [device, imageView]() {
+        m_deletions.push_back(DeletionQueue::get().push([device, imageView]() {
             vkDestroyImageView(device, imageView, nullptr);
-            });
+            }));
     }
 }
 
@@ -51,5 +50,9 @@ void ImageViews::cleanup() {
     for (auto imageView : m_imageViews) {
         vkDestroyImageView(m_context->device(), imageView, nullptr);
     }
+    for (auto deletion : m_deletions) {
+        DeletionQueue::get().cancel(deletion);
+    }
     m_imageViews.clear();
+    m_deletions.clear();
 }
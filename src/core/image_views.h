@@ -1,5 +1,6 @@
 #pragma once
 #include "context.h"
+#include "deletion_queue.h"
 #include <vector>
 
 class ImageViews final {
@@ -19,5 +20,6 @@ private:
 
     Context* m_context;
     std::vector<VkImageView> m_imageViews;
+    std::vector<DeletionQueue::Handle> m_deletions;
     VkFormat m_format;
 };
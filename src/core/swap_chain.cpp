@@ -4,6 +4,7 @@
 #include <limits>
 #include <stdexcept>
 
+#include "data_structures.h"
 #include "deletion_queue.h"
 
 SwapChain::SwapChain(Context* context, Window* window)
@@ -12,7 +13,17 @@ SwapChain::SwapChain(Context* context, Window* window)
     createImageViews();
 }
 
+SwapChain::SwapChain(Context* context, RenderTargetPool* targetPool, VkExtent2D extent)
+    : m_context(context), m_imageFormat(OFFSCREEN_FORMAT), m_extent(extent), m_targetPool(targetPool) {
+    createOffscreenImages();
+}
+
 void SwapChain::recreate() {
+    // The pool keeps the offscreen targets unless resizeOffscreen changed the extent
+    if (isOffscreen()) {
+        createOffscreenImages();
+        return;
+    }
     cleanup();
     createSwapChain();
     m_imageViews->recreate(m_imageFormat, m_images);
@@ -65,7 +76,7 @@ void SwapChain::createSwapChain() {
     VkDevice deviceCopy = m_context->device();
     VkSwapchainKHR swapChainCopy = m_swapChain;
 
-	DeletionQueue::get().pushFunction("SwapchainKHR", [deviceCopy, swapChainCopy]() {
+	m_deletion = DeletionQueue::get().push([deviceCopy, swapChainCopy]() {
 		vkDestroySwapchainKHR(deviceCopy, swapChainCopy, nullptr);
 		});
 
@@ -81,9 +92,36 @@ void SwapChain::createImageViews() {
     m_imageViews = std::make_unique<ImageViews>(m_context, m_imageFormat, m_images);
 }
 
+void SwapChain::resizeOffscreen(VkExtent2D extent) {
+    if (!isOffscreen()) {
+        throw std::logic_error("Only offscreen swapchains are resized explicitly!");
+    }
+    if (extent.width == 0 || extent.height == 0) {
+        throw std::invalid_argument("Offscreen extent must be non-zero!");
+    }
+    m_extent = extent;
+}
+
+void SwapChain::createOffscreenImages() {
+    m_images.clear();
+    m_offscreenViews.clear();
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+        const ManagedTexture& target = m_targetPool->request("OffscreenTarget_" + std::to_string(i), {
+            .width = m_extent.width,
+            .height = m_extent.height,
+            .format = m_imageFormat,
+            .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+            .aspect = VK_IMAGE_ASPECT_COLOR_BIT,
+        });
+        m_images.push_back(target.image);
+        m_offscreenViews.push_back(target.view);
+    }
+}
+
 void SwapChain::cleanup() {
     if (m_swapChain != VK_NULL_HANDLE) {
         vkDestroySwapchainKHR(m_context->device(), m_swapChain, nullptr);
+        DeletionQueue::get().cancel(m_deletion);
         m_swapChain = VK_NULL_HANDLE;
     }
 }
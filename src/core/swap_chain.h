@@ -5,31 +5,47 @@
 #include "context.h"
 #include <vector>
 
+#include "deletion_queue.h"
 #include "image_views.h"
+#include "render_target_pool.h"
 
 
 class SwapChain final {
 public:
     SwapChain(Context* context, Window* window);
+    // Headless: backs the "swapchain" with offscreen targets from the pool
+    SwapChain(Context* context, RenderTargetPool* targetPool, VkExtent2D extent);
     SwapChain(const SwapChain&) = delete;
     SwapChain& operator=(const SwapChain&) = delete;
     SwapChain(SwapChain&&) = delete;
     SwapChain& operator=(SwapChain&&) = delete;
 
     void recreate();
+    // Headless only: there is no surface to take the extent from. Call recreate() afterwards.
+    void resizeOffscreen(VkExtent2D extent);
     VkSwapchainKHR handle() const { return m_swapChain; }
     VkExtent2D extent() const { return m_extent; }
     VkFormat format() const { return m_imageFormat; }
     const std::vector<VkImage>& images() const { return m_images; }
-    std::vector<VkImageView> imagesViews() const { return m_imageViews.get()->views(); }
+    std::vector<VkImageView> imagesViews() const { return m_imageViews ? m_imageViews->views() : m_offscreenViews; }
     VkImage getCurrentImage(uint32_t imageIndex) const {
         return m_images[imageIndex];
     }
 
+    bool isOffscreen() const { return m_swapChain == VK_NULL_HANDLE; }
+    // Layout the final image is left in at the end of a frame
+    VkImageLayout presentLayout() const {
+        return isOffscreen() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    }
+
+    // One offscreen image per frame in flight, readable by vkCmdCopyImageToBuffer
+    static constexpr VkFormat OFFSCREEN_FORMAT = VK_FORMAT_R8G8B8A8_SRGB;
+
 
 private:
     void createSwapChain();
     void createImageViews();
+    void createOffscreenImages();
     void cleanup();
 
     static VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
@@ -37,10 +53,13 @@ private:
     VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities) const;
 
     Context* m_context;
-    Window* m_window;
+    Window* m_window = nullptr;
     VkSwapchainKHR m_swapChain = VK_NULL_HANDLE;
+    DeletionQueue::Handle m_deletion = DeletionQueue::INVALID_HANDLE;
     VkFormat m_imageFormat;
     VkExtent2D m_extent;
     std::vector<VkImage> m_images;
     std::unique_ptr<ImageViews> m_imageViews;
+    std::vector<VkImageView> m_offscreenViews;
+    RenderTargetPool* m_targetPool = nullptr;
 };
@@ -0,0 +1,52 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace {
+    thread_local uint32_t workerIndex = ThreadPool::NOT_A_WORKER;
+}
+
+ThreadPool::ThreadPool(uint32_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_workers.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; ++i) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+
+    // Workers drain the remaining queue before exiting
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+uint32_t ThreadPool::currentWorkerIndex() {
+    return workerIndex;
+}
+
+void ThreadPool::workerLoop(uint32_t index) {
+    workerIndex = index;
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+            if (m_stopping && m_jobs.empty()) {
+                return;
+            }
+            job = std::move(m_jobs.front());
+            m_jobs.pop();
+        }
+        job();
+    }
+}
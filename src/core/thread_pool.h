@@ -0,0 +1,56 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed-size worker pool for CPU-side jobs (asset decoding, startup pipeline builds and similar).
+// Jobs must not touch Vulkan objects that are externally synchronized.
+class ThreadPool {
+public:
+    // threadCount == 0 picks one worker per hardware thread
+    explicit ThreadPool(uint32_t threadCount = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+    ThreadPool& operator=(ThreadPool&&) = delete;
+
+    template<typename F>
+    auto submit(F&& job) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+
+        // std::function needs a copyable target, so the packaged_task lives behind a shared_ptr
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+        std::future<Result> future = task->get_future();
+        {
+            std::lock_guard lock(m_mutex);
+            m_jobs.emplace([task]() { (*task)(); });
+        }
+        m_condition.notify_one();
+        return future;
+    }
+
+    uint32_t threadCount() const { return static_cast<uint32_t>(m_workers.size()); }
+
+    // Index of the calling worker in [0, threadCount()), or NOT_A_WORKER on any other thread.
+    // Lets jobs pick per-thread resources such as command pools without locking.
+    static constexpr uint32_t NOT_A_WORKER = UINT32_MAX;
+    static uint32_t currentWorkerIndex();
+
+private:
+    void workerLoop(uint32_t workerIndex);
+
+    std::vector<std::thread> m_workers;
+    std::queue<std::function<void()>> m_jobs;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stopping = false;
+};
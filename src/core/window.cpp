@@ -15,7 +15,7 @@ Window::Window(int width, int height, const char* title)
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
     m_window = glfwCreateWindow(width, height, title, nullptr, nullptr);
 
-    DeletionQueue::get().pushFunction("Window", [this]() {
+    DeletionQueue::get().push([this]() {
         if (m_window) glfwDestroyWindow(m_window);
         glfwTerminate();
     });
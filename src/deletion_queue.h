@@ -1,17 +1,46 @@
 // DeletionQueue.h
 #pragma once
 
-#pragma once
-
-#include <string>
-#include <vector>
-#include <functional>
 #include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+// Destroys GPU objects. Registration returns a handle: the entry runs at shutdown (flush, in reverse
+// registration order) unless it is cancelled, or retired, in which case it runs once the frames in
+// flight that could still reference the object have completed. Cancelled and retired slots are
+// reused; their handles carry a generation so a stale one finds nothing.
+//
+// push() only takes deletors that fit inline (up to INLINE_SIZE bytes of trivially
+// copyable captures, e.g. a device plus two handles), so registering one allocates nothing beyond
+// the slot table. Deletors that own memory, such as a list of handles for a whole group, go through
+// pushGroup() and are boxed.
 class DeletionQueue
 {
 public:
-    using Deletor = std::function<void()>;
+    struct Handle
+    {
+        uint32_t index = UINT32_MAX;
+        uint32_t generation = 0;
+
+        bool operator==(const Handle&) const = default;
+    };
+    static constexpr Handle INVALID_HANDLE{ UINT32_MAX, 0 };
+
+    // Frames a retired entry waits; the renderer checks it against MAX_FRAMES_IN_FLIGHT
+    static constexpr uint32_t RETIRE_LATENCY = 2;
+
+    static constexpr size_t INLINE_SIZE = 4 * sizeof(void*);
+
+    template <typename F>
+    static constexpr bool storedInline = sizeof(std::decay_t<F>) <= INLINE_SIZE &&
+        alignof(std::decay_t<F>) <= alignof(void*) && std::is_trivially_copyable_v<std::decay_t<F>>;
 
     static DeletionQueue& get()
     {
@@ -19,37 +48,225 @@ public:
         return instance;
     }
 
+    // Thread-safe: pipeline build jobs register their objects from worker threads
+    template <typename F>
+    Handle push(F&& deletor)
+    {
+        static_assert(storedInline<F>, "Deletor captures too much to be stored inline; capture less or use pushGroup");
+        return insert(makeEntry(std::forward<F>(deletor)));
+    }
+
+    // For deletors that own memory; boxed on the heap
+    template <typename F>
+    Handle pushGroup(F&& deletor)
+    {
+        return insert(makeEntry(std::forward<F>(deletor)));
+    }
+
+    // The owner destroyed the object itself
+    void cancel(Handle handle)
+    {
+        Entry entry;
+        {
+            std::lock_guard lock(mutex);
+            entry = take(handle);
+        }
+        entry.discard();
+    }
+
+    // The object is no longer used by frames recorded from now on
+    void retire(Handle handle)
+    {
+        std::lock_guard lock(mutex);
+        Entry entry = take(handle);
+        if (entry.run)
+            retiredBucket().push_back(entry);
+    }
 
-    void pushFunction(const std::string& name, Deletor&& deletor)
+    // Main thread, after the frame slot's fence wait: runs what was retired RETIRE_LATENCY frames ago
+    void collect()
     {
-        for (auto& entry : entries)
+        std::vector<Entry> ready;
         {
-            if (entry.name == name)
+            std::lock_guard lock(mutex);
+            for (RetiredFrame& retired : ring)
             {
-                entry.deletor = std::move(deletor);
-                return;
+                if (retired.frame + RETIRE_LATENCY <= submittedFrames)
+                {
+                    ready.insert(ready.end(), retired.entries.begin(), retired.entries.end());
+                    retired.entries.clear();
+                }
             }
         }
-        entries.push_back({ name, std::move(deletor) });
+        for (Entry& entry : ready)
+            entry.execute();
     }
 
+    // Main thread, after each queue submission
+    void advanceFrame()
+    {
+        std::lock_guard lock(mutex);
+        ++submittedFrames;
+    }
+
+    // Shutdown, with the device idle
     void flush()
     {
-        for (auto it = entries.rbegin(); it != entries.rend(); ++it)
+        std::vector<std::pair<uint64_t, Entry>> flushed;
+        std::vector<Entry> retiredEntries;
         {
-            if (it->deletor)
-                it->deletor();
+            std::lock_guard lock(mutex);
+            for (uint32_t index = 0; index < slots.size(); ++index)
+            {
+                if (slots[index].entry.run)
+                {
+                    flushed.emplace_back(slots[index].serial, slots[index].entry);
+                    release(index);
+                }
+            }
+            for (RetiredFrame& retired : ring)
+            {
+                retiredEntries.insert(retiredEntries.end(), retired.entries.begin(), retired.entries.end());
+                retired.entries.clear();
+            }
         }
-        entries.clear();
+        // Retired objects were created after the device and allocator they depend on
+        for (Entry& entry : retiredEntries)
+            entry.execute();
+
+        // Reused slots are out of registration order; the serial restores it
+        std::sort(flushed.begin(), flushed.end(),
+                  [](const auto& a, const auto& b) { return a.first > b.first; });
+        for (auto& [serial, entry] : flushed)
+            entry.execute();
+    }
+
+    // Slots in use; stays flat while objects are retired as fast as they are created
+    size_t liveCount() const
+    {
+        std::lock_guard lock(mutex);
+        return slots.size() - freeSlots.size();
     }
 
 private:
     struct Entry
     {
-        std::string name;
-        Deletor deletor;
+        // Runs the deletor if execute is set, and releases its storage
+        void (*run)(std::byte* storage, bool execute) = nullptr;
+        alignas(void*) std::byte storage[INLINE_SIZE];
+
+        void execute()
+        {
+            if (run)
+                run(storage, true);
+            run = nullptr;
+        }
+
+        void discard()
+        {
+            if (run)
+                run(storage, false);
+            run = nullptr;
+        }
+    };
+
+    struct Slot
+    {
+        Entry entry;
+        uint64_t serial = 0;    // Registration order, for flush
+        uint32_t generation = 0;
     };
 
-    std::vector<Entry> entries;
-};
+    struct RetiredFrame
+    {
+        uint64_t frame = 0;
+        std::vector<Entry> entries;
+    };
+
+    template <typename F>
+    static Entry makeEntry(F&& deletor)
+    {
+        using Fn = std::decay_t<F>;
+        Entry entry;
+        if constexpr (storedInline<F>)
+        {
+            new (entry.storage) Fn(std::forward<F>(deletor));
+            entry.run = [](std::byte* storage, bool execute)
+            {
+                if (execute)
+                    (*std::launder(reinterpret_cast<Fn*>(storage)))();
+            };
+        }
+        else
+        {
+            Fn* boxed = new Fn(std::forward<F>(deletor));
+            std::memcpy(entry.storage, &boxed, sizeof(boxed));
+            entry.run = [](std::byte* storage, bool execute)
+            {
+                Fn* boxed;
+                std::memcpy(&boxed, storage, sizeof(boxed));
+                if (execute)
+                    (*boxed)();
+                delete boxed;
+            };
+        }
+        return entry;
+    }
+
+    Handle insert(const Entry& entry)
+    {
+        std::lock_guard lock(mutex);
+        uint32_t index;
+        if (!freeSlots.empty())
+        {
+            index = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else
+        {
+            index = static_cast<uint32_t>(slots.size());
+            slots.emplace_back();
+        }
+        Slot& slot = slots[index];
+        slot.entry = entry;
+        slot.serial = nextSerial++;
+        return { index, slot.generation };
+    }
+
+    // Caller holds the lock. A stale handle (its slot was freed, and possibly reused) finds nothing.
+    Entry take(Handle handle)
+    {
+        if (handle.index >= slots.size())
+            return {};
+        Slot& slot = slots[handle.index];
+        if (slot.generation != handle.generation || !slot.entry.run)
+            return {};
+        Entry entry = slot.entry;
+        release(handle.index);
+        return entry;
+    }
+
+    // Caller holds the lock
+    void release(uint32_t index)
+    {
+        slots[index].entry.run = nullptr;
+        ++slots[index].generation;
+        freeSlots.push_back(index);
+    }
 
+    // Caller holds the lock. A slot still holding an older frame that was not collected yet keeps
+    // its entries and waits for the newer frame instead.
+    std::vector<Entry>& retiredBucket()
+    {
+        RetiredFrame& retired = ring[submittedFrames % ring.size()];
+        retired.frame = submittedFrames;
+        return retired.entries;
+    }
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    uint64_t nextSerial = 0;
+    std::array<RetiredFrame, RETIRE_LATENCY + 1> ring;
+    uint64_t submittedFrames = 0;
+    mutable std::mutex mutex;
+};
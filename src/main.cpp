@@ -1,9 +1,9 @@
 #include <iostream>
 #include "application.h"
 
-int main() {
-    VulkanApplication app;
+int main(int argc, char** argv) {
     try {
+        VulkanApplication app(ApplicationConfig::fromCommandLine(argc, argv));
         app.run();
     }
     catch (const std::exception& e) {
@@ -3,31 +3,42 @@
 #include "depth_format.h"
 #include "descriptors/descriptor_set_layout.h"
 #include "deletion_queue.h"
+#include "image_transition_manager.h"
+#include "shared/render_settings.h"
+#include "config.h"
 
 #include <chrono>
 #include <fstream>
 #include <stdexcept>
+#include <cstring>
 
 #include "user/user_render_targets/main_scene_target.h"
 #include "user_render_targets/imgui_target.h"
 
+static_assert(DeletionQueue::RETIRE_LATENCY == MAX_FRAMES_IN_FLIGHT,
+              "Retired objects must outlive every frame in flight");
 
-Renderer::Renderer(Context* context, Window* window, VmaAllocator allocator, Camera* camera)
+Renderer::Renderer(Context* context, Window* window, VmaAllocator allocator, Camera* camera, VkExtent2D headlessExtent)
     : m_context(context), m_window(window), m_allocator(allocator) {
 
-    initializeSharedResources(camera);
+    initializeSharedResources(camera, headlessExtent);
     createCommandBuffers();
     createSyncObjects();
 
-    // Create targets
+    // Create targets (no UI without a window)
     m_renderTargets.push_back(std::make_unique<MainSceneTarget>());
-    m_renderTargets.push_back(std::make_unique<ImGuiTarget>());
+    if (!isHeadless()) {
+        m_renderTargets.push_back(std::make_unique<ImGuiTarget>());
+    }
 
     // Initialize targets
     for (auto& target : m_renderTargets) {
         target->initialize(m_sharedResources);
     }
 
+    // Pipelines were built on the workers while the targets set up everything else
+    m_pipelineBuilds->wait();
+
 }
 
 void Renderer::createSyncObjects() {
@@ -49,18 +60,15 @@ void Renderer::createSyncObjects() {
 
         auto device = m_context->device();
 
-        DeletionQueue::get().pushFunction("ImageSemaphore_" + std::to_string(i),
-            [device, sem = frame.imageAvailableSemaphore]() {
+        DeletionQueue::get().push([device, sem = frame.imageAvailableSemaphore]() {
                 vkDestroySemaphore(device, sem, nullptr);
             });
 
-        DeletionQueue::get().pushFunction("RenderSemaphore_" + std::to_string(i),
-            [device, sem = frame.renderFinishedSemaphore]() {
+        DeletionQueue::get().push([device, sem = frame.renderFinishedSemaphore]() {
                 vkDestroySemaphore(device, sem, nullptr);
             });
 
-        DeletionQueue::get().pushFunction("Fence_" + std::to_string(i),
-            [device, f = frame.inFlightFence]() {
+        DeletionQueue::get().push([device, f = frame.inFlightFence]() {
                 vkDestroyFence(device, f, nullptr);
             });
     }
@@ -68,25 +76,30 @@ void Renderer::createSyncObjects() {
 
 void Renderer::createCommandBuffers() {
     m_frames.resize(MAX_FRAMES_IN_FLIGHT);
-    VkExtent2D extent = m_swapChain->extent();
-
     for (auto& frame : m_frames) {
         frame.commandBuffer = m_commandManager->createCommandBuffer();
-        frame.depthTexture = m_textureManager->createTexture(
-           extent.width,
-           extent.height,
-           m_depthFormat->handle(),
-           VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
-           VMA_MEMORY_USAGE_GPU_ONLY,
-           VK_IMAGE_ASPECT_DEPTH_BIT,
-           false
-       );
+    }
+    requestFrameTargets();
+}
+
+void Renderer::requestFrameTargets() {
+    const VkExtent2D extent = m_swapChain->extent();
+    for (size_t i = 0; i < m_frames.size(); ++i) {
+        m_frames[i].depthTexture = m_renderTargetPool->request("Depth_" + std::to_string(i), {
+            .width = extent.width,
+            .height = extent.height,
+            .format = m_depthFormat->handle(),
+            .usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+            .aspect = VK_IMAGE_ASPECT_DEPTH_BIT,
+        });
     }
 }
 
-void Renderer::initializeSharedResources(Camera* camera) {
-    m_swapChain = std::make_unique<SwapChain>(m_context, m_window);
+void Renderer::initializeSharedResources(Camera* camera, VkExtent2D headlessExtent) {
     m_depthFormat = std::make_unique<DepthFormat>(m_context->physicalDevice());
+    m_gBufferFormats = std::make_unique<GBufferFormats>(
+        m_context->physicalDevice(), renderSettings.hdrFormat, renderSettings.normalFormat
+    );
 
     m_commandManager = std::make_unique<CommandManager>(
         m_context->device(),
@@ -99,9 +112,30 @@ void Renderer::initializeSharedResources(Camera* camera) {
     );
 
     m_textureManager = std::make_unique<TextureManager>(
-        m_context->device(), m_allocator, m_commandManager.get(), m_bufferManager.get(), m_context->debugMessenger()
+        m_context->physicalDevice(), m_context->device(), m_allocator, m_commandManager.get(), m_bufferManager.get(), m_context->debugMessenger()
     );
 
+    m_renderTargetPool = std::make_unique<RenderTargetPool>(
+        m_context->device(), m_allocator, m_context->debugMessenger()
+    );
+
+    m_profiler = std::make_unique<GpuProfiler>(m_context);
+    m_threadPool = std::make_unique<ThreadPool>();
+    m_pipelineBuilds = std::make_unique<PipelineBuildQueue>(m_threadPool.get());
+    m_recorder = std::make_unique<ParallelRecorder>(
+        m_context, m_threadPool.get(),
+        m_context->findQueueFamilies(m_context->physicalDevice()).graphicsFamily.value()
+    );
+
+    if (isHeadless()) {
+        if (headlessExtent.width == 0 || headlessExtent.height == 0) {
+            throw std::invalid_argument("Headless renderer needs a non-zero extent!");
+        }
+        m_swapChain = std::make_unique<SwapChain>(m_context, m_renderTargetPool.get(), headlessExtent);
+    } else {
+        m_swapChain = std::make_unique<SwapChain>(m_context, m_window);
+    }
+
 
     m_sharedResources = {
         .context = m_context,
@@ -113,8 +147,13 @@ void Renderer::initializeSharedResources(Camera* camera) {
         .currentFrame = &m_currentFrame,
         .allocator = m_allocator,
         .depthFormat = m_depthFormat->handle(),
+        .gBufferFormats = m_gBufferFormats.get(),
         .camera = camera,
-        .frames = &m_frames
+        .frames = &m_frames,
+        .profiler = m_profiler.get(),
+        .threadPool = m_threadPool.get(),
+        .pipelineBuilds = m_pipelineBuilds.get(),
+        .recorder = m_recorder.get()
     };
 }
 
@@ -126,19 +165,34 @@ void Renderer::drawFrame() {
     vkWaitForFences(m_context->device(), 1, &currentFrame.inFlightFence, VK_TRUE, UINT64_MAX);
     vkResetFences(m_context->device(), 1, &currentFrame.inFlightFence);
 
-    // Try to acquire next image
-    uint32_t imageIndex;
-    VkResult result = vkAcquireNextImageKHR(
-        m_context->device(),
-        m_swapChain->handle(),
-        UINT64_MAX,
-        currentFrame.imageAvailableSemaphore,
-        VK_NULL_HANDLE,
-        &imageIndex
-    );
+    // The slot's previous frame has retired, so its timestamps are available
+    resolveFrameTiming(m_currentFrame);
 
-    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-        return;
+    // The slot's previous frame was the last that could use anything retired back then
+    DeletionQueue::get().collect();
+
+    if (m_shaderReloader) {
+        m_shaderReloader->applyPending();
+    }
+    m_recorder->beginFrame(m_currentFrame);
+    const auto cpuStart = std::chrono::high_resolution_clock::now();
+
+    // Offscreen targets are owned per frame slot; otherwise acquire the next swapchain image
+    uint32_t imageIndex = m_currentFrame;
+    VkResult result = VK_SUCCESS;
+    if (!isHeadless()) {
+        result = vkAcquireNextImageKHR(
+            m_context->device(),
+            m_swapChain->handle(),
+            UINT64_MAX,
+            currentFrame.imageAvailableSemaphore,
+            VK_NULL_HANDLE,
+            &imageIndex
+        );
+
+        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            return;
+        }
     }
     m_sharedResources.currentFrame = &m_currentFrame;
 
@@ -153,10 +207,15 @@ void Renderer::drawFrame() {
     currentFrame.commandBuffer->reset();
     currentFrame.commandBuffer->begin();
 
+    VkCommandBuffer cmd = currentFrame.commandBuffer->handle();
+    m_profiler->beginFrame(cmd, m_currentFrame, m_frameNumber);
+
     for (auto& target : m_renderTargets) {
-        target->render(currentFrame.commandBuffer->handle(), imageIndex);
+        target->render(cmd, imageIndex);
     }
 
+    m_profiler->endFrame(cmd);
+
     currentFrame.commandBuffer->end();
 
     // Set up Vulkan Synchronization 2 structures
@@ -178,42 +237,128 @@ void Renderer::drawFrame() {
 
     VkCommandBufferSubmitInfo cmdBufferInfo{
         .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
-        .commandBuffer = currentFrame.commandBuffer->handle()
+        .commandBuffer = cmd
     };
 
+    // Headless frames have nothing to acquire or present, so no semaphores
+    const uint32_t semaphoreCount = isHeadless() ? 0 : 1;
     VkSubmitInfo2 submitInfo{
         .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
-        .waitSemaphoreInfoCount = 1,
+        .waitSemaphoreInfoCount = semaphoreCount,
         .pWaitSemaphoreInfos = &waitSemaphoreInfo,
         .commandBufferInfoCount = 1,
         .pCommandBufferInfos = &cmdBufferInfo,
-        .signalSemaphoreInfoCount = 1,
+        .signalSemaphoreInfoCount = semaphoreCount,
         .pSignalSemaphoreInfos = &signalSemaphoreInfo
     };
 
     if (vkQueueSubmit2(m_context->graphicsQueue(), 1, &submitInfo, currentFrame.inFlightFence) != VK_SUCCESS) {
         throw std::runtime_error("Failed to submit draw command buffer!");
     }
+    DeletionQueue::get().advanceFrame();
 
-    VkSwapchainKHR swapChain = m_swapChain->handle();
-    VkPresentInfoKHR presentInfo{
-        .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
-        .waitSemaphoreCount = 1,
-        .pWaitSemaphores = &currentFrame.renderFinishedSemaphore,
-        .swapchainCount = 1,
-        .pSwapchains = &swapChain,
-        .pImageIndices = &imageIndex
-    };
-
-    result = vkQueuePresentKHR(m_context->presentQueue(), &presentInfo);
-    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_framebufferResized) {
-        m_framebufferResized = false;
-        recreateSwapChain();
+    if (m_captureFrameTimings) {
+        const std::chrono::duration<double, std::milli> cpuTime = std::chrono::high_resolution_clock::now() - cpuStart;
+        m_frameTimings.push_back({ .cpuMs = cpuTime.count() });
+    }
+    m_frameNumber++;
+    m_lastImageIndex = imageIndex;
+
+    if (!isHeadless()) {
+        VkSwapchainKHR swapChain = m_swapChain->handle();
+        VkPresentInfoKHR presentInfo{
+            .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+            .waitSemaphoreCount = 1,
+            .pWaitSemaphores = &currentFrame.renderFinishedSemaphore,
+            .swapchainCount = 1,
+            .pSwapchains = &swapChain,
+            .pImageIndices = &imageIndex
+        };
+
+        result = vkQueuePresentKHR(m_context->presentQueue(), &presentInfo);
+        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_framebufferResized) {
+            m_framebufferResized = false;
+            recreateSwapChain();
+        }
     }
 
     m_currentFrame = (m_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 }
 
+void Renderer::resolveFrameTiming(uint32_t frameSlot) {
+    // Also feeds the profiler's rolling statistics, so it runs even when not capturing
+    std::optional<GpuProfiler::FrameResult> result = m_profiler->collect(frameSlot);
+    if (!result || result->frameNumber >= m_frameTimings.size()) {
+        return;
+    }
+    FrameTiming& timing = m_frameTimings[result->frameNumber];
+    timing.gpuMs = result->frameMs;
+    timing.passGpuMs = std::move(result->scopeMs);
+}
+
+void Renderer::setFrameTimingCapture(bool enabled) {
+    m_captureFrameTimings = enabled;
+    if (!enabled) {
+        return; // Keep the captured timings readable
+    }
+    // Frames still in flight would be attributed to the new capture, so drain them first
+    resolveFrameTimings();
+    m_frameTimings.clear();
+    m_frameNumber = 0;
+}
+
+void Renderer::resolveFrameTimings() {
+    vkDeviceWaitIdle(m_context->device());
+    for (uint32_t slot = 0; slot < MAX_FRAMES_IN_FLIGHT; ++slot) {
+        resolveFrameTiming(slot);
+    }
+}
+
+std::vector<uint8_t> Renderer::captureLastFrame() {
+    if (m_swapChain->format() != SwapChain::OFFSCREEN_FORMAT) {
+        throw std::runtime_error("Frame capture is only supported for offscreen targets!");
+    }
+    vkDeviceWaitIdle(m_context->device());
+
+    const VkExtent2D extent = m_swapChain->extent();
+    const VkDeviceSize size = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+
+    ManagedBuffer readback = m_bufferManager->createBuffer(
+        size,
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_TO_CPU
+    );
+
+    VkCommandBuffer cmd = m_commandManager->beginSingleTimeCommands();
+    const VkImage image = m_swapChain->getCurrentImage(m_lastImageIndex);
+
+    // The image is already in TRANSFER_SRC; make the color writes visible to the copy
+    ImageTransitionManager::BarrierBatch barriers;
+    barriers.image(ImageTransitionManager::mipRangeBarrier(
+        image,
+        m_swapChain->presentLayout(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+        VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_READ_BIT,
+        0, 1
+    ));
+    barriers.flush(cmd);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+    region.imageExtent = { extent.width, extent.height, 1 };
+    vkCmdCopyImageToBuffer(cmd, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback.buffer, 1, &region);
+
+    m_commandManager->endSingleTimeCommands(cmd);
+
+    std::vector<uint8_t> pixels(size);
+    void* data;
+    vmaInvalidateAllocation(m_allocator, readback.allocation, 0, VK_WHOLE_SIZE);
+    vmaMapMemory(m_allocator, readback.allocation, &data);
+    memcpy(pixels.data(), data, static_cast<size_t>(size));
+    vmaUnmapMemory(m_allocator, readback.allocation);
+    return pixels;
+}
+
 
 void Renderer::recreateSwapChain() {
     // Wait for all operations to complete
@@ -222,19 +367,8 @@ void Renderer::recreateSwapChain() {
     // Recreate swapchain
     m_swapChain->recreate();
 
-    VkExtent2D extent = m_swapChain->extent();
-    for (auto& frame : m_frames) {
-        frame.commandBuffer = m_commandManager->createCommandBuffer();
-        frame.depthTexture = m_textureManager->createTexture(
-           extent.width,
-           extent.height,
-           m_depthFormat->handle(),
-           VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
-           VMA_MEMORY_USAGE_GPU_ONLY,
-           VK_IMAGE_ASPECT_DEPTH_BIT,
-           false
-       );
-    }
+    // Command buffers are extent-independent; depth targets are reallocated only if the extent changed
+    requestFrameTargets();
 
     // Recreate targets
     for (auto& target : m_renderTargets) {
@@ -242,10 +376,35 @@ void Renderer::recreateSwapChain() {
     }
 }
 
+void Renderer::resize(VkExtent2D extent) {
+    m_swapChain->resizeOffscreen(extent);
+    recreateSwapChain();
+}
+
+Renderer::MemoryUsage Renderer::memoryUsage() const {
+    VmaTotalStatistics stats{};
+    vmaCalculateStatistics(m_allocator, &stats);
+    return {
+        .allocationBytes = stats.total.statistics.allocationBytes,
+        .allocationCount = stats.total.statistics.allocationCount,
+        .renderTargetAllocations = m_renderTargetPool->allocationCount(),
+        .deletionEntries = DeletionQueue::get().liveCount(),
+    };
+}
+
 void Renderer::markFramebufferResized() {
     m_framebufferResized = true;
 }
 
+void Renderer::enableShaderHotReload() {
+    m_shaderReloader = std::make_unique<ShaderHotReloader>(
+        m_context,
+        std::string(SOURCE_RESOURCE_DIR) + "/shaders",
+        std::string(BUILD_RESOURCE_DIR) + "/shaders",
+        GLSLC_EXECUTABLE
+    );
+}
+
 
 void Renderer::cleanup() {
     /* Debugging VMA */
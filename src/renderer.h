@@ -4,26 +4,69 @@
 #include "target/render_target.h"
 #include <memory>
 #include <vector>
+#include <array>
 #include "image_views.h"
 #include "depth_format.h"
+#include "gbuffer_formats.h"
+#include "profiling/gpu_profiler.h"
+#include "thread_pool.h"
+#include "parallel_recorder.h"
+#include "pipeline_build_queue.h"
+#include "shader_hot_reloader.h"
+#include "render_target_pool.h"
+
+struct FrameTiming {
+    double cpuMs = 0.0; // Uniform update, command recording and submission
+    double gpuMs = 0.0; // Timestamp delta of the frame's command buffer
+    std::vector<double> passGpuMs; // Indexed like GpuProfiler::scopeStats()
+};
 
 class Renderer {
 public:
 
-    Renderer(Context* context, Window* window, VmaAllocator allocator, Camera* camera);
+    // A null window renders headless into offscreen targets of headlessExtent
+    Renderer(Context* context, Window* window, VmaAllocator allocator, Camera* camera,
+             VkExtent2D headlessExtent = {0, 0});
     ~Renderer();
 
     void drawFrame();
     void recreateSwapChain();
     void markFramebufferResized();
 
+    // Starts watching shaders/ and swaps recompiled pipelines in between frames
+    void enableShaderHotReload();
+
+    bool isHeadless() const { return m_window == nullptr; }
+    VkExtent2D extent() const { return m_swapChain->extent(); }
+    // Headless only: renders into offscreen targets of the new extent from the next frame on
+    void resize(VkExtent2D extent);
+
+    struct MemoryUsage {
+        VkDeviceSize allocationBytes = 0;
+        uint32_t allocationCount = 0;
+        uint32_t renderTargetAllocations = 0; // Images created by the render target pool so far
+        size_t deletionEntries = 0;           // Live DeletionQueue slots
+    };
+    MemoryUsage memoryUsage() const;
+
+    // Frame timing capture (indexed by frame number since capture started)
+    void setFrameTimingCapture(bool enabled);
+    void resolveFrameTimings(); // Waits for the GPU and fills the remaining GPU times
+    const std::vector<FrameTiming>& frameTimings() const { return m_frameTimings; }
+    const GpuProfiler& profiler() const { return *m_profiler; }
+
+    // Copies the most recently rendered image to host memory as tightly packed RGBA8
+    std::vector<uint8_t> captureLastFrame();
+
 private:
 
 
     void createSyncObjects();
     void createCommandBuffers();
+    void requestFrameTargets();
+    void resolveFrameTiming(uint32_t frameSlot);
     void cleanup();
-    void initializeSharedResources(Camera* camera);
+    void initializeSharedResources(Camera* camera, VkExtent2D headlessExtent);
 
     Context* m_context;
     Window* m_window;
@@ -38,9 +81,15 @@ private:
     std::unique_ptr<CommandManager> m_commandManager;
     std::unique_ptr<BufferManager> m_bufferManager;
     std::unique_ptr<TextureManager> m_textureManager;
+    std::unique_ptr<RenderTargetPool> m_renderTargetPool;
+    std::unique_ptr<ThreadPool> m_threadPool;
+    std::unique_ptr<PipelineBuildQueue> m_pipelineBuilds;
+    std::unique_ptr<ShaderHotReloader> m_shaderReloader;
+    std::unique_ptr<ParallelRecorder> m_recorder;
 
     // Images
     std::unique_ptr<DepthFormat> m_depthFormat;
+    std::unique_ptr<GBufferFormats> m_gBufferFormats;
 
     // Targets
     std::vector<std::unique_ptr<RenderTarget>> m_renderTargets;
@@ -48,4 +97,11 @@ private:
     // Frame resources
     std::vector<Frame> m_frames;
     uint32_t m_currentFrame = 0;
+    uint32_t m_lastImageIndex = 0;
+
+    // Frame timing
+    std::unique_ptr<GpuProfiler> m_profiler;
+    bool m_captureFrameTimings = false;
+    uint64_t m_frameNumber = 0;
+    std::vector<FrameTiming> m_frameTimings;
 };
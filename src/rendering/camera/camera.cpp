@@ -23,7 +23,7 @@ glm::mat4 Camera::GetViewMatrix() const {
     return glm::lookAt(Position, Position + Front, WorldUp);
 }
 glm::mat4 Camera::GetProjectionMatrix(float aspectRatio) const {
-    glm::mat4 proj = glm::perspective(glm::radians(Zoom), aspectRatio, 0.1f, 100.0f);
+    glm::mat4 proj = glm::perspective(glm::radians(Zoom), aspectRatio, NearPlane, FarPlane);
     proj[1][1] *= -1.0f;
     return proj;
 }
@@ -79,6 +79,13 @@ void Camera::ProcessMouseScroll(float yoffset) {
     if (Zoom < 1.0f) Zoom = 1.0f;
     if (Zoom > 45.0f) Zoom = 45.0f;
 }
+void Camera::SetPose(glm::vec3 position, float yaw, float pitch) {
+    Position = position;
+    Yaw = yaw;
+    Pitch = std::clamp(pitch, -89.0f, 89.0f);
+    updateCameraVectors();
+}
+
 void Camera::updateCameraVectors() {
     // Calculate front vector from yaw and pitch
     glm::vec3 front;
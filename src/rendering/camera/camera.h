@@ -27,6 +27,9 @@ public:
     void ProcessHorizontalMovement(float yoffset);
     void ProcessMouseScroll(float yoffset);
 
+    // Places the camera directly (scripted paths, benchmarks)
+    void SetPose(glm::vec3 position, float yaw, float pitch);
+
     // Camera parameters
     glm::vec3 Position;
     glm::vec3 Front{glm::vec3(0.0f, 0.0f, 1.0f)};
@@ -38,6 +41,10 @@ public:
     float MouseSensitivity{0.1f};
     float Zoom{45.0f};
 
+    // Clip planes of GetProjectionMatrix; the light cluster slices are spaced between them
+    static constexpr float NearPlane = 0.1f;
+    static constexpr float FarPlane = 100.0f;
+
     float Yaw;
     float Pitch;
     float Roll;
@@ -0,0 +1,48 @@
+#include "camera_path.h"
+#include "camera.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+CameraPath::CameraPath(std::vector<Keyframe> keyframes)
+    : m_keyframes(std::move(keyframes)) {
+    if (m_keyframes.empty()) {
+        throw std::invalid_argument("Camera path needs at least one keyframe!");
+    }
+}
+
+void CameraPath::apply(Camera& camera, float t) const {
+    if (m_keyframes.size() == 1) {
+        camera.SetPose(m_keyframes[0].position, m_keyframes[0].yaw, m_keyframes[0].pitch);
+        return;
+    }
+
+    const float segments = static_cast<float>(m_keyframes.size() - 1);
+    const float scaled = std::clamp(t, 0.0f, 1.0f) * segments;
+    const size_t index = std::min(static_cast<size_t>(scaled), m_keyframes.size() - 2);
+
+    // Smoothstep inside each segment so the camera eases through keyframes
+    float local = scaled - static_cast<float>(index);
+    local = local * local * (3.0f - 2.0f * local);
+
+    const Keyframe& a = m_keyframes[index];
+    const Keyframe& b = m_keyframes[index + 1];
+    camera.SetPose(
+        glm::mix(a.position, b.position, local),
+        glm::mix(a.yaw, b.yaw, local),
+        glm::mix(a.pitch, b.pitch, local)
+    );
+}
+
+CameraPath CameraPath::sponzaFlythrough() {
+    // Yaw keeps increasing instead of wrapping so interpolation never spins the long way round
+    return CameraPath({
+        { glm::vec3(-10.0f, 2.0f,  0.0f),   0.0f,   0.0f },
+        { glm::vec3(  0.0f, 2.0f,  0.0f),  20.0f,   5.0f },
+        { glm::vec3( 10.0f, 2.0f,  0.0f),  90.0f,   0.0f },
+        { glm::vec3( 10.0f, 6.0f,  3.5f), 180.0f, -15.0f },
+        { glm::vec3(  0.0f, 6.0f,  3.5f), 200.0f, -25.0f },
+        { glm::vec3(-10.0f, 2.0f, -2.0f), 270.0f,   0.0f },
+        { glm::vec3(-10.0f, 2.0f,  0.0f), 360.0f,   0.0f },
+    });
+}
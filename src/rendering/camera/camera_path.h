@@ -0,0 +1,27 @@
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+
+class Camera;
+
+// Deterministic keyframed camera path, sampled by normalized time instead of wall clock
+// so every benchmark run renders exactly the same sequence of views.
+class CameraPath {
+public:
+    struct Keyframe {
+        glm::vec3 position;
+        float yaw;
+        float pitch;
+    };
+
+    explicit CameraPath(std::vector<Keyframe> keyframes);
+
+    // t in [0, 1] spans the whole path
+    void apply(Camera& camera, float t) const;
+
+    // Fly-through of the Sponza atrium used by the headless benchmark
+    static CameraPath sponzaFlythrough();
+
+private:
+    std::vector<Keyframe> m_keyframes;
+};
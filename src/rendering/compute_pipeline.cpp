@@ -0,0 +1,81 @@
+#include "compute_pipeline.h"
+#include <stdexcept>
+
+#include "deletion_queue.h"
+#include "shader_module.h"
+
+ComputePipeline::ComputePipeline(
+    Context* context,
+    const std::string& shaderPath,
+    VkPushConstantRange pushConstantRange,
+    VkDescriptorSetLayout descriptorSetLayout
+) : m_context(context), m_shaderPath(shaderPath) {
+    createPipelineLayout(descriptorSetLayout, pushConstantRange);
+
+    m_pipeline = createPipeline();
+    registerDeletion();
+}
+
+void ComputePipeline::rebuild() {
+    VkPipeline rebuilt = createPipeline();
+    // Frames still in flight may use the old handle
+    DeletionQueue::get().retire(m_deletion);
+    m_pipeline = rebuilt;
+    registerDeletion();
+}
+
+bool ComputePipeline::usesShader(const std::string& spirvPath) const {
+    return m_shaderPath == spirvPath;
+}
+
+VkPipeline ComputePipeline::createPipeline() const {
+    const VkShaderModule shaderModule = createShaderModule(m_context->device(), readShaderFile(m_shaderPath));
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+        .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+        .module = shaderModule,
+        .pName = "main"
+    };
+    pipelineInfo.layout = m_pipelineLayout;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    const auto creationStart = std::chrono::steady_clock::now();
+    const VkResult result = vkCreateComputePipelines(m_context->device(), m_context->pipelineCache(), 1, &pipelineInfo, nullptr, &pipeline);
+    m_context->addPipelineCreationTime(std::chrono::steady_clock::now() - creationStart);
+    vkDestroyShaderModule(m_context->device(), shaderModule, nullptr);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create compute pipeline");
+    }
+    return pipeline;
+}
+
+void ComputePipeline::registerDeletion() {
+    VkDevice deviceCopy = m_context->device();
+    VkPipeline pipelineCopy = m_pipeline;
+    m_deletion = DeletionQueue::get().push([deviceCopy, pipelineCopy]() {
+        vkDestroyPipeline(deviceCopy, pipelineCopy, nullptr);
+    });
+}
+
+void ComputePipeline::createPipelineLayout(VkDescriptorSetLayout descriptorSetLayout, VkPushConstantRange pushConstantRange) {
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = descriptorSetLayout != VK_NULL_HANDLE ? 1 : 0;
+    pipelineLayoutInfo.pSetLayouts = descriptorSetLayout != VK_NULL_HANDLE ? &descriptorSetLayout : nullptr;
+    pipelineLayoutInfo.pushConstantRangeCount = pushConstantRange.size > 0 ? 1 : 0;
+    pipelineLayoutInfo.pPushConstantRanges = pushConstantRange.size > 0 ? &pushConstantRange : nullptr;
+
+    if (vkCreatePipelineLayout(m_context->device(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create compute pipeline layout");
+    }
+
+    VkDevice         deviceCopy = m_context->device();
+    VkPipelineLayout layoutCopy = m_pipelineLayout;
+
+    DeletionQueue::get().push([deviceCopy, layoutCopy]() {
+        vkDestroyPipelineLayout(deviceCopy, layoutCopy, nullptr);
+    });
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "context.h"
+#include "deletion_queue.h"
+#include "reloadable_pipeline.h"
+
+// Compute counterpart of Pipeline. Resources are reached through buffer device addresses in
+// push constants, so a descriptor set layout is optional; a zero-sized range means no push constants.
+class ComputePipeline : public ReloadablePipeline {
+public:
+    ComputePipeline(
+        Context* context,
+        const std::string& shaderPath,
+        VkPushConstantRange pushConstantRange,
+        VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE
+    );
+
+    ComputePipeline(const ComputePipeline&) = delete;
+    ComputePipeline& operator=(const ComputePipeline&) = delete;
+    ComputePipeline(ComputePipeline&&) = delete;
+    ComputePipeline& operator=(ComputePipeline&&) = delete;
+
+    VkPipeline handle() const { return m_pipeline; }
+    VkPipelineLayout layout() const { return m_pipelineLayout; }
+
+    void rebuild() override;
+    bool usesShader(const std::string& spirvPath) const override;
+
+private:
+    VkPipeline createPipeline() const;
+    void createPipelineLayout(VkDescriptorSetLayout descriptorSetLayout, VkPushConstantRange pushConstantRange);
+    void registerDeletion();
+
+    Context* m_context;
+    std::string m_shaderPath;
+    DeletionQueue::Handle m_deletion = DeletionQueue::INVALID_HANDLE;
+    VkPipeline m_pipeline = VK_NULL_HANDLE;
+    VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+};
@@ -0,0 +1,72 @@
+#include "frustum_culler.h"
+
+#include <cmath>
+
+void FrustumCuller::setPrimitives(std::span<const GLTFPrimitiveData> primitives) {
+    const size_t count = primitives.size();
+    for (auto* array : {&m_centerX, &m_centerY, &m_centerZ, &m_extentX, &m_extentY, &m_extentZ}) {
+        array->resize(count);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        m_centerX[i] = primitives[i].boundsCenter.x;
+        m_centerY[i] = primitives[i].boundsCenter.y;
+        m_centerZ[i] = primitives[i].boundsCenter.z;
+        m_extentX[i] = primitives[i].boundsExtents.x;
+        m_extentY[i] = primitives[i].boundsExtents.y;
+        m_extentZ[i] = primitives[i].boundsExtents.z;
+    }
+}
+
+std::array<glm::vec4, 6> FrustumCuller::extractPlanes(const glm::mat4& viewProj) {
+    // Gribb/Hartmann: planes are sums of the clip matrix rows; depth is [0, 1] (GLM_FORCE_DEPTH_ZERO_TO_ONE)
+    const glm::vec4 row0{viewProj[0][0], viewProj[1][0], viewProj[2][0], viewProj[3][0]};
+    const glm::vec4 row1{viewProj[0][1], viewProj[1][1], viewProj[2][1], viewProj[3][1]};
+    const glm::vec4 row2{viewProj[0][2], viewProj[1][2], viewProj[2][2], viewProj[3][2]};
+    const glm::vec4 row3{viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3]};
+
+    std::array<glm::vec4, 6> planes = {
+        row3 + row0,
+        row3 - row0,
+        row3 + row1,
+        row3 - row1,
+        row2,
+        row3 - row2
+    };
+    for (auto& plane : planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+    return planes;
+}
+
+void FrustumCuller::cull(const glm::mat4& viewProj, std::vector<uint32_t>& visible) const {
+    const size_t count = m_centerX.size();
+    m_inside.assign(count, 1);
+
+    const float* cx = m_centerX.data();
+    const float* cy = m_centerY.data();
+    const float* cz = m_centerZ.data();
+    const float* ex = m_extentX.data();
+    const float* ey = m_extentY.data();
+    const float* ez = m_extentZ.data();
+    uint8_t* inside = m_inside.data();
+
+    for (const glm::vec4& plane : extractPlanes(viewProj)) {
+        const float nx = plane.x, ny = plane.y, nz = plane.z, d = plane.w;
+        const float ax = std::abs(nx), ay = std::abs(ny), az = std::abs(nz);
+
+        // Box is outside when even its most positive corner is behind the plane
+        for (size_t i = 0; i < count; ++i) {
+            const float distance = nx * cx[i] + ny * cy[i] + nz * cz[i] + d;
+            const float radius = ax * ex[i] + ay * ey[i] + az * ez[i];
+            inside[i] &= static_cast<uint8_t>(distance + radius >= 0.0f);
+        }
+    }
+
+    visible.clear();
+    for (size_t i = 0; i < count; ++i) {
+        if (inside[i]) {
+            visible.push_back(static_cast<uint32_t>(i));
+        }
+    }
+}
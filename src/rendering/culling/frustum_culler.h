@@ -0,0 +1,32 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "data_structures.h"
+
+// CPU frustum culling of scene primitives.
+// Bounds are kept as structure-of-arrays so the per-plane loops run over contiguous floats
+// and vectorize; cull() can be called once per view per frame against the same bounds.
+class FrustumCuller {
+public:
+    // Copies the bounding volumes out of the primitive list; call again when the scene changes
+    void setPrimitives(std::span<const GLTFPrimitiveData> primitives);
+
+    // Writes the indices of primitives whose AABB intersects the frustum of viewProj, in ascending order
+    void cull(const glm::mat4& viewProj, std::vector<uint32_t>& visible) const;
+
+    size_t primitiveCount() const { return m_centerX.size(); }
+
+    // Inward-facing, normalized planes (xyz = normal, w = distance), left/right/bottom/top/near/far
+    static std::array<glm::vec4, 6> extractPlanes(const glm::mat4& viewProj);
+
+private:
+
+    std::vector<float> m_centerX, m_centerY, m_centerZ;
+    std::vector<float> m_extentX, m_extentY, m_extentZ;
+
+    // Scratch for cull(); 1 while the primitive is inside every plane tested so far
+    mutable std::vector<uint8_t> m_inside;
+};
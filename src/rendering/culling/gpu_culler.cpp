@@ -0,0 +1,112 @@
+#include "gpu_culler.h"
+
+#include <algorithm>
+
+#include "config.h"
+#include "frustum_culler.h"
+#include "image_transition_manager.h"
+#include "shared/shared_structs.h"
+
+void GpuCuller::initialize(Context* context, BufferManager* bufferManager, PipelineBuildQueue* pipelineBuilds,
+                           uint64_t primitiveBufferAddress, uint32_t primitiveCount) {
+    m_context = context;
+    m_bufferManager = bufferManager;
+    m_primitiveBufferAddress = primitiveBufferAddress;
+    m_primitiveCount = primitiveCount;
+
+    pipelineBuilds->enqueue([this]() {
+        m_pipeline = std::make_unique<ComputePipeline>(
+            m_context,
+            std::string(BUILD_RESOURCE_DIR) + "/shaders/cull_comp.spv",
+            VkPushConstantRange{
+                .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                .offset = 0,
+                .size = sizeof(CullPushConstants)
+            }
+        );
+    });
+}
+
+GpuCuller::DrawList GpuCuller::createDrawList() const {
+    DrawList drawList;
+    drawList.capacity = std::max(m_primitiveCount, 1u);
+
+    drawList.commandBuffer = m_bufferManager->createBuffer(
+        sizeof(VkDrawIndexedIndirectCommand) * drawList.capacity,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+        VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+        VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY
+    ).buffer;
+    drawList.countBuffer = m_bufferManager->createBuffer(
+        sizeof(uint32_t),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+        VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+        VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY
+    ).buffer;
+
+    drawList.commandAddress = m_bufferManager->deviceAddress(drawList.commandBuffer);
+    drawList.countAddress = m_bufferManager->deviceAddress(drawList.countBuffer);
+    return drawList;
+}
+
+void GpuCuller::cull(VkCommandBuffer cmd, std::span<const View> views) const {
+    if (views.empty()) {
+        return;
+    }
+
+    // The previous user of these buffers was an indirect draw, which only read them
+    ImageTransitionManager::BarrierBatch barriers;
+    for (const View& view : views) {
+        barriers.buffer(view.drawList->countBuffer,
+            VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_NONE,
+            VK_PIPELINE_STAGE_2_CLEAR_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT);
+        barriers.buffer(view.drawList->commandBuffer,
+            VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_NONE,
+            VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+    }
+    barriers.flush(cmd);
+
+    // The counts restart from zero
+    for (const View& view : views) {
+        vkCmdFillBuffer(cmd, view.drawList->countBuffer, 0, sizeof(uint32_t), 0);
+        barriers.buffer(view.drawList->countBuffer,
+            VK_PIPELINE_STAGE_2_CLEAR_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+    }
+    barriers.flush(cmd);
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline->handle());
+    for (const View& view : views) {
+        CullPushConstants pc{};
+        const auto planes = FrustumCuller::extractPlanes(view.viewProj);
+        std::copy(planes.begin(), planes.end(), pc.frustumPlanes);
+        pc.primitiveBufferAddress = m_primitiveBufferAddress;
+        pc.drawCommandAddress = view.drawList->commandAddress;
+        pc.drawCountAddress = view.drawList->countAddress;
+        pc.primitiveCount = m_primitiveCount;
+
+        vkCmdPushConstants(cmd, m_pipeline->layout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstants), &pc);
+        vkCmdDispatch(cmd, (m_primitiveCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+        barriers.buffer(view.drawList->countBuffer,
+            VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+            VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT);
+        barriers.buffer(view.drawList->commandBuffer,
+            VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+            VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT);
+    }
+    barriers.flush(cmd);
+}
+
+void GpuCuller::draw(VkCommandBuffer cmd, const DrawList& drawList) {
+    vkCmdDrawIndexedIndirectCount(
+        cmd,
+        drawList.commandBuffer, 0,
+        drawList.countBuffer, 0,
+        drawList.capacity,
+        sizeof(VkDrawIndexedIndirectCommand)
+    );
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <memory>
+#include <span>
+#include <vulkan/vulkan.h>
+
+#include "buffer_manager.h"
+#include "compute_pipeline.h"
+#include "context.h"
+#include "data_structures.h"
+#include "pipeline_build_queue.h"
+
+// GPU frustum culling: a compute pass tests every primitive's bounds and appends a
+// VkDrawIndexedIndirectCommand for each survivor, consumed by one vkCmdDrawIndexedIndirectCount.
+// firstInstance of every command is the primitive index, so vertex shaders find their
+// per-primitive data at gl_InstanceIndex.
+class GpuCuller {
+public:
+    // Indirect commands and the draw count for one view
+    struct DrawList {
+        VkBuffer commandBuffer = VK_NULL_HANDLE;
+        VkBuffer countBuffer = VK_NULL_HANDLE;
+        uint64_t commandAddress = 0;
+        uint64_t countAddress = 0;
+        uint32_t capacity = 0;
+    };
+
+    struct View {
+        glm::mat4 viewProj;
+        const DrawList* drawList;
+    };
+
+    // primitiveBufferAddress points at primitiveCount tightly packed GLTFPrimitiveData.
+    // The cull pipeline is built as a job on pipelineBuilds.
+    void initialize(Context* context, BufferManager* bufferManager, PipelineBuildQueue* pipelineBuilds,
+                    uint64_t primitiveBufferAddress, uint32_t primitiveCount);
+
+    // Buffers are owned by the BufferManager
+    DrawList createDrawList() const;
+
+    // Records the count resets and one cull dispatch per view. All views share three barrier batches:
+    // before the resets, between the resets and the dispatches, and the one that makes the commands
+    // visible to indirect draws.
+    void cull(VkCommandBuffer cmd, std::span<const View> views) const;
+
+    static void draw(VkCommandBuffer cmd, const DrawList& drawList);
+
+private:
+    static constexpr uint32_t WORKGROUP_SIZE = 64;
+
+    Context* m_context = nullptr;
+    BufferManager* m_bufferManager = nullptr;
+    std::unique_ptr<ComputePipeline> m_pipeline;
+
+    uint64_t m_primitiveBufferAddress = 0;
+    uint32_t m_primitiveCount = 0;
+};
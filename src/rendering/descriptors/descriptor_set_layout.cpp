@@ -6,8 +6,7 @@ DescriptorSetLayout::DescriptorSetLayout(VkDevice device, VkDescriptorSetLayout
     : m_device(device)
     , m_layout(layout)
 {
-    static int layoutIndex = 0;
-    DeletionQueue::get().pushFunction("DescriptorSetLayout_" + std::to_string(layoutIndex++), [device = m_device, layout = m_layout]() {
+    DeletionQueue::get().push([device = m_device, layout = m_layout]() {
         vkDestroyDescriptorSetLayout(device, layout, nullptr);
     });
 }
@@ -0,0 +1,537 @@
+#include "frame_graph.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "data_structures.h"
+#include "deletion_queue.h"
+
+namespace {
+    constexpr VkAccessFlags2 WRITE_ACCESS =
+        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT |
+        VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+        VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT |
+        VK_ACCESS_2_TRANSFER_WRITE_BIT;
+
+    uint32_t layerBits(uint32_t layerCount) {
+        return layerCount >= 32 ? FrameGraph::ALL_LAYERS : (1u << layerCount) - 1;
+    }
+}
+
+void FrameGraph::PassBuilder::read(ResourceId resource, Usage usage, uint32_t layerMask) {
+    m_graph.m_passes[m_passIndex].accesses.push_back({ resource, usage, layerMask, false, false });
+}
+
+void FrameGraph::PassBuilder::write(ResourceId resource, Usage usage, bool discard, uint32_t layerMask) {
+    m_graph.m_passes[m_passIndex].accesses.push_back({ resource, usage, layerMask, true, discard });
+}
+
+FrameGraph::FrameGraph(Context* context, VmaAllocator allocator)
+    : m_context(context), m_allocator(allocator) {
+}
+
+FrameGraph::ResourceId FrameGraph::createTransient(const std::string& name, VkFormat format,
+                                                   VkImageUsageFlags usage, VkImageAspectFlags aspect) {
+    Resource resource;
+    resource.name = name;
+    resource.transient = true;
+    resource.aspect = aspect;
+    resource.format = format;
+    resource.usage = usage;
+    m_resources.push_back(std::move(resource));
+    return static_cast<ResourceId>(m_resources.size() - 1);
+}
+
+FrameGraph::ResourceId FrameGraph::importImage(const std::string& name, VkImageAspectFlags aspect,
+                                               uint32_t layerCount, VkImageLayout initialLayout,
+                                               bool sizedToSwapchain) {
+    Resource resource;
+    resource.name = name;
+    resource.aspect = aspect;
+    resource.layerCount = layerCount;
+    resource.initialLayout = initialLayout;
+    resource.sizedToSwapchain = sizedToSwapchain;
+    m_resources.push_back(std::move(resource));
+    return static_cast<ResourceId>(m_resources.size() - 1);
+}
+
+void FrameGraph::addPass(const std::string& name, DeclareFn declare, ExecuteFn execute) {
+    m_passes.push_back({ name, std::move(declare), std::move(execute) });
+}
+
+void FrameGraph::exportImage(ResourceId resource, Usage usage) {
+    m_exports.push_back({ resource, usage });
+}
+
+FrameGraph::UsageInfo FrameGraph::usageInfo(Usage usage, VkImageAspectFlags aspect, bool discard) {
+    const VkImageLayout sampledLayout = (aspect & VK_IMAGE_ASPECT_DEPTH_BIT) != 0
+        ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
+        : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    switch (usage) {
+    case Usage::ColorAttachment:
+        // Loading the previous contents reads them
+        return { VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                 VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                 VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT | (discard ? VK_ACCESS_2_NONE : VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT) };
+    case Usage::DepthAttachment:
+        return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                 VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                 VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT };
+    case Usage::DepthReadOnly:
+        return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+                 VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                 VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT };
+    case Usage::SampledFragment:
+        return { sampledLayout, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT };
+    case Usage::SampledCompute:
+        return { sampledLayout, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT };
+    case Usage::StorageWriteCompute:
+        return { VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT };
+    case Usage::Present:
+        // Presentation and the readback copy are ordered by semaphores and their own barriers
+        return { VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, VK_ACCESS_2_NONE };
+    case Usage::TransferSrc:
+        return { VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, VK_ACCESS_2_NONE };
+    }
+    throw std::logic_error("Unknown frame graph usage!");
+}
+
+void FrameGraph::declarePasses() {
+    for (uint32_t i = 0; i < m_passes.size(); ++i) {
+        m_passes[i].accesses.clear();
+        PassBuilder builder(*this, i);
+        m_passes[i].declare(builder);
+    }
+}
+
+void FrameGraph::cullPasses() {
+    // Backwards: a pass is needed if it writes an imported image or a transient a later needed pass
+    // reads. Overwriting everything (discard) ends the need for older contents.
+    std::vector<bool> needed(m_resources.size(), false);
+    for (const Export& e : m_exports) {
+        needed[e.resource] = true;
+    }
+
+    for (auto pass = m_passes.rbegin(); pass != m_passes.rend(); ++pass) {
+        pass->culled = true;
+        for (const Access& access : pass->accesses) {
+            if (access.write && (!m_resources[access.resource].transient || needed[access.resource])) {
+                pass->culled = false;
+            }
+        }
+        if (pass->culled) {
+            continue;
+        }
+
+        for (const Access& access : pass->accesses) {
+            if (access.write && access.discard) {
+                needed[access.resource] = false;
+            }
+        }
+        for (const Access& access : pass->accesses) {
+            if (!access.write || !access.discard) {
+                needed[access.resource] = true;
+            }
+        }
+    }
+}
+
+void FrameGraph::checkLifetimes() const {
+    for (uint32_t i = 0; i < m_passes.size(); ++i) {
+        if (m_passes[i].culled) {
+            continue;
+        }
+        for (const Access& access : m_passes[i].accesses) {
+            const Resource& resource = m_resources[access.resource];
+            if (resource.transient && (i < resource.firstPass || i > resource.lastPass)) {
+                throw std::logic_error("Pass " + m_passes[i].name + " uses transient " + resource.name +
+                                       " outside the lifetime it was compiled with!");
+            }
+        }
+    }
+}
+
+void FrameGraph::compile(VkExtent2D extent) {
+    m_extent = extent;
+    destroyTransients();
+
+    for (Resource& resource : m_resources) {
+        if (!resource.sizedToSwapchain) {
+            continue;
+        }
+        for (VkImage image : resource.boundImages) {
+            m_states.erase(image);
+        }
+        resource.boundImages.clear();
+        resource.image = VK_NULL_HANDLE;
+    }
+
+    // Lifetimes cover every declaring pass, culled or not, so any frame's subset fits inside them
+    declarePasses();
+    const auto passCount = static_cast<uint32_t>(m_passes.size());
+    for (Resource& resource : m_resources) {
+        resource.firstPass = UINT32_MAX;
+        resource.lastPass = 0;
+    }
+    for (uint32_t i = 0; i < passCount; ++i) {
+        for (const Access& access : m_passes[i].accesses) {
+            Resource& resource = m_resources[access.resource];
+            resource.firstPass = std::min(resource.firstPass, i);
+            resource.lastPass = std::max(resource.lastPass, i);
+        }
+    }
+
+    VkDevice device = m_context->device();
+    for (Resource& resource : m_resources) {
+        if (!resource.transient) {
+            continue;
+        }
+        if (resource.firstPass == UINT32_MAX) {
+            // Declared by no pass: kept for the whole frame
+            resource.firstPass = 0;
+            resource.lastPass = passCount;
+        }
+
+        VkImageCreateInfo imageInfo{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            .imageType = VK_IMAGE_TYPE_2D,
+            .format = resource.format,
+            .extent = { extent.width, extent.height, 1 },
+            .mipLevels = 1,
+            .arrayLayers = 1,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .tiling = VK_IMAGE_TILING_OPTIMAL,
+            .usage = resource.usage,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+        };
+        ManagedTexture& texture = resource.texture;
+        if (vkCreateImage(device, &imageInfo, nullptr, &texture.image) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create transient image " + resource.name + "!");
+        }
+        vkGetImageMemoryRequirements(device, texture.image, &resource.requirements);
+
+        texture.width = extent.width;
+        texture.height = extent.height;
+        texture.format = resource.format;
+        texture.usage = resource.usage;
+        texture.memoryUsage = VMA_MEMORY_USAGE_GPU_ONLY;
+        texture.aspect = resource.aspect;
+        resource.image = texture.image;
+    }
+
+    placeTransients();
+}
+
+void FrameGraph::placeTransients() {
+    std::vector<Resource*> transients;
+    VkMemoryRequirements heap{ 0, 1, ~0u };
+    VkDeviceSize separateBytes = 0;
+    for (Resource& resource : m_resources) {
+        if (resource.transient) {
+            transients.push_back(&resource);
+            heap.alignment = std::max(heap.alignment, resource.requirements.alignment);
+            heap.memoryTypeBits &= resource.requirements.memoryTypeBits;
+            separateBytes += resource.requirements.size;
+        }
+    }
+    if (transients.empty()) {
+        m_stats.separateBytes = 0;
+        m_stats.allocatedBytes = 0;
+        return;
+    }
+    if (heap.memoryTypeBits == 0) {
+        throw std::runtime_error("Transient attachments have no memory type in common!");
+    }
+
+    // First fit, largest first: each image goes to the lowest offset that no already placed image
+    // with an overlapping lifetime occupies
+    std::ranges::sort(transients, [](const Resource* a, const Resource* b) {
+        return a->requirements.size > b->requirements.size;
+    });
+    std::vector<Resource*> placed;
+    for (Resource* resource : transients) {
+        std::vector<Resource*> conflicts;
+        for (Resource* other : placed) {
+            if (other->firstPass <= resource->lastPass && resource->firstPass <= other->lastPass) {
+                conflicts.push_back(other);
+            }
+        }
+        std::ranges::sort(conflicts, [](const Resource* a, const Resource* b) { return a->offset < b->offset; });
+
+        const VkDeviceSize alignment = resource->requirements.alignment;
+        VkDeviceSize offset = 0;
+        for (const Resource* other : conflicts) {
+            if (offset + resource->requirements.size <= other->offset) {
+                break;
+            }
+            const VkDeviceSize end = other->offset + other->requirements.size;
+            offset = std::max(offset, (end + alignment - 1) / alignment * alignment);
+        }
+        resource->offset = offset;
+        heap.size = std::max(heap.size, offset + resource->requirements.size);
+        placed.push_back(resource);
+    }
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    if (vmaAllocateMemory(m_allocator, &heap, &allocInfo, &m_transientMemory, nullptr) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate transient attachment memory!");
+    }
+
+    VkDevice device = m_context->device();
+    std::vector<VkImage> images;
+    std::vector<VkImageView> views;
+    for (Resource* resource : transients) {
+        ManagedTexture& texture = resource->texture;
+        if (vmaBindImageMemory2(m_allocator, m_transientMemory, resource->offset, texture.image, nullptr) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to bind transient image " + resource->name + "!");
+        }
+
+        VkImageViewCreateInfo viewInfo{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .image = texture.image,
+            .viewType = VK_IMAGE_VIEW_TYPE_2D,
+            .format = resource->format,
+            .subresourceRange = { resource->aspect, 0, 1, 0, 1 }
+        };
+        if (vkCreateImageView(device, &viewInfo, nullptr, &texture.view) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create transient image view " + resource->name + "!");
+        }
+
+        m_context->debugMessenger()->setObjectName(
+            reinterpret_cast<uint64_t>(texture.image), VK_OBJECT_TYPE_IMAGE, resource->name.c_str());
+        images.push_back(texture.image);
+        views.push_back(texture.view);
+    }
+
+    m_transientDeletion = DeletionQueue::get().pushGroup(
+        [device, allocator = m_allocator, memory = m_transientMemory, images, views]() {
+            for (VkImageView view : views) {
+                vkDestroyImageView(device, view, nullptr);
+            }
+            for (VkImage image : images) {
+                vkDestroyImage(device, image, nullptr);
+            }
+            vmaFreeMemory(allocator, memory);
+        });
+
+    // Without the graph every attachment would be a separate allocation per frame in flight
+    m_stats.separateBytes = separateBytes * MAX_FRAMES_IN_FLIGHT;
+    m_stats.allocatedBytes = heap.size;
+}
+
+void FrameGraph::destroyTransients() {
+    for (Resource& resource : m_resources) {
+        if (!resource.transient || resource.texture.image == VK_NULL_HANDLE) {
+            continue;
+        }
+        m_states.erase(resource.texture.image);
+        resource.texture = {};
+        resource.image = VK_NULL_HANDLE;
+    }
+    // Frames in flight may still render into them
+    DeletionQueue::get().retire(m_transientDeletion);
+    m_transientDeletion = DeletionQueue::INVALID_HANDLE;
+    m_transientMemory = VK_NULL_HANDLE;
+}
+
+void FrameGraph::bindImage(ResourceId resource, VkImage image) {
+    Resource& bound = m_resources[resource];
+    bound.image = image;
+    if (std::ranges::find(bound.boundImages, image) == bound.boundImages.end()) {
+        bound.boundImages.push_back(image);
+    }
+}
+
+void FrameGraph::bindAcquiredImage(ResourceId resource, VkImage image, VkPipelineStageFlags2 waitStage) {
+    bindImage(resource, image);
+    for (LayerState& state : stateOf(m_resources[resource])) {
+        state = LayerState{};
+        state.writeStages = waitStage;
+    }
+}
+
+std::vector<FrameGraph::LayerState>& FrameGraph::stateOf(const Resource& resource) {
+    auto [it, inserted] = m_states.try_emplace(resource.image);
+    if (inserted) {
+        it->second.resize(resource.layerCount);
+        for (LayerState& state : it->second) {
+            state.layout = resource.initialLayout;
+        }
+    }
+    return it->second;
+}
+
+FrameGraph::UsageInfo FrameGraph::followingReads(uint32_t passIndex, ResourceId resource, VkImageLayout layout) const {
+    UsageInfo following{ layout, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE };
+    for (uint32_t i = passIndex + 1; i < m_passes.size(); ++i) {
+        if (m_passes[i].culled) {
+            continue;
+        }
+        for (const Access& access : m_passes[i].accesses) {
+            if (access.resource != resource) {
+                continue;
+            }
+            const UsageInfo info = usageInfo(access.usage, m_resources[resource].aspect, access.discard);
+            if (access.write || info.layout != layout) {
+                return following;
+            }
+            following.stages |= info.stages;
+            following.access |= info.access;
+        }
+    }
+    return following;
+}
+
+void FrameGraph::transition(uint32_t passIndex, const Access& access, ImageTransitionManager::BarrierBatch& barriers) {
+    Resource& resource = m_resources[access.resource];
+    if (resource.image == VK_NULL_HANDLE) {
+        throw std::logic_error("Frame graph image " + resource.name + " is used without being bound!");
+    }
+
+    // Everything a barrier has to wait for before the layer may be overwritten
+    const auto overwriteScope = [](const LayerState& state) {
+        return state.readStages != VK_PIPELINE_STAGE_2_NONE
+            ? std::pair{ state.readStages, VkAccessFlags2{ VK_ACCESS_2_NONE } }
+            : std::pair{ state.writeStages, state.writeAccess };
+    };
+
+    // A transient's first use in a frame drops what the previous frame, or another transient sharing
+    // its memory, left there, but still has to wait for those accesses to finish
+    bool discard = access.discard;
+    VkPipelineStageFlags2 aliasStages = VK_PIPELINE_STAGE_2_NONE;
+    VkAccessFlags2 aliasAccess = VK_ACCESS_2_NONE;
+    if (resource.transient && !resource.usedThisFrame) {
+        discard = true;
+        for (const Resource& other : m_resources) {
+            if (!other.transient || &other == &resource ||
+                other.offset >= resource.offset + resource.requirements.size ||
+                resource.offset >= other.offset + other.requirements.size) {
+                continue;
+            }
+            auto it = m_states.find(other.image);
+            if (it == m_states.end()) {
+                continue;
+            }
+            for (const LayerState& state : it->second) {
+                const auto [stages, accessMask] = overwriteScope(state);
+                aliasStages |= stages;
+                aliasAccess |= accessMask;
+            }
+        }
+    }
+    resource.usedThisFrame = true;
+
+    UsageInfo target = usageInfo(access.usage, resource.aspect, discard);
+    if (!access.write) {
+        // Later reads in the same layout ride on this barrier instead of needing their own
+        const UsageInfo following = followingReads(passIndex, access.resource, target.layout);
+        target.stages |= following.stages;
+        target.access |= following.access;
+    }
+
+    std::vector<LayerState>& layers = stateOf(resource);
+    const uint32_t layerMask = access.layerMask & layerBits(resource.layerCount);
+    for (uint32_t layer = 0; layer < resource.layerCount; ++layer) {
+        if ((layerMask & (1u << layer)) == 0) {
+            continue;
+        }
+        LayerState& state = layers[layer];
+
+        VkImageMemoryBarrier2 barrier{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+            .dstStageMask = target.stages,
+            .dstAccessMask = target.access,
+            .oldLayout = discard ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout,
+            .newLayout = target.layout,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = resource.image,
+            .subresourceRange = { resource.aspect, 0, 1, layer, 1 }
+        };
+
+        if (access.write || discard || target.layout != state.layout) {
+            // Write after read or write, or a layout transition (which writes the image itself)
+            const auto [stages, accessMask] = overwriteScope(state);
+            barrier.srcStageMask = stages | aliasStages;
+            barrier.srcAccessMask = accessMask | aliasAccess;
+            const bool needed = target.layout != state.layout ||
+                barrier.srcStageMask != VK_PIPELINE_STAGE_2_NONE || barrier.srcAccessMask != VK_ACCESS_2_NONE;
+
+            state.layout = target.layout;
+            state.writeStages = target.stages;
+            if (access.write) {
+                state.writeAccess = target.access & WRITE_ACCESS;
+                state.readStages = VK_PIPELINE_STAGE_2_NONE;
+                state.visibleStages = VK_PIPELINE_STAGE_2_NONE;
+                state.visibleAccess = VK_ACCESS_2_NONE;
+            } else {
+                state.writeAccess = VK_ACCESS_2_NONE;
+                state.readStages = target.stages;
+                state.visibleStages = target.stages;
+                state.visibleAccess = target.access;
+            }
+            if (!needed) {
+                continue;
+            }
+        } else {
+            // Read in the same layout: only the last write has to be made visible, once per stage
+            state.readStages |= target.stages;
+            if ((target.stages & ~state.visibleStages) == 0 && (target.access & ~state.visibleAccess) == 0) {
+                continue;
+            }
+            barrier.srcStageMask = state.writeStages;
+            barrier.srcAccessMask = state.writeAccess;
+            state.visibleStages |= target.stages;
+            state.visibleAccess |= target.access;
+        }
+
+        // Neighbouring layers with the same transition are merged into one barrier by the batch
+        barriers.image(barrier);
+    }
+}
+
+void FrameGraph::flush(VkCommandBuffer cmd, ImageTransitionManager::BarrierBatch& barriers) {
+    if (barriers.empty()) {
+        return;
+    }
+    ++m_stats.barrierBatches;
+    m_stats.imageBarriers += barriers.imageBarrierCount();
+    barriers.flush(cmd);
+}
+
+void FrameGraph::execute(VkCommandBuffer cmd) {
+    declarePasses();
+    cullPasses();
+    checkLifetimes();
+
+    m_stats.passes = static_cast<uint32_t>(m_passes.size());
+    m_stats.culledPasses = 0;
+    m_stats.barrierBatches = 0;
+    m_stats.imageBarriers = 0;
+    for (Resource& resource : m_resources) {
+        resource.usedThisFrame = false;
+    }
+
+    ImageTransitionManager::BarrierBatch barriers;
+    for (uint32_t i = 0; i < m_passes.size(); ++i) {
+        Pass& pass = m_passes[i];
+        if (pass.culled) {
+            ++m_stats.culledPasses;
+            continue;
+        }
+        for (const Access& access : pass.accesses) {
+            transition(i, access, barriers);
+        }
+        flush(cmd, barriers);
+        pass.execute(cmd);
+    }
+
+    const auto end = static_cast<uint32_t>(m_passes.size());
+    for (const Export& e : m_exports) {
+        transition(end, { e.resource, e.usage, ALL_LAYERS, false, false }, barriers);
+    }
+    flush(cmd, barriers);
+}
@@ -0,0 +1,174 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "context.h"
+#include "deletion_queue.h"
+#include "image_transition_manager.h"
+#include "texture_manager.h"
+#include "vk_mem_alloc.h"
+#include "profiling/gpu_profiler.h"
+
+// Orders a target's passes by the images they touch. Every frame each pass's declare callback lists
+// its reads and writes; the graph culls passes whose writes nothing consumes, derives layouts and
+// exact stage/access masks from the tracked state of every image (per array layer), and records at
+// most one vkCmdPipelineBarrier2 in front of each pass.
+//
+// Transient attachments live for one frame and are owned by the graph. They share one VMA allocation:
+// attachments whose pass lifetimes do not overlap are placed at the same offsets, and since every
+// reuse is synchronized by the graph's own barriers, one copy serves all frames in flight.
+class FrameGraph {
+public:
+    using ResourceId = uint32_t;
+    static constexpr uint32_t ALL_LAYERS = UINT32_MAX;
+
+    // How a pass touches an image; each maps to one layout and one stage/access pair
+    enum class Usage {
+        ColorAttachment,
+        DepthAttachment,        // Depth test with writes
+        DepthReadOnly,          // Depth test without writes
+        SampledFragment,
+        SampledCompute,
+        StorageWriteCompute,
+        Present,                // Exports only: handed to the presentation engine
+        TransferSrc             // Exports only: copied by a later submission
+    };
+
+    class PassBuilder {
+    public:
+        // layerMask has one bit per array layer
+        void read(ResourceId resource, Usage usage, uint32_t layerMask = ALL_LAYERS);
+        // discard: the pass clears or overwrites everything it writes, so older contents are dropped
+        void write(ResourceId resource, Usage usage, bool discard, uint32_t layerMask = ALL_LAYERS);
+
+    private:
+        friend class FrameGraph;
+        PassBuilder(FrameGraph& graph, uint32_t passIndex) : m_graph(graph), m_passIndex(passIndex) {}
+
+        FrameGraph& m_graph;
+        uint32_t m_passIndex;
+    };
+
+    using DeclareFn = std::function<void(PassBuilder&)>;
+    using ExecuteFn = std::function<void(VkCommandBuffer)>;
+
+    FrameGraph(Context* context, VmaAllocator allocator);
+    FrameGraph(const FrameGraph&) = delete;
+    FrameGraph& operator=(const FrameGraph&) = delete;
+
+    // Setup. Transients are sized to the extent given to compile(); their textures are valid after it.
+    ResourceId createTransient(const std::string& name, VkFormat format, VkImageUsageFlags usage,
+                               VkImageAspectFlags aspect);
+    // External images keep their state across frames. sizedToSwapchain: the images are recreated on
+    // resize, so compile() forgets what it tracked for them
+    ResourceId importImage(const std::string& name, VkImageAspectFlags aspect, uint32_t layerCount,
+                           VkImageLayout initialLayout, bool sizedToSwapchain);
+    // Passes run in the order they are added
+    void addPass(const std::string& name, DeclareFn declare, ExecuteFn execute);
+    // Transition applied after the last pass, e.g. to the present layout
+    void exportImage(ResourceId resource, Usage usage);
+
+    // (Re)allocates the transients with the pass lifetimes of the current declarations.
+    // The previous ones are retired and freed once the frames in flight that use them complete.
+    void compile(VkExtent2D extent);
+
+    // Per frame
+    void bindImage(ResourceId resource, VkImage image);
+    // For acquired swapchain images: their contents are dropped, and the first barrier waits on
+    // waitStage, where the submission waits for the acquire semaphore
+    void bindAcquiredImage(ResourceId resource, VkImage image, VkPipelineStageFlags2 waitStage);
+    void execute(VkCommandBuffer cmd);
+
+    const ManagedTexture& texture(ResourceId transient) const { return m_resources[transient].texture; }
+    const GpuProfiler::FrameGraphStats& stats() const { return m_stats; }
+
+private:
+    struct Access {
+        ResourceId resource;
+        Usage usage;
+        uint32_t layerMask;
+        bool write;
+        bool discard;
+    };
+
+    struct Pass {
+        std::string name;
+        DeclareFn declare;
+        ExecuteFn execute;
+        std::vector<Access> accesses;   // Redeclared every frame
+        bool culled = false;
+    };
+
+    // Synchronization state of one array layer
+    struct LayerState {
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags2 writeStages = VK_PIPELINE_STAGE_2_NONE;   // Last write or layout transition
+        VkAccessFlags2 writeAccess = VK_ACCESS_2_NONE;                  // Writes not yet made available
+        VkPipelineStageFlags2 readStages = VK_PIPELINE_STAGE_2_NONE;    // Reads since then
+        VkPipelineStageFlags2 visibleStages = VK_PIPELINE_STAGE_2_NONE; // Where the last write is visible
+        VkAccessFlags2 visibleAccess = VK_ACCESS_2_NONE;
+    };
+
+    struct Resource {
+        std::string name;
+        bool transient = false;
+        VkImageAspectFlags aspect = 0;
+        uint32_t layerCount = 1;
+        VkImage image = VK_NULL_HANDLE;
+
+        // Imported
+        VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        bool sizedToSwapchain = false;
+        std::vector<VkImage> boundImages;
+
+        // Transient
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        VkImageUsageFlags usage = 0;
+        ManagedTexture texture;
+        VkMemoryRequirements requirements{};
+        VkDeviceSize offset = 0;
+        uint32_t firstPass = 0;         // Lifetime the memory was placed with
+        uint32_t lastPass = 0;
+        bool usedThisFrame = false;
+    };
+
+    struct UsageInfo {
+        VkImageLayout layout;
+        VkPipelineStageFlags2 stages;
+        VkAccessFlags2 access;
+    };
+
+    struct Export {
+        ResourceId resource;
+        Usage usage;
+    };
+
+    static UsageInfo usageInfo(Usage usage, VkImageAspectFlags aspect, bool discard);
+
+    void declarePasses();
+    void cullPasses();
+    void checkLifetimes() const;
+    void placeTransients();
+    void destroyTransients();
+
+    std::vector<LayerState>& stateOf(const Resource& resource);
+    UsageInfo followingReads(uint32_t passIndex, ResourceId resource, VkImageLayout layout) const;
+    void transition(uint32_t passIndex, const Access& access, ImageTransitionManager::BarrierBatch& barriers);
+    void flush(VkCommandBuffer cmd, ImageTransitionManager::BarrierBatch& barriers);
+
+    Context* m_context;
+    VmaAllocator m_allocator;
+    VkExtent2D m_extent{};
+
+    std::vector<Resource> m_resources;
+    std::vector<Pass> m_passes;
+    std::vector<Export> m_exports;
+    std::unordered_map<VkImage, std::vector<LayerState>> m_states;
+
+    VmaAllocation m_transientMemory = VK_NULL_HANDLE;
+    DeletionQueue::Handle m_transientDeletion = DeletionQueue::INVALID_HANDLE;
+    GpuProfiler::FrameGraphStats m_stats;
+};
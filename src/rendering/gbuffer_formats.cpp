@@ -0,0 +1,35 @@
+#include "gbuffer_formats.h"
+#include <stdexcept>
+
+GBufferFormats::GBufferFormats(VkPhysicalDevice physicalDevice, VkFormat preferredHdr, VkFormat preferredNormal)
+    : m_physicalDevice(physicalDevice) {
+    constexpr VkFormatFeatureFlags targetFeatures =
+        VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+
+    // R16G16B16A16_SFLOAT and R8G8_UNORM are required render targets, so the search always ends there
+    m_hdr = findSupportedFormat(
+        { preferredHdr, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT },
+        targetFeatures | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT
+    );
+    m_normal = findSupportedFormat(
+        { preferredNormal, VK_FORMAT_R16G16_UNORM, VK_FORMAT_R8G8_UNORM },
+        targetFeatures
+    );
+
+    VkFormatProperties props;
+    vkGetPhysicalDeviceFormatProperties(m_physicalDevice, m_hdr, &props);
+    m_hdrSupportsStorage = (props.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) != 0;
+}
+
+VkFormat GBufferFormats::findSupportedFormat(const std::vector<VkFormat>& candidates,
+    VkFormatFeatureFlags features) const {
+    for (VkFormat format : candidates) {
+        VkFormatProperties props;
+        vkGetPhysicalDeviceFormatProperties(m_physicalDevice, format, &props);
+        if ((props.optimalTilingFeatures & features) == features) {
+            return format;
+        }
+    }
+
+    throw std::runtime_error("Failed to find supported G-buffer format!");
+}
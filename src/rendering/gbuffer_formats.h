@@ -0,0 +1,27 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <vector>
+
+// Formats of the deferred targets, shared by the G-buffer and lighting passes and their pipelines.
+// The preferred HDR and normal formats fall back to wider candidates when the device cannot render
+// to and sample them.
+class GBufferFormats {
+public:
+    GBufferFormats(VkPhysicalDevice physicalDevice, VkFormat preferredHdr, VkFormat preferredNormal);
+
+    VkFormat albedo() const { return VK_FORMAT_R8G8B8A8_SRGB; }
+    VkFormat normal() const { return m_normal; }        // Octahedral-encoded world normal in two UNORM channels
+    VkFormat params() const { return VK_FORMAT_R8G8_UNORM; }  // Roughness, metallic
+    VkFormat hdr() const { return m_hdr; }
+
+    // The compute lighting path writes the HDR target as a storage image
+    bool hdrSupportsStorage() const { return m_hdrSupportsStorage; }
+
+private:
+    VkFormat findSupportedFormat(const std::vector<VkFormat>& candidates, VkFormatFeatureFlags features) const;
+
+    VkPhysicalDevice m_physicalDevice;
+    VkFormat m_hdr;
+    VkFormat m_normal;
+    bool m_hdrSupportsStorage = false;
+};
@@ -1,176 +1,139 @@
 ﻿#pragma once
 #include <vulkan/vulkan.h>
+#include <vector>
 
 class ImageTransitionManager {
 public:
-    static void transitionImageLayout(
-        VkCommandBuffer cmd,
-        VkImage image,
-        VkImageLayout oldLayout,
-        VkImageLayout newLayout,
-        uint32_t layerCount,
-        uint32_t mipLevels)
-    {
-        VkImageMemoryBarrier2 barrier{};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
-        barrier.oldLayout = oldLayout;
-        barrier.newLayout = newLayout;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.image = image;
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = mipLevels;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = layerCount;
-
-
-        VkDependencyInfo dependencyInfo{};
-        dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
-        dependencyInfo.imageMemoryBarrierCount = 1;
-        dependencyInfo.pImageMemoryBarriers = &barrier;
+    // Collects memory, buffer and image barriers and records them as one vkCmdPipelineBarrier2.
+    // Every barrier carries its own stage and access masks, so nothing waits on more than it needs.
+    class BarrierBatch {
+    public:
+        void memory(VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess,
+                    VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess) {
+            m_memoryBarriers.push_back(VkMemoryBarrier2{
+                .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+                .srcStageMask  = srcStage,
+                .srcAccessMask = srcAccess,
+                .dstStageMask  = dstStage,
+                .dstAccessMask = dstAccess
+            });
+        }
 
-        vkCmdPipelineBarrier2(cmd, &dependencyInfo);
-    }
+        void buffer(VkBuffer buffer,
+                    VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess,
+                    VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess,
+                    VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE) {
+            m_bufferBarriers.push_back(VkBufferMemoryBarrier2{
+                .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+                .srcStageMask        = srcStage,
+                .srcAccessMask       = srcAccess,
+                .dstStageMask        = dstStage,
+                .dstAccessMask       = dstAccess,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .buffer              = buffer,
+                .offset              = offset,
+                .size                = size
+            });
+        }
 
-    static void transitionColorAttachment(VkCommandBuffer cmd, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout) {
-        VkImageMemoryBarrier2 barrier{
-            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
-            .srcStageMask = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
-            .srcAccessMask = 0,
-            .dstStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-            .dstAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
-            .oldLayout = oldLayout,
-            .newLayout = newLayout,
-            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-            .image = image,
-            .subresourceRange = {
-                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                .baseMipLevel = 0,
-                .levelCount = 1,
-                .baseArrayLayer = 0,
-                .layerCount = 1
+        // A barrier that continues the previous one (same image, layouts and masks, adjacent layers)
+        // widens it instead of adding another
+        void image(const VkImageMemoryBarrier2& barrier) {
+            if (!m_imageBarriers.empty() && extends(m_imageBarriers.back(), barrier)) {
+                m_imageBarriers.back().subresourceRange.layerCount += barrier.subresourceRange.layerCount;
+                return;
             }
-        };
-
-        executeBarrier(cmd, barrier);
-    }
-
-    static void transitionToPresent(VkCommandBuffer cmd, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout) {
-        VkImageMemoryBarrier2 barrier{
-            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
-            .srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-            .srcAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
-            .dstStageMask = VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT,
-            .dstAccessMask = 0,
-            .oldLayout = oldLayout,
-            .newLayout = newLayout,
-            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-            .image = image,
-            .subresourceRange = {
-                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                .baseMipLevel = 0,
-                .levelCount = 1,
-                .baseArrayLayer = 0,
-                .layerCount = 1
-            }
-        };
+            m_imageBarriers.push_back(barrier);
+        }
 
-        executeBarrier(cmd, barrier);
-    }
+        void image(VkImage image, const VkImageSubresourceRange& range,
+                   VkImageLayout oldLayout, VkImageLayout newLayout,
+                   VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess,
+                   VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess) {
+            this->image(VkImageMemoryBarrier2{
+                .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+                .srcStageMask        = srcStage,
+                .srcAccessMask       = srcAccess,
+                .dstStageMask        = dstStage,
+                .dstAccessMask       = dstAccess,
+                .oldLayout           = oldLayout,
+                .newLayout           = newLayout,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image               = image,
+                .subresourceRange    = range
+            });
+        }
 
-    static void transitionDepthAttachment(
-        VkCommandBuffer cmd,
-        VkImage image,
-        VkImageLayout oldLayout,
-        VkImageLayout newLayout) {
+        bool empty() const {
+            return m_memoryBarriers.empty() && m_bufferBarriers.empty() && m_imageBarriers.empty();
+        }
 
-        VkImageMemoryBarrier barrier{};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.oldLayout = oldLayout;
-        barrier.newLayout = newLayout;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.image = image;
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-        barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = 1;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
+        uint32_t imageBarrierCount() const { return static_cast<uint32_t>(m_imageBarriers.size()); }
 
-        VkPipelineStageFlags sourceStage;
-        VkPipelineStageFlags destinationStage;
+        // Records nothing when empty. The batch is cleared for reuse.
+        void flush(VkCommandBuffer cmd) {
+            if (empty()) {
+                return;
+            }
 
-        // Set source access mask and stage based on old layout
-        if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
-            barrier.srcAccessMask = 0;
-            sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        } else if (oldLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
-            barrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-            sourceStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-        } else if (oldLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL) {
-            barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-            sourceStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-        } else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        } else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
-            barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-            sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        } else if (oldLayout == VK_IMAGE_LAYOUT_GENERAL) {
-            // When transitioning from GENERAL layout, consider possible uses
-            barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
-            sourceStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
-        } else {
-            throw std::runtime_error("Unsupported layout transition source!");
+            VkDependencyInfo dependencyInfo{
+                .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+                .memoryBarrierCount       = static_cast<uint32_t>(m_memoryBarriers.size()),
+                .pMemoryBarriers          = m_memoryBarriers.data(),
+                .bufferMemoryBarrierCount = static_cast<uint32_t>(m_bufferBarriers.size()),
+                .pBufferMemoryBarriers    = m_bufferBarriers.data(),
+                .imageMemoryBarrierCount  = static_cast<uint32_t>(m_imageBarriers.size()),
+                .pImageMemoryBarriers     = m_imageBarriers.data()
+            };
+            vkCmdPipelineBarrier2(cmd, &dependencyInfo);
+
+            m_memoryBarriers.clear();
+            m_bufferBarriers.clear();
+            m_imageBarriers.clear();
         }
 
-        // Set destination access mask and stage based on new layout
-        if (newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
-            barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-            destinationStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-        } else if (newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL) {
-            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-            destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-        } else if (newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-            barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        } else if (newLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
-            barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-            destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        } else if (newLayout == VK_IMAGE_LAYOUT_GENERAL) {
-            // GENERAL layout can be used for multiple purposes
-            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
-            destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
-        } else {
-            throw std::runtime_error("Unsupported layout transition destination!");
+    private:
+        static bool extends(const VkImageMemoryBarrier2& last, const VkImageMemoryBarrier2& next) {
+            const VkImageSubresourceRange& a = last.subresourceRange;
+            const VkImageSubresourceRange& b = next.subresourceRange;
+            return last.image == next.image &&
+                   last.oldLayout == next.oldLayout && last.newLayout == next.newLayout &&
+                   last.srcStageMask == next.srcStageMask && last.srcAccessMask == next.srcAccessMask &&
+                   last.dstStageMask == next.dstStageMask && last.dstAccessMask == next.dstAccessMask &&
+                   last.srcQueueFamilyIndex == next.srcQueueFamilyIndex &&
+                   last.dstQueueFamilyIndex == next.dstQueueFamilyIndex &&
+                   a.aspectMask == b.aspectMask &&
+                   a.baseMipLevel == b.baseMipLevel && a.levelCount == b.levelCount &&
+                   a.layerCount != VK_REMAINING_ARRAY_LAYERS &&
+                   a.baseArrayLayer + a.layerCount == b.baseArrayLayer;
         }
 
-        vkCmdPipelineBarrier(
-            cmd,
-            sourceStage, destinationStage,
-            0,
-            0, nullptr,
-            0, nullptr,
-            1, &barrier
-        );
-    }
-
+        std::vector<VkMemoryBarrier2> m_memoryBarriers;
+        std::vector<VkBufferMemoryBarrier2> m_bufferBarriers;
+        std::vector<VkImageMemoryBarrier2> m_imageBarriers;
+    };
 
-    static void transitionToShaderRead(
-        VkCommandBuffer cmd,
+    // Color barrier over a mip range, for a BarrierBatch
+    static VkImageMemoryBarrier2 mipRangeBarrier(
         VkImage image,
         VkImageLayout oldLayout,
-        VkImageLayout newLayout)
+        VkImageLayout newLayout,
+        VkPipelineStageFlags2 srcStageMask,
+        VkAccessFlags2 srcAccessMask,
+        VkPipelineStageFlags2 dstStageMask,
+        VkAccessFlags2 dstAccessMask,
+        uint32_t baseMipLevel,
+        uint32_t levelCount,
+        uint32_t layerCount = 1)
     {
-        VkImageMemoryBarrier2 barrier{
+        return VkImageMemoryBarrier2{
             .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
-            .srcStageMask        = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-            .srcAccessMask       = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
-            .dstStageMask        = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
-            .dstAccessMask       = VK_ACCESS_2_SHADER_READ_BIT,
+            .srcStageMask        = srcStageMask,
+            .srcAccessMask       = srcAccessMask,
+            .dstStageMask        = dstStageMask,
+            .dstAccessMask       = dstAccessMask,
             .oldLayout           = oldLayout,
             .newLayout           = newLayout,
             .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
@@ -178,23 +141,11 @@ public:
             .image               = image,
             .subresourceRange    = {
                 .aspectMask       = VK_IMAGE_ASPECT_COLOR_BIT,
-                .baseMipLevel     = 0,
-                .levelCount       = 1,
+                .baseMipLevel     = baseMipLevel,
+                .levelCount       = levelCount,
                 .baseArrayLayer   = 0,
-                .layerCount       = 1
+                .layerCount       = layerCount
             }
         };
-        executeBarrier(cmd, barrier);
-    }
-
-private:
-    static void executeBarrier(VkCommandBuffer cmd, const VkImageMemoryBarrier2& barrier) {
-        VkDependencyInfo dependencyInfo{
-            .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-            .imageMemoryBarrierCount = 1,
-            .pImageMemoryBarriers = &barrier
-        };
-
-        vkCmdPipelineBarrier2(cmd, &dependencyInfo);
     }
 };
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "light_clusterer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "config.h"
+#include "image_transition_manager.h"
+#include "camera/camera.h"
+#include "shared/shared_structs.h"
+
+void LightClusterer::initialize(Context* context, BufferManager* bufferManager, VmaAllocator allocator,
+                                PipelineBuildQueue* pipelineBuilds) {
+    m_context = context;
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+        m_lightBuffers[i] = UniformBuffer(
+            bufferManager,
+            allocator,
+            LIGHT_BUFFER_SIZE,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
+        );
+        m_lightBufferAddresses[i] = bufferManager->deviceAddress(m_lightBuffers[i].handle());
+
+        m_clusterBuffers[i] = bufferManager->createBuffer(
+            CLUSTER_BUFFER_SIZE,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY
+        ).buffer;
+        m_clusterBufferAddresses[i] = bufferManager->deviceAddress(m_clusterBuffers[i]);
+    }
+
+    pipelineBuilds->enqueue([this]() {
+        m_pipeline = std::make_unique<ComputePipeline>(
+            m_context,
+            std::string(BUILD_RESOURCE_DIR) + "/shaders/cluster_lights_comp.spv",
+            VkPushConstantRange{
+                .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                .offset = 0,
+                .size = sizeof(LightClusterPushConstants)
+            }
+        );
+    });
+}
+
+void LightClusterer::uploadLights(uint32_t frameIndex, std::span<const LightData> lights) {
+    const auto count = static_cast<uint32_t>(std::min<size_t>(lights.size(), MAX_LIGHTS));
+    m_lightBuffers[frameIndex].write(lights.data(), sizeof(LightData) * count);
+    m_lightCounts[frameIndex] = count;
+}
+
+void LightClusterer::build(VkCommandBuffer cmd, uint32_t frameIndex,
+                           const glm::mat4& view, const glm::mat4& proj, VkExtent2D extent) const {
+    // The previous reader of this frame's cluster lists was the lighting pass; a write-after-read
+    // only needs the execution dependency
+    ImageTransitionManager::BarrierBatch barriers;
+    barriers.buffer(m_clusterBuffers[frameIndex],
+        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_NONE,
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+    barriers.flush(cmd);
+
+    LightClusterPushConstants pc{};
+    pc.view = view;
+    pc.ndcToView = glm::vec2(1.0f / proj[0][0], 1.0f / proj[1][1]);
+    pc.screenSize = glm::vec2(static_cast<float>(extent.width), static_cast<float>(extent.height));
+    pc.tileSize = glm::vec2(
+        std::ceil(pc.screenSize.x / static_cast<float>(GRID_X)),
+        std::ceil(pc.screenSize.y / static_cast<float>(GRID_Y))
+    );
+    pc.zNear = Camera::NearPlane;
+    pc.zFar = Camera::FarPlane;
+    pc.lightBufferAddress = m_lightBufferAddresses[frameIndex];
+    pc.clusterBufferAddress = m_clusterBufferAddresses[frameIndex];
+    pc.lightCount = m_lightCounts[frameIndex];
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline->handle());
+    vkCmdPushConstants(cmd, m_pipeline->layout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(LightClusterPushConstants), &pc);
+    vkCmdDispatch(cmd, (CLUSTER_COUNT + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+    // Read by whichever lighting path runs this frame
+    barriers.buffer(m_clusterBuffers[frameIndex],
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+    barriers.flush(cmd);
+}
+
+VkDescriptorBufferInfo LightClusterer::lightBufferInfo(uint32_t frameIndex) const {
+    return { m_lightBuffers[frameIndex].handle(), 0, LIGHT_BUFFER_SIZE };
+}
+
+VkDescriptorBufferInfo LightClusterer::clusterBufferInfo(uint32_t frameIndex) const {
+    return { m_clusterBuffers[frameIndex], 0, CLUSTER_BUFFER_SIZE };
+}
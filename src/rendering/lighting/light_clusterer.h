@@ -0,0 +1,65 @@
+#pragma once
+#include <array>
+#include <memory>
+#include <span>
+#include <vulkan/vulkan.h>
+
+#include "buffer_manager.h"
+#include "compute_pipeline.h"
+#include "context.h"
+#include "data_structures.h"
+#include "pipeline_build_queue.h"
+#include "uniform_buffer.h"
+
+// Clustered light culling: the view frustum is split into a GRID_X x GRID_Y x GRID_Z froxel grid
+// (screen tiles x exponential depth slices) and a compute pass bins every light's bounding sphere
+// into the clusters it touches. The lighting pass then only loops over its pixel's cluster list.
+class LightClusterer {
+public:
+    static constexpr uint32_t GRID_X = 16;
+    static constexpr uint32_t GRID_Y = 9;
+    static constexpr uint32_t GRID_Z = 24;
+    static constexpr uint32_t CLUSTER_COUNT = GRID_X * GRID_Y * GRID_Z;
+    static constexpr uint32_t MAX_LIGHTS = 4096;
+    static constexpr uint32_t MAX_LIGHTS_PER_CLUSTER = 128;  // Further lights are dropped from the cluster
+
+    // Start of the cluster buffer, written by the compute pass for the lighting pass
+    struct Header {
+        glm::uvec3 gridSize;
+        uint32_t lightCount;
+        glm::vec2 tileSize;
+        float sliceScale;           // slice = log(viewDepth) * sliceScale + sliceBias
+        float sliceBias;
+    };
+
+    // The cluster pipeline is built as a job on pipelineBuilds
+    void initialize(Context* context, BufferManager* bufferManager, VmaAllocator allocator,
+                    PipelineBuildQueue* pipelineBuilds);
+
+    // Copies the lights into this frame's light buffer; anything past MAX_LIGHTS is dropped
+    void uploadLights(uint32_t frameIndex, std::span<const LightData> lights);
+
+    // Records the cluster build and the barrier that makes the lists visible to the lighting pass
+    void build(VkCommandBuffer cmd, uint32_t frameIndex,
+               const glm::mat4& view, const glm::mat4& proj, VkExtent2D extent) const;
+
+    VkDescriptorBufferInfo lightBufferInfo(uint32_t frameIndex) const;
+    VkDescriptorBufferInfo clusterBufferInfo(uint32_t frameIndex) const;
+
+private:
+    static constexpr uint32_t WORKGROUP_SIZE = 128;
+    static constexpr VkDeviceSize LIGHT_BUFFER_SIZE = sizeof(LightData) * MAX_LIGHTS;
+    static constexpr VkDeviceSize CLUSTER_BUFFER_SIZE =
+        sizeof(Header) + sizeof(uint32_t) * (1 + MAX_LIGHTS_PER_CLUSTER) * CLUSTER_COUNT;
+
+    Context* m_context = nullptr;
+    std::unique_ptr<ComputePipeline> m_pipeline;
+
+    // Host-visible so lights can change every frame without a staging copy
+    std::array<UniformBuffer, MAX_FRAMES_IN_FLIGHT> m_lightBuffers;
+    std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> m_lightBufferAddresses{};
+    std::array<uint32_t, MAX_FRAMES_IN_FLIGHT> m_lightCounts{};
+
+    std::array<VkBuffer, MAX_FRAMES_IN_FLIGHT> m_clusterBuffers{};
+    std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> m_clusterBufferAddresses{};
+};
@@ -0,0 +1,50 @@
+#include "stress_lights.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+std::vector<LightData> generateStressLights(uint32_t count,
+                                            const glm::vec3& boundsMin,
+                                            const glm::vec3& boundsMax,
+                                            uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    // Range scales with the scene so a few dozen lights overlap any point, whatever the model's units
+    const glm::vec3 extent = boundsMax - boundsMin;
+    const float baseRange = std::max(glm::length(extent) * 0.04f, 0.1f);
+
+    std::vector<LightData> lights;
+    lights.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        LightData light{};
+        light.position = boundsMin + extent * glm::vec3(unit(rng), unit(rng), unit(rng));
+        light.range = baseRange * (0.5f + unit(rng));
+
+        // Saturated random hue
+        const float hue = unit(rng) * 6.0f;
+        light.color = glm::clamp(glm::vec3(
+            std::abs(hue - 3.0f) - 1.0f,
+            2.0f - std::abs(hue - 2.0f),
+            2.0f - std::abs(hue - 4.0f)
+        ), 0.0f, 1.0f);
+        // Same brightness at the same fraction of the range as the scene's 100000 lm / 10 m light
+        light.intensity = 100000.0f * (light.range * light.range) / 100.0f;
+
+        // Every fourth light is a spot pointing mostly down
+        if (i % 4 == 3) {
+            light.type = LightType::Spot;
+            light.direction = glm::normalize(glm::vec3(unit(rng) - 0.5f, -1.0f, unit(rng) - 0.5f));
+            light.spotCosOuter = std::cos(glm::radians(35.0f));
+            light.spotCosInner = std::cos(glm::radians(25.0f));
+        } else {
+            light.type = LightType::Point;
+            light.direction = glm::vec3(0.0f, -1.0f, 0.0f);
+            light.spotCosOuter = -1.0f;
+            light.spotCosInner = -1.0f;
+        }
+        lights.push_back(light);
+    }
+    return lights;
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "data_structures.h"
+
+// Scatters count point and spot lights uniformly inside [boundsMin, boundsMax] for light culling
+// stress tests. The same seed always produces the same lights, so runs are comparable.
+std::vector<LightData> generateStressLights(uint32_t count,
+                                            const glm::vec3& boundsMin,
+                                            const glm::vec3& boundsMax,
+                                            uint32_t seed = 1337);
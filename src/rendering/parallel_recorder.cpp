@@ -0,0 +1,165 @@
+#include "parallel_recorder.h"
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <string>
+
+#include "deletion_queue.h"
+#include "shared/render_settings.h"
+
+ParallelRecorder::Batch::~Batch() {
+    for (auto& job : m_jobs) {
+        if (job.valid()) {
+            job.wait();
+        }
+    }
+}
+
+ParallelRecorder::ParallelRecorder(Context* context, ThreadPool* threadPool, uint32_t queueFamilyIndex)
+    : m_context(context), m_threadPool(threadPool) {
+    VkDevice device = m_context->device();
+    const uint32_t poolCount = m_threadPool->threadCount() + 1;
+
+    for (uint32_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; ++frame) {
+        m_pools[frame].resize(poolCount);
+        for (uint32_t i = 0; i < poolCount; ++i) {
+            // Transient: the whole pool is reset every time its frame slot comes around
+            VkCommandPoolCreateInfo poolInfo{
+                .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+                .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+                .queueFamilyIndex = queueFamilyIndex
+            };
+            if (vkCreateCommandPool(device, &poolInfo, nullptr, &m_pools[frame][i].pool) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create recording command pool!");
+            }
+
+            DeletionQueue::get().push([device, pool = m_pools[frame][i].pool]() {
+                    vkDestroyCommandPool(device, pool, nullptr);
+                });
+        }
+    }
+}
+
+void ParallelRecorder::beginFrame(uint32_t frameIndex) {
+    for (ThreadPools& pools : m_pools[frameIndex]) {
+        if (pools.used == 0) {
+            continue;
+        }
+        vkResetCommandPool(m_context->device(), pools.pool, 0);
+        pools.used = 0;
+    }
+}
+
+uint32_t ParallelRecorder::chunkCount(uint32_t drawCount) const {
+    const uint32_t threads = renderSettings.recordingThreads == 0
+        ? m_threadPool->threadCount() + 1
+        : std::min(renderSettings.recordingThreads, m_threadPool->threadCount() + 1);
+    const uint32_t chunksForDraws = (drawCount + MIN_DRAWS_PER_CHUNK - 1) / MIN_DRAWS_PER_CHUNK;
+    return std::max(1u, std::min(threads, chunksForDraws));
+}
+
+ParallelRecorder::Batch ParallelRecorder::record(uint32_t frameIndex, const RenderingFormats& formats,
+                                                 VkQueryPipelineStatisticFlags inheritedStatistics,
+                                                 uint32_t drawCount, RecordRange recordRange) {
+    Batch batch;
+    batch.m_recordRange = std::make_shared<const RecordRange>(std::move(recordRange));
+    batch.m_formats = formats;
+    batch.m_statistics = inheritedStatistics;
+    batch.m_frameIndex = frameIndex;
+
+    // Even split; the last chunk stays on this thread so it is not idle while the workers record
+    const uint32_t chunks = chunkCount(drawCount);
+    const uint32_t chunkSize = (drawCount + chunks - 1) / chunks;
+    for (uint32_t chunk = 0; chunk + 1 < chunks; ++chunk) {
+        const uint32_t begin = chunk * chunkSize;
+        const uint32_t end = std::min(begin + chunkSize, drawCount);
+        batch.m_jobs.push_back(m_threadPool->submit(
+            [this, frameIndex, formats, inheritedStatistics, begin, end, recordRange = batch.m_recordRange]() {
+                VkCommandBuffer cmd = beginSecondary(frameIndex, formats, inheritedStatistics);
+                (*recordRange)(cmd, begin, end);
+                if (vkEndCommandBuffer(cmd) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to end secondary command buffer!");
+                }
+                return cmd;
+            }));
+    }
+    batch.m_inlineBegin = std::min((chunks - 1) * chunkSize, drawCount);
+    batch.m_inlineEnd = drawCount;
+    return batch;
+}
+
+void ParallelRecorder::execute(VkCommandBuffer primary, Batch& batch) {
+    std::vector<VkCommandBuffer> commandBuffers;
+    commandBuffers.reserve(batch.m_jobs.size() + 1);
+
+    // Every job is joined before anything is rethrown, since the jobs reference the caller's state
+    std::exception_ptr failure;
+    try {
+        VkCommandBuffer cmd = beginSecondary(batch.m_frameIndex, batch.m_formats, batch.m_statistics);
+        (*batch.m_recordRange)(cmd, batch.m_inlineBegin, batch.m_inlineEnd);
+        if (vkEndCommandBuffer(cmd) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to end secondary command buffer!");
+        }
+        for (auto& job : batch.m_jobs) {
+            commandBuffers.push_back(job.get());
+        }
+        commandBuffers.push_back(cmd);
+    } catch (...) {
+        failure = std::current_exception();
+    }
+    for (auto& job : batch.m_jobs) {
+        if (job.valid()) {
+            job.wait();
+        }
+    }
+    batch.m_jobs.clear();
+
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+    vkCmdExecuteCommands(primary, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+}
+
+VkCommandBuffer ParallelRecorder::beginSecondary(uint32_t frameIndex, const RenderingFormats& formats,
+                                                 VkQueryPipelineStatisticFlags statistics) {
+    const uint32_t worker = ThreadPool::currentWorkerIndex();
+    ThreadPools& pools = m_pools[frameIndex][worker == ThreadPool::NOT_A_WORKER ? m_pools[frameIndex].size() - 1 : worker];
+
+    if (pools.used == pools.commandBuffers.size()) {
+        VkCommandBufferAllocateInfo allocInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = pools.pool,
+            .level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+            .commandBufferCount = 1
+        };
+        VkCommandBuffer allocated;
+        if (vkAllocateCommandBuffers(m_context->device(), &allocInfo, &allocated) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate secondary command buffer!");
+        }
+        pools.commandBuffers.push_back(allocated);
+    }
+    VkCommandBuffer cmd = pools.commandBuffers[pools.used++];
+
+    VkCommandBufferInheritanceRenderingInfo renderingInheritance{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+        .colorAttachmentCount = formats.colorCount,
+        .pColorAttachmentFormats = formats.color.data(),
+        .depthAttachmentFormat = formats.depth,
+        .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT
+    };
+    VkCommandBufferInheritanceInfo inheritance{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+        .pNext = &renderingInheritance,
+        .pipelineStatistics = statistics
+    };
+    VkCommandBufferBeginInfo beginInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+        .pInheritanceInfo = &inheritance
+    };
+    if (vkBeginCommandBuffer(cmd, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to begin secondary command buffer!");
+    }
+    return cmd;
+}
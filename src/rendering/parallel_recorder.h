@@ -0,0 +1,90 @@
+#pragma once
+#include <array>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "context.h"
+#include "data_structures.h"
+#include "thread_pool.h"
+
+// Records draw ranges into secondary command buffers on the worker pool. Every worker, plus the
+// thread that records the frame, owns one command pool per frame slot, so a pool is never touched
+// by two threads; beginFrame resets a slot's pools once its fence has signalled.
+class ParallelRecorder {
+public:
+    // Attachment formats of the dynamic rendering scope the secondaries are executed in
+    struct RenderingFormats {
+        std::array<VkFormat, 4> color{};
+        uint32_t colorCount = 0;
+        VkFormat depth = VK_FORMAT_UNDEFINED;
+    };
+
+    // Records draws [begin, end) into cmd, including every piece of state they need:
+    // secondaries inherit nothing from the primary but the attachments
+    using RecordRange = std::function<void(VkCommandBuffer cmd, uint32_t begin, uint32_t end)>;
+
+    // Chunks of one rendering scope in flight on the workers; the last chunk is recorded by execute
+    class Batch {
+    public:
+        Batch() = default;
+        Batch(Batch&&) = default;
+        Batch& operator=(Batch&&) = default;
+        ~Batch();  // Waits for unexecuted jobs, which reference the caller's state
+
+    private:
+        friend class ParallelRecorder;
+        std::vector<std::future<VkCommandBuffer>> m_jobs;
+        std::shared_ptr<const RecordRange> m_recordRange;
+        RenderingFormats m_formats;
+        VkQueryPipelineStatisticFlags m_statistics = 0;
+        uint32_t m_frameIndex = 0;
+        uint32_t m_inlineBegin = 0;
+        uint32_t m_inlineEnd = 0;
+    };
+
+    ParallelRecorder(Context* context, ThreadPool* threadPool, uint32_t queueFamilyIndex);
+    ParallelRecorder(const ParallelRecorder&) = delete;
+    ParallelRecorder& operator=(const ParallelRecorder&) = delete;
+
+    // After the frame slot's fence wait: its secondaries are no longer in use
+    void beginFrame(uint32_t frameIndex);
+
+    // Number of chunks drawCount draws are split into (renderSettings.recordingThreads caps it);
+    // 1 means recording inline into the primary is cheaper
+    uint32_t chunkCount(uint32_t drawCount) const;
+
+    // Starts recording chunkCount(drawCount) chunks. inheritedStatistics must name the pipeline
+    // statistics of any query active while the batch is executed
+    Batch record(uint32_t frameIndex, const RenderingFormats& formats, VkQueryPipelineStatisticFlags inheritedStatistics,
+                 uint32_t drawCount, RecordRange recordRange);
+
+    // Records the batch's last chunk on this thread, waits for the others and executes all of them in
+    // chunk order. The primary must be inside vkCmdBeginRendering with
+    // VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT
+    void execute(VkCommandBuffer primary, Batch& batch);
+
+    // Secondaries can only be executed inside an active query with inheritedQueries
+    bool canRecordInsideQueries() const { return m_context->supportsInheritedQueries(); }
+
+private:
+    static constexpr uint32_t MIN_DRAWS_PER_CHUNK = 64;
+
+    struct ThreadPools {
+        VkCommandPool pool = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> commandBuffers;
+        uint32_t used = 0;
+    };
+
+    // Begins a secondary from the calling thread's pool for frameIndex
+    VkCommandBuffer beginSecondary(uint32_t frameIndex, const RenderingFormats& formats,
+                                   VkQueryPipelineStatisticFlags statistics);
+
+    Context* m_context;
+    ThreadPool* m_threadPool;
+
+    // [frame slot][worker index], the recording thread's pools last
+    std::array<std::vector<ThreadPools>, MAX_FRAMES_IN_FLIGHT> m_pools;
+};
@@ -1,43 +1,58 @@
 #include "pipeline.h"
-#include <fstream>
 #include <stdexcept>
 
 #include "deletion_queue.h"
-
-static std::vector<char> readFile(const std::string& filename) {
-    std::ifstream file(filename, std::ios::ate | std::ios::binary);
-    if (!file.is_open()) {
-        throw std::runtime_error("failed to open file: " + filename);
-    }
-
-    size_t fileSize = (size_t)file.tellg();
-    std::vector<char> buffer(fileSize);
-    file.seekg(0);
-    file.read(buffer.data(), fileSize);
-    file.close();
-    return buffer;
-}
+#include "shader_module.h"
 
 Pipeline::Pipeline(
     Context* context,
     VkDescriptorSetLayout descriptorSetLayout,
     const PipelineConfig& config,
     VkPushConstantRange pushConstantRange
-) : m_context(context), m_pipelineLayout(nullptr) {
+) : m_context(context), m_pipeline(VK_NULL_HANDLE), m_pipelineLayout(nullptr), m_config(config) {
     createPipelineLayout(descriptorSetLayout, pushConstantRange);
 
-    auto vertCode = readFile(config.vertShaderPath);
+    // The config points into the caller's locals; keep owned copies so the pipeline can be rebuilt later
+    m_blendAttachments.assign(config.colorBlending.pAttachments,
+                              config.colorBlending.pAttachments + config.colorBlending.attachmentCount);
+    m_config.colorBlending.pAttachments = m_blendAttachments.data();
+    m_colorFormats.assign(config.rendering.pColorAttachmentFormats,
+                          config.rendering.pColorAttachmentFormats + config.rendering.colorAttachmentCount);
+    m_config.rendering.pColorAttachmentFormats = m_colorFormats.data();
+    m_dynamicStates.assign(config.dynamicState.pDynamicStates,
+                           config.dynamicState.pDynamicStates + config.dynamicState.dynamicStateCount);
+    m_config.dynamicState.pDynamicStates = m_dynamicStates.data();
+
+    m_pipeline = createPipeline();
+    registerDeletion();
+}
+
+void Pipeline::rebuild() {
+    VkPipeline rebuilt = createPipeline();
+    // Frames still in flight may use the old handle
+    DeletionQueue::get().retire(m_deletion);
+    m_pipeline = rebuilt;
+    registerDeletion();
+}
+
+bool Pipeline::usesShader(const std::string& spirvPath) const {
+    return m_config.vertShaderPath == spirvPath || m_config.fragShaderPath == spirvPath;
+}
+
+VkPipeline Pipeline::createPipeline() const {
+    const PipelineConfig& config = m_config;
+
+    auto vertCode = readShaderFile(config.vertShaderPath);
     std::vector<char> fragCode;
     bool hasFragmentShader = !config.fragShaderPath.empty();
     if (hasFragmentShader) {
-        fragCode = readFile(config.fragShaderPath); // optional because of depth pre-pass
+        fragCode = readShaderFile(config.fragShaderPath); // optional because of depth pre-pass
     }
 
     VkPipelineShaderStageCreateInfo shaderStages[2];
     uint32_t shaderStageCount = 1;
 
-    VkShaderModule vertShaderModule;
-    createShaderModule(vertCode, &vertShaderModule);
+    VkShaderModule vertShaderModule = createShaderModule(m_context->device(), vertCode);
 
     shaderStages[0] = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
@@ -48,7 +63,7 @@ Pipeline::Pipeline(
 
     VkShaderModule fragShaderModule;
     if (hasFragmentShader) {
-        createShaderModule(fragCode, &fragShaderModule);
+        fragShaderModule = createShaderModule(m_context->device(), fragCode);
         shaderStages[1] = {
             .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
             .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
@@ -80,40 +95,35 @@ Pipeline::Pipeline(
     pipelineInfo.layout = m_pipelineLayout;
     pipelineInfo.pNext = &renderingInfo;
 
-    if (vkCreateGraphicsPipelines(
-            m_context->device(),
-            VK_NULL_HANDLE,
-            1,
-            &pipelineInfo,
-            nullptr,
-            &m_pipeline
-        ) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create graphics pipeline");
-    }
-
-    VkDevice deviceCopy = m_context->device();
-    VkPipeline pipelineCopy = m_pipeline;
-
-    static int pipelineID = 0;
-    DeletionQueue::get().pushFunction("Pipeline" + std::to_string(pipelineID++), [deviceCopy, pipelineCopy]() {
-        vkDestroyPipeline(deviceCopy, pipelineCopy, nullptr);
-    });
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    const auto creationStart = std::chrono::steady_clock::now();
+    const VkResult result = vkCreateGraphicsPipelines(
+        m_context->device(),
+        m_context->pipelineCache(),
+        1,
+        &pipelineInfo,
+        nullptr,
+        &pipeline
+    );
+    m_context->addPipelineCreationTime(std::chrono::steady_clock::now() - creationStart);
 
     vkDestroyShaderModule(m_context->device(), vertShaderModule, nullptr);
     if (hasFragmentShader) {
         vkDestroyShaderModule(m_context->device(), fragShaderModule, nullptr);
     }
-}
-
-void Pipeline::createShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule) const {
-    VkShaderModuleCreateInfo createInfo{};
-    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize = code.size();
-    createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
 
-    if (vkCreateShaderModule(m_context->device(), &createInfo, nullptr, shaderModule) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create shader module");
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create graphics pipeline");
     }
+    return pipeline;
+}
+
+void Pipeline::registerDeletion() {
+    VkDevice deviceCopy = m_context->device();
+    VkPipeline pipelineCopy = m_pipeline;
+    m_deletion = DeletionQueue::get().push([deviceCopy, pipelineCopy]() {
+        vkDestroyPipeline(deviceCopy, pipelineCopy, nullptr);
+    });
 }
 
 void Pipeline::createPipelineLayout(VkDescriptorSetLayout descriptorSetLayout, VkPushConstantRange pushConstantRange) {
@@ -133,8 +143,7 @@ void Pipeline::createPipelineLayout(VkDescriptorSetLayout descriptorSetLayout, V
     VkDevice         deviceCopy = m_context->device();
     VkPipelineLayout layoutCopy = m_pipelineLayout;
 
-    static int pipelineLayoutID = 0;
-    DeletionQueue::get().pushFunction("PipelineLayout_" + std::to_string(pipelineLayoutID++), [deviceCopy, layoutCopy]() {
+    DeletionQueue::get().push([deviceCopy, layoutCopy]() {
         vkDestroyPipelineLayout(deviceCopy, layoutCopy, nullptr);
         });
 }
\ No newline at end of file
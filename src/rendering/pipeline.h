@@ -1,10 +1,15 @@
 #pragma once
+#include <string>
+#include <vector>
+
 #include "pipeline_config.h"
 #include "context.h"
+#include "deletion_queue.h"
+#include "reloadable_pipeline.h"
 #include "shared/shared_structs.h"
 
 
-class Pipeline {
+class Pipeline : public ReloadablePipeline {
 public:
     Pipeline(
         Context* context,
@@ -25,11 +30,22 @@ public:
     VkPipeline handle() const { return m_pipeline; }
     VkPipelineLayout layout() const { return m_pipelineLayout; }
 
+    void rebuild() override;
+    bool usesShader(const std::string& spirvPath) const override;
+
 private:
-    void createShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule) const;
+    VkPipeline createPipeline() const;
     void createPipelineLayout(VkDescriptorSetLayout descriptorSetLayout, VkPushConstantRange pushConstantRange);
+    void registerDeletion();
 
     Context* m_context;
     VkPipeline m_pipeline;
     VkPipelineLayout m_pipelineLayout;
+
+    // Copy of the creation config; its array pointers are redirected to the owned copies below
+    PipelineConfig m_config;
+    std::vector<VkPipelineColorBlendAttachmentState> m_blendAttachments;
+    std::vector<VkFormat> m_colorFormats;
+    std::vector<VkDynamicState> m_dynamicStates;
+    DeletionQueue::Handle m_deletion = DeletionQueue::INVALID_HANDLE;
 };
@@ -0,0 +1,39 @@
+#include "pipeline_build_queue.h"
+
+#include <exception>
+
+#include "thread_pool.h"
+
+PipelineBuildQueue::PipelineBuildQueue(ThreadPool* threadPool) : m_threadPool(threadPool) {}
+
+PipelineBuildQueue::~PipelineBuildQueue() {
+    // Jobs capture their pass by pointer, so none may outlive the queue's owner
+    for (auto& job : m_jobs) {
+        if (job.valid()) {
+            job.wait();
+        }
+    }
+}
+
+void PipelineBuildQueue::enqueue(std::function<void()> job) {
+    m_jobs.push_back(m_threadPool->submit(std::move(job)));
+}
+
+void PipelineBuildQueue::wait() {
+    // Join everything before rethrowing so no job is still running during unwinding
+    std::exception_ptr failure;
+    for (auto& job : m_jobs) {
+        try {
+            job.get();
+        } catch (...) {
+            if (!failure) {
+                failure = std::current_exception();
+            }
+        }
+    }
+    m_jobs.clear();
+
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
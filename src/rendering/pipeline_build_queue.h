@@ -0,0 +1,27 @@
+#pragma once
+#include <functional>
+#include <future>
+#include <vector>
+
+class ThreadPool;
+
+// Startup pipeline builds. Passes enqueue their pipeline creation (SPIR-V load, shader modules,
+// vkCreate*Pipelines) as independent jobs on the worker pool; the renderer joins them once every
+// target is initialized, before the first frame. Jobs may only write state owned by the pipeline
+// they build and must not create descriptor layouts, samplers or other shared objects.
+class PipelineBuildQueue {
+public:
+    explicit PipelineBuildQueue(ThreadPool* threadPool);
+    ~PipelineBuildQueue();
+    PipelineBuildQueue(const PipelineBuildQueue&) = delete;
+    PipelineBuildQueue& operator=(const PipelineBuildQueue&) = delete;
+
+    void enqueue(std::function<void()> job);
+
+    // Blocks until every enqueued job has finished, then rethrows the first failure
+    void wait();
+
+private:
+    ThreadPool* m_threadPool;
+    std::vector<std::future<void>> m_jobs;
+};
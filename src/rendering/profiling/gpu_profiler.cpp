@@ -0,0 +1,206 @@
+#include "gpu_profiler.h"
+#include "deletion_queue.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+GpuProfiler::GpuProfiler(Context* context)
+    : m_context(context) {
+    if (m_context->supportsPipelineStatistics()) {
+        VkQueryPoolCreateInfo statisticsPoolInfo{
+            .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+            .queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS,
+            .queryCount = MAX_FRAMES_IN_FLIGHT,
+            .pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT
+        };
+        if (vkCreateQueryPool(m_context->device(), &statisticsPoolInfo, nullptr, &m_statisticsPool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create GPU profiler statistics query pool!");
+        }
+        DeletionQueue::get().push([device = m_context->device(), pool = m_statisticsPool]() {
+                vkDestroyQueryPool(device, pool, nullptr);
+            });
+    }
+
+    const VkPhysicalDeviceLimits& limits = m_context->deviceProperties().limits;
+    if (!limits.timestampComputeAndGraphics) {
+        return; // Profiler stays disabled, every call is a no-op
+    }
+    m_timestampPeriodNs = limits.timestampPeriod;
+
+    VkQueryPoolCreateInfo queryPoolInfo{
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .queryType = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = QUERIES_PER_SLOT * MAX_FRAMES_IN_FLIGHT
+    };
+    if (vkCreateQueryPool(m_context->device(), &queryPoolInfo, nullptr, &m_queryPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create GPU profiler query pool!");
+    }
+
+    DeletionQueue::get().push([device = m_context->device(), pool = m_queryPool]() {
+            vkDestroyQueryPool(device, pool, nullptr);
+        });
+}
+
+std::optional<GpuProfiler::FrameResult> GpuProfiler::collect(uint32_t frameSlot) {
+    collectStatistics(frameSlot);
+
+    SlotState& slot = m_slots[frameSlot];
+    if (!enabled() || slot.frameNumber < 0 || slot.queryCount == 0) {
+        return std::nullopt;
+    }
+
+    std::array<uint64_t, QUERIES_PER_SLOT> timestamps{};
+    VkResult result = vkGetQueryPoolResults(
+        m_context->device(), m_queryPool,
+        frameSlot * QUERIES_PER_SLOT, slot.queryCount,
+        sizeof(uint64_t) * slot.queryCount, timestamps.data(), sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT);
+    if (result != VK_SUCCESS) {
+        return std::nullopt; // VK_NOT_READY: drop the sample rather than wait
+    }
+
+    auto toMs = [this, &timestamps](uint32_t begin, uint32_t end) {
+        return static_cast<double>(timestamps[end] - timestamps[begin]) * m_timestampPeriodNs / 1e6;
+    };
+
+    FrameResult frame;
+    frame.frameNumber = static_cast<uint64_t>(slot.frameNumber);
+    frame.frameMs = toMs(0, 1);
+    frame.scopeMs.assign(m_scopeStats.size(), 0.0);
+    for (const RecordedScope& scope : slot.scopes) {
+        frame.scopeMs[scope.scopeIndex] += toMs(scope.beginQuery, scope.endQuery);
+    }
+
+    // Scopes that were not recorded this frame keep their previous statistics
+    m_frameHistory.push(frame.frameMs);
+    m_frameHistory.summarize(m_frameStats);
+    for (const RecordedScope& scope : slot.scopes) {
+        m_scopeHistory[scope.scopeIndex].push(frame.scopeMs[scope.scopeIndex]);
+        m_scopeHistory[scope.scopeIndex].summarize(m_scopeStats[scope.scopeIndex]);
+    }
+
+    slot.frameNumber = -1;
+    return frame;
+}
+
+void GpuProfiler::beginFrame(VkCommandBuffer cmd, uint32_t frameSlot, uint64_t frameNumber) {
+    m_recordingSlot = frameSlot;
+    SlotState& slot = m_slots[frameSlot];
+    slot.statisticsRecorded = false;
+    if (statisticsEnabled()) {
+        vkCmdResetQueryPool(cmd, m_statisticsPool, frameSlot, 1);
+    }
+    if (!enabled()) {
+        return;
+    }
+    slot.frameNumber = static_cast<int64_t>(frameNumber);
+    slot.queryCount = 0;
+    slot.scopes.clear();
+    m_openScopes.clear();
+
+    vkCmdResetQueryPool(cmd, m_queryPool, frameSlot * QUERIES_PER_SLOT, QUERIES_PER_SLOT);
+    writeTimestamp(cmd, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT);
+    // Reserve query 1 for the end-of-frame timestamp
+    slot.queryCount = 2;
+}
+
+void GpuProfiler::endFrame(VkCommandBuffer cmd) {
+    if (!enabled()) {
+        return;
+    }
+    while (!m_openScopes.empty()) {
+        endScope(cmd);
+    }
+    vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, m_queryPool,
+                         m_recordingSlot * QUERIES_PER_SLOT + 1);
+}
+
+void GpuProfiler::beginScope(VkCommandBuffer cmd, const std::string& name) {
+    if (!enabled()) {
+        return;
+    }
+    SlotState& slot = m_slots[m_recordingSlot];
+    if (slot.scopes.size() >= MAX_SCOPES_PER_FRAME) {
+        throw std::runtime_error("GPU profiler scope limit exceeded!");
+    }
+    const uint32_t index = scopeIndex(name);
+    const uint32_t beginQuery = writeTimestamp(cmd, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT);
+    slot.scopes.push_back({ .scopeIndex = index, .beginQuery = beginQuery, .endQuery = beginQuery });
+    m_openScopes.push_back(slot.scopes.size() - 1);
+}
+
+void GpuProfiler::endScope(VkCommandBuffer cmd) {
+    if (!enabled() || m_openScopes.empty()) {
+        return;
+    }
+    SlotState& slot = m_slots[m_recordingSlot];
+    slot.scopes[m_openScopes.back()].endQuery = writeTimestamp(cmd, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT);
+    m_openScopes.pop_back();
+}
+
+void GpuProfiler::beginStatistics(VkCommandBuffer cmd) {
+    if (!statisticsEnabled()) {
+        return;
+    }
+    vkCmdBeginQuery(cmd, m_statisticsPool, m_recordingSlot, 0);
+}
+
+void GpuProfiler::endStatistics(VkCommandBuffer cmd) {
+    if (!statisticsEnabled()) {
+        return;
+    }
+    vkCmdEndQuery(cmd, m_statisticsPool, m_recordingSlot);
+    m_slots[m_recordingSlot].statisticsRecorded = true;
+}
+
+void GpuProfiler::collectStatistics(uint32_t frameSlot) {
+    SlotState& slot = m_slots[frameSlot];
+    if (!statisticsEnabled() || !slot.statisticsRecorded) {
+        return;
+    }
+
+    uint64_t invocations = 0;
+    if (vkGetQueryPoolResults(m_context->device(), m_statisticsPool, frameSlot, 1,
+                              sizeof(invocations), &invocations, sizeof(invocations),
+                              VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+        m_fragmentInvocations = invocations;
+    }
+    slot.statisticsRecorded = false;
+}
+
+uint32_t GpuProfiler::scopeIndex(const std::string& name) {
+    if (auto it = m_scopeLookup.find(name); it != m_scopeLookup.end()) {
+        return it->second;
+    }
+    const auto index = static_cast<uint32_t>(m_scopeStats.size());
+    m_scopeLookup.emplace(name, index);
+    m_scopeStats.push_back({ .name = name });
+    m_scopeHistory.emplace_back();
+    return index;
+}
+
+uint32_t GpuProfiler::writeTimestamp(VkCommandBuffer cmd, VkPipelineStageFlags2 stage) {
+    SlotState& slot = m_slots[m_recordingSlot];
+    const uint32_t query = slot.queryCount++;
+    vkCmdWriteTimestamp2(cmd, stage, m_queryPool, m_recordingSlot * QUERIES_PER_SLOT + query);
+    return query;
+}
+
+void GpuProfiler::History::push(double value) {
+    samples[head] = value;
+    head = (head + 1) % HISTORY_SIZE;
+    count = std::min(count + 1, HISTORY_SIZE);
+}
+
+void GpuProfiler::History::summarize(ScopeStats& stats) const {
+    stats.lastMs = samples[(head + HISTORY_SIZE - 1) % HISTORY_SIZE];
+    stats.minMs = stats.lastMs;
+    stats.maxMs = stats.lastMs;
+    double sum = 0.0;
+    for (uint32_t i = 0; i < count; ++i) {
+        sum += samples[i];
+        stats.minMs = std::min(stats.minMs, samples[i]);
+        stats.maxMs = std::max(stats.maxMs, samples[i]);
+    }
+    stats.avgMs = count > 0 ? sum / count : 0.0;
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <array>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "context.h"
+#include "data_structures.h"
+
+// Timestamp-query profiler with one query range per frame in flight.
+// Results of a frame slot are read back right after that slot's fence has been waited on,
+// i.e. MAX_FRAMES_IN_FLIGHT frames late, so reading never stalls the CPU.
+class GpuProfiler {
+public:
+    static constexpr uint32_t MAX_SCOPES_PER_FRAME = 32;
+    static constexpr uint32_t HISTORY_SIZE = 120;
+
+    struct ScopeStats {
+        std::string name;
+        double lastMs = 0.0;
+        double avgMs = 0.0;
+        double minMs = 0.0;
+        double maxMs = 0.0;
+    };
+
+    // GPU times of one retired frame; scopeMs is indexed like scopeStats()
+    struct FrameResult {
+        uint64_t frameNumber = 0;
+        double frameMs = 0.0;
+        std::vector<double> scopeMs;
+    };
+
+    explicit GpuProfiler(Context* context);
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    bool enabled() const { return m_queryPool != VK_NULL_HANDLE; }
+
+    // Host side: reads back the frame previously recorded into frameSlot (call after its fence)
+    std::optional<FrameResult> collect(uint32_t frameSlot);
+
+    // Recording: beginFrame/endFrame bracket the whole command buffer, scopes may nest
+    void beginFrame(VkCommandBuffer cmd, uint32_t frameSlot, uint64_t frameNumber);
+    void endFrame(VkCommandBuffer cmd);
+    void beginScope(VkCommandBuffer cmd, const std::string& name);
+    void endScope(VkCommandBuffer cmd);
+
+    const std::vector<ScopeStats>& scopeStats() const { return m_scopeStats; }
+    const ScopeStats& frameStats() const { return m_frameStats; }
+
+    // Pipeline statistics over one bracketed range per frame (outside of rendering), read back like timestamps
+    bool statisticsEnabled() const { return m_statisticsPool != VK_NULL_HANDLE; }
+    void beginStatistics(VkCommandBuffer cmd);
+    void endStatistics(VkCommandBuffer cmd);
+    uint64_t fragmentInvocations() const { return m_fragmentInvocations; }
+
+    // CPU-side counters of the frame graph's last recorded frame, shown next to the GPU timings
+    struct FrameGraphStats {
+        uint32_t passes = 0;
+        uint32_t culledPasses = 0;
+        uint32_t barrierBatches = 0;        // vkCmdPipelineBarrier2 calls
+        uint32_t imageBarriers = 0;
+        VkDeviceSize separateBytes = 0;     // Transient attachments as one allocation per attachment and frame in flight
+        VkDeviceSize allocatedBytes = 0;    // What the graph allocates for them
+    };
+    void setFrameGraphStats(const FrameGraphStats& stats) { m_frameGraphStats = stats; }
+    const FrameGraphStats& frameGraphStats() const { return m_frameGraphStats; }
+
+private:
+    static constexpr uint32_t QUERIES_PER_SLOT = 2 + MAX_SCOPES_PER_FRAME * 2;
+
+    struct RecordedScope {
+        uint32_t scopeIndex;
+        uint32_t beginQuery;
+        uint32_t endQuery;
+    };
+
+    struct SlotState {
+        int64_t frameNumber = -1;
+        uint32_t queryCount = 0;
+        std::vector<RecordedScope> scopes;
+        bool statisticsRecorded = false;
+    };
+
+    struct History {
+        std::array<double, HISTORY_SIZE> samples{};
+        uint32_t head = 0;
+        uint32_t count = 0;
+
+        void push(double value);
+        void summarize(ScopeStats& stats) const;
+    };
+
+    void collectStatistics(uint32_t frameSlot);
+
+    uint32_t scopeIndex(const std::string& name);
+    uint32_t writeTimestamp(VkCommandBuffer cmd, VkPipelineStageFlags2 stage);
+
+    Context* m_context;
+    VkQueryPool m_queryPool = VK_NULL_HANDLE;
+    double m_timestampPeriodNs = 0.0;
+    VkQueryPool m_statisticsPool = VK_NULL_HANDLE;
+    uint64_t m_fragmentInvocations = 0;
+
+    std::array<SlotState, MAX_FRAMES_IN_FLIGHT> m_slots;
+    uint32_t m_recordingSlot = 0;
+    std::vector<size_t> m_openScopes; // Indices into the recording slot's scopes
+
+    std::unordered_map<std::string, uint32_t> m_scopeLookup;
+    std::vector<ScopeStats> m_scopeStats;
+    std::vector<History> m_scopeHistory;
+    ScopeStats m_frameStats{ .name = "Frame" };
+    History m_frameHistory;
+    FrameGraphStats m_frameGraphStats;
+};
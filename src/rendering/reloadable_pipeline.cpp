@@ -0,0 +1,31 @@
+#include "reloadable_pipeline.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace {
+    // Pipelines are constructed on the startup build workers, so registration is locked
+    std::mutex registryMutex;
+    std::vector<ReloadablePipeline*> registry;
+}
+
+ReloadablePipeline::ReloadablePipeline() {
+    std::lock_guard lock(registryMutex);
+    registry.push_back(this);
+}
+
+ReloadablePipeline::~ReloadablePipeline() {
+    std::lock_guard lock(registryMutex);
+    registry.erase(std::remove(registry.begin(), registry.end(), this), registry.end());
+}
+
+void ReloadablePipeline::forEachUsingShader(const std::string& spirvPath,
+                                            const std::function<void(ReloadablePipeline&)>& fn) {
+    std::lock_guard lock(registryMutex);
+    for (ReloadablePipeline* pipeline : registry) {
+        if (pipeline->usesShader(spirvPath)) {
+            fn(*pipeline);
+        }
+    }
+}
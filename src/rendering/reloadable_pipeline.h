@@ -0,0 +1,25 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vulkan/vulkan.h>
+
+// Base of Pipeline and ComputePipeline. Every live pipeline is registered so the shader hot reloader
+// can find the ones built from a recompiled SPIR-V file and rebuild them in place.
+class ReloadablePipeline {
+public:
+    ReloadablePipeline(const ReloadablePipeline&) = delete;
+    ReloadablePipeline& operator=(const ReloadablePipeline&) = delete;
+
+    // Builds a new handle from the SPIR-V currently on disk and swaps it in. The replaced handle is
+    // retired through the DeletionQueue, so it lives until no frame in flight uses it. The layout is
+    // kept, so a shader may change its code but not its descriptor or push constant interface.
+    virtual void rebuild() = 0;
+    virtual bool usesShader(const std::string& spirvPath) const = 0;
+
+    // Runs fn on every live pipeline built from spirvPath
+    static void forEachUsingShader(const std::string& spirvPath, const std::function<void(ReloadablePipeline&)>& fn);
+
+protected:
+    ReloadablePipeline();
+    virtual ~ReloadablePipeline();
+};
@@ -0,0 +1,187 @@
+#include "shader_hot_reloader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <set>
+
+#include "reloadable_pipeline.h"
+
+namespace {
+    constexpr auto POLL_INTERVAL = std::chrono::milliseconds(250);
+
+    bool isShaderStage(const std::filesystem::path& path) {
+        const auto extension = path.extension();
+        return extension == ".vert" || extension == ".frag" || extension == ".comp";
+    }
+
+    std::string quoted(const std::string& value) {
+        return "\"" + value + "\"";
+    }
+
+    std::string readText(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+    }
+}
+
+ShaderHotReloader::ShaderHotReloader(Context* context, std::string sourceDirectory, std::string spirvDirectory,
+                                     std::string compiler)
+    : m_context(context),
+      m_sourceDirectory(std::move(sourceDirectory)),
+      m_spirvDirectory(std::move(spirvDirectory)),
+      m_compiler(std::move(compiler)) {
+    // The first scan only records timestamps, so startup does not recompile anything
+    scanForChanges();
+    m_watcher = std::thread(&ShaderHotReloader::watchLoop, this);
+    std::cout << "Watching " << m_sourceDirectory.string() << " for shader changes" << std::endl;
+}
+
+ShaderHotReloader::~ShaderHotReloader() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    m_watcher.join();
+}
+
+void ShaderHotReloader::applyPending() {
+    std::vector<std::string> pending;
+    {
+        std::lock_guard lock(m_mutex);
+        pending.swap(m_pendingSpirv);
+    }
+
+    if (pending.empty()) {
+        return;
+    }
+
+    // A pipeline using several recompiled stages is rebuilt once
+    std::vector<ReloadablePipeline*> affected;
+    for (const std::string& spirvPath : pending) {
+        ReloadablePipeline::forEachUsingShader(spirvPath, [&](ReloadablePipeline& pipeline) {
+            if (std::find(affected.begin(), affected.end(), &pipeline) == affected.end()) {
+                affected.push_back(&pipeline);
+            }
+        });
+    }
+
+    uint32_t rebuilt = 0;
+    for (ReloadablePipeline* pipeline : affected) {
+        try {
+            pipeline->rebuild();
+            ++rebuilt;
+        } catch (const std::runtime_error& e) {
+            // Keep rendering with the old pipeline until the shader is fixed
+            std::cerr << "Shader reload failed: " << e.what() << std::endl;
+        }
+    }
+    std::cout << "Shader reload: " << pending.size() << " stage(s) recompiled, "
+              << rebuilt << " pipeline(s) rebuilt" << std::endl;
+}
+
+void ShaderHotReloader::watchLoop() {
+    while (true) {
+        {
+            std::unique_lock lock(m_mutex);
+            if (m_wake.wait_for(lock, POLL_INTERVAL, [this]() { return m_stopping; })) {
+                return;
+            }
+        }
+
+        for (const auto& source : scanForChanges()) {
+            const std::string spirvPath = spirvPathFor(source);
+            if (!compile(source, spirvPath)) {
+                continue;
+            }
+            std::lock_guard lock(m_mutex);
+            if (std::find(m_pendingSpirv.begin(), m_pendingSpirv.end(), spirvPath) == m_pendingSpirv.end()) {
+                m_pendingSpirv.push_back(spirvPath);
+            }
+        }
+    }
+}
+
+std::vector<std::filesystem::path> ShaderHotReloader::scanForChanges() {
+    std::set<std::filesystem::path> changedStages;
+    std::vector<std::string> changedIncludes;
+    std::vector<std::filesystem::path> stages;
+
+    std::error_code error;
+    for (std::filesystem::directory_iterator it(m_sourceDirectory, error), end; !error && it != end; it.increment(error)) {
+        const std::filesystem::path& path = it->path();
+        const bool stage = isShaderStage(path);
+        if (!stage && path.extension() != ".glsl") {
+            continue;
+        }
+        if (stage) {
+            stages.push_back(path);
+        }
+
+        std::error_code timeError;
+        const auto writeTime = std::filesystem::last_write_time(path, timeError);
+        if (timeError) {
+            continue;
+        }
+        auto [entry, inserted] = m_timestamps.try_emplace(path.string(), writeTime);
+        if (inserted || entry->second == writeTime) {
+            continue;
+        }
+        entry->second = writeTime;
+
+        if (stage) {
+            changedStages.insert(path);
+        } else {
+            changedIncludes.push_back("\"" + path.filename().string() + "\"");
+        }
+    }
+
+    // Includes are resolved textually: any stage naming the changed file in quotes is recompiled
+    if (!changedIncludes.empty()) {
+        for (const auto& stage : stages) {
+            const std::string text = readText(stage);
+            for (const auto& include : changedIncludes) {
+                if (text.find(include) != std::string::npos) {
+                    changedStages.insert(stage);
+                    break;
+                }
+            }
+        }
+    }
+
+    return { changedStages.begin(), changedStages.end() };
+}
+
+bool ShaderHotReloader::compile(const std::filesystem::path& source, const std::string& spirvPath) const {
+    // Compile next to the target and rename over it, so a pipeline never reads a half-written file
+    const std::string temporaryPath = spirvPath + ".tmp";
+    std::string command = quoted(m_compiler) + " " + quoted(source.string()) + " -o " + quoted(temporaryPath) + " -g";
+#ifdef _WIN32
+    command = quoted(command);  // cmd.exe strips the outer pair of quotes
+#endif
+
+    // glslc reports its own diagnostics on stderr
+    if (std::system(command.c_str()) != 0) {
+        std::cerr << "Shader compile failed: " << source.filename().string() << std::endl;
+        std::error_code error;
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, spirvPath, error);
+    if (error) {
+        std::cerr << "Failed to replace " << spirvPath << ": " << error.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::string ShaderHotReloader::spirvPathFor(const std::filesystem::path& source) const {
+    // Same naming as the CMake shader rule: lighting.frag -> lighting_frag.spv
+    return m_spirvDirectory + "/" + source.stem().string() + "_" + source.extension().string().substr(1) + ".spv";
+}
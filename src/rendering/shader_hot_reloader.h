@@ -0,0 +1,49 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "context.h"
+
+// Development-time shader reloading. A background thread polls the GLSL sources for changes and
+// recompiles the affected stages with glslc into the SPIR-V directory the pipelines load from
+// (edits to a .glsl include recompile every stage that includes it). Between frames the renderer
+// calls applyPending, which rebuilds the pipelines using the new SPIR-V and swaps them in; the
+// replaced handles are retired through the DeletionQueue.
+class ShaderHotReloader {
+public:
+    ShaderHotReloader(Context* context, std::string sourceDirectory, std::string spirvDirectory, std::string compiler);
+    ~ShaderHotReloader();
+    ShaderHotReloader(const ShaderHotReloader&) = delete;
+    ShaderHotReloader& operator=(const ShaderHotReloader&) = delete;
+
+    // Main thread, after the frame slot's fence wait and before recording
+    void applyPending();
+
+private:
+    void watchLoop();
+    // Returns the stages (.vert/.frag/.comp) that need recompiling since the last scan
+    std::vector<std::filesystem::path> scanForChanges();
+    bool compile(const std::filesystem::path& source, const std::string& spirvPath) const;
+    std::string spirvPathFor(const std::filesystem::path& source) const;
+
+    Context* m_context;
+    std::filesystem::path m_sourceDirectory;
+    std::string m_spirvDirectory;          // Spelled like the paths the pipelines were created with
+    std::string m_compiler;
+
+    // Watcher thread only
+    std::unordered_map<std::string, std::filesystem::file_time_type> m_timestamps;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::vector<std::string> m_pendingSpirv;   // Recompiled SPIR-V paths not yet applied
+    bool m_stopping = false;
+    std::thread m_watcher;
+};
@@ -0,0 +1,9 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// SPIR-V loading shared by Pipeline and ComputePipeline. Both throw on failure.
+std::vector<char> readShaderFile(const std::string& path);
+// The caller destroys the module once the pipeline that uses it is created
+VkShaderModule createShaderModule(VkDevice device, const std::vector<char>& code);
@@ -10,6 +10,11 @@
 #include "render_pass_executor.h"
 
 class RenderPassExecutor;
+class GBufferFormats;
+class GpuProfiler;
+class ThreadPool;
+class PipelineBuildQueue;
+class ParallelRecorder;
 
 class RenderTarget {
 public:
@@ -25,8 +30,13 @@ public:
         VkImageView depthImageView;
         VkImage depthImage;
         VkFormat depthFormat;
+        const GBufferFormats* gBufferFormats;
         Camera* camera;
         std::vector<Frame>* frames;
+        GpuProfiler* profiler;
+        ThreadPool* threadPool;
+        PipelineBuildQueue* pipelineBuilds;  // Joined by the renderer before the first frame
+        ParallelRecorder* recorder;
     };
 
 
@@ -2,6 +2,7 @@
 #include <stdexcept>
 #include "command_manager.h"
 #include "deletion_queue.h"
+#include "image_transition_manager.h"
 
 BufferManager::BufferManager(VkDevice device, VmaAllocator allocator, CommandManager* commandManager)
     : m_device(device), m_allocator(allocator), m_commandManager(commandManager) {
@@ -24,8 +25,7 @@ ManagedBuffer BufferManager::createBuffer(VkDeviceSize size, VkBufferUsageFlags
     ManagedBuffer localBuf = managedBuffer;  
     VmaAllocator  alloc = m_allocator;       
 
-    static int bufferID = 0;
-    DeletionQueue::get().pushFunction("Buffer_" + std::to_string(bufferID++), [alloc, localBuf]() {
+    DeletionQueue::get().push([alloc, localBuf]() {
         vmaDestroyBuffer(alloc,
             localBuf.buffer,
             localBuf.allocation);
@@ -43,23 +43,23 @@ void BufferManager::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceS
     VkBufferCopy copyRegion{ .size = size };
     vkCmdCopyBuffer(cmd, srcBuffer, dstBuffer, 1, &copyRegion);
 
-    // 2. Critical barrier for SSBO/vertex access
-    VkBufferMemoryBarrier barrier{
-        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
-        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
-        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
-        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .buffer = dstBuffer,
-        .offset = 0,
-        .size = size
-    };
-    vkCmdPipelineBarrier(
-        cmd,
-        VK_PIPELINE_STAGE_TRANSFER_BIT,
-        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
-        0, 0, nullptr, 1, &barrier, 0, nullptr
-    );
+    // 2. Critical barrier for index and SSBO/vertex access; geometry and primitive data are pulled
+    // through buffer device addresses by vertex, fragment and compute shaders
+    ImageTransitionManager::BarrierBatch barriers;
+    barriers.buffer(dstBuffer,
+        VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT |
+        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        VK_ACCESS_2_INDEX_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+        0, size);
+    barriers.flush(cmd);
 
     m_commandManager->endSingleTimeCommands(cmd);
 }
+
+uint64_t BufferManager::deviceAddress(VkBuffer buffer) const {
+    VkBufferDeviceAddressInfo addressInfo{};
+    addressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+    addressInfo.buffer = buffer;
+    return vkGetBufferDeviceAddress(m_device, &addressInfo);
+}
@@ -22,6 +22,9 @@ public:
     ManagedBuffer createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VmaMemoryUsage memoryUsage);
    
     void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) const;
+
+    // The buffer needs VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
+    uint64_t deviceAddress(VkBuffer buffer) const;
     
     VmaAllocator allocator() const { return m_allocator; }
 private:
@@ -3,10 +3,10 @@
 IndexBuffer::IndexBuffer(BufferManager* bufferManager,
     const CommandManager* commandManager,
     VmaAllocator alloc,
-    const std::vector<uint32_t>& indices)
+    std::span<const uint32_t> indices)
     : Buffer(alloc)  // Pass allocator to the base class
 {
-    VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
+    VkDeviceSize bufferSize = indices.size_bytes();
 
     // Create staging buffer (CPU visible).
     ManagedBuffer staging = bufferManager->createBuffer(
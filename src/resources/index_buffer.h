@@ -3,16 +3,16 @@
 #include "buffer_manager.h"
 #include "command_manager.h"
 #include "vk_mem_alloc.h"
-#include <vector>
+#include <span>
 
 class IndexBuffer final : public Buffer {
 public:
     IndexBuffer() = default;
-    // Constructs the index buffer from a vector of indices.
+    // Constructs the index buffer from a contiguous range of indices (vector or mapped file).
     IndexBuffer(BufferManager* bufferManager,
         const CommandManager* commandManager,
         VmaAllocator allocator,
-        const std::vector<uint32_t>& indices);
+        std::span<const uint32_t> indices);
     ~IndexBuffer() override = default;
     IndexBuffer(IndexBuffer&& other) noexcept;
     IndexBuffer& operator=(IndexBuffer&& other) noexcept;
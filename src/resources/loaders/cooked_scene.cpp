@@ -0,0 +1,103 @@
+#include "cooked_scene.h"
+
+#include <iostream>
+
+bool CookedScene::open(const std::string& path) {
+    m_header = nullptr;
+    if (!m_file.open(path)) {
+        return false;
+    }
+
+    using namespace CookedSceneFormat;
+    if (m_file.size() < sizeof(Header)) {
+        std::cerr << "Cooked scene " << path << " is truncated, ignoring it" << std::endl;
+        m_file.close();
+        return false;
+    }
+
+    const auto* header = reinterpret_cast<const Header*>(m_file.data());
+    if (header->magic != MAGIC || header->version != VERSION ||
+        header->vertexStride != sizeof(Vertex) ||
+        header->primitiveStride != sizeof(GLTFPrimitive) ||
+        header->materialStride != sizeof(GLTFMaterial)) {
+        std::cerr << "Cooked scene " << path << " was written by another format version, ignoring it" << std::endl;
+        m_file.close();
+        return false;
+    }
+
+    bool valid = validSection(header->vertices, sizeof(Vertex)) &&
+                 validSection(header->indices, sizeof(uint32_t)) &&
+                 validSection(header->primitives, sizeof(GLTFPrimitive)) &&
+                 validSection(header->materials, sizeof(GLTFMaterial)) &&
+                 validSection(header->textures, sizeof(TextureRecord));
+    m_header = header;
+
+    if (valid) {
+        for (const auto& record : textures()) {
+            valid = valid && record.dataOffset % SECTION_ALIGNMENT == 0 &&
+                    record.dataOffset <= m_file.size() && record.dataSize <= m_file.size() - record.dataOffset &&
+                    record.dataSize == payloadSize(record);
+        }
+        // Primitives index straight into the other sections when the scene is loaded
+        const uint64_t vertexCount = header->vertices.count;
+        const uint64_t indexCount = header->indices.count;
+        const uint64_t materialCount = header->materials.count;
+        for (const auto& primitive : primitives()) {
+            valid = valid && uint64_t{ primitive.vertexOffset } + primitive.vertexCount <= vertexCount &&
+                    uint64_t{ primitive.indexOffset } + primitive.indexCount <= indexCount &&
+                    (primitive.materialIndex < materialCount || primitive.materialIndex == GLTFPrimitive::NO_MATERIAL);
+        }
+    }
+
+    if (!valid) {
+        std::cerr << "Cooked scene " << path << " is corrupt, ignoring it" << std::endl;
+        m_header = nullptr;
+        m_file.close();
+        return false;
+    }
+    return true;
+}
+
+bool CookedScene::validSection(const CookedSceneFormat::Section& section, uint64_t stride) const {
+    if (section.offset % CookedSceneFormat::SECTION_ALIGNMENT != 0 || section.offset > m_file.size()) {
+        return false;
+    }
+    return section.count <= (m_file.size() - section.offset) / stride;
+}
+
+glm::vec3 CookedScene::modelScale() const {
+    return { m_header->modelScale[0], m_header->modelScale[1], m_header->modelScale[2] };
+}
+
+std::span<const Vertex> CookedScene::vertices() const {
+    return section<Vertex>(m_header->vertices);
+}
+
+std::span<const uint32_t> CookedScene::indices() const {
+    return section<uint32_t>(m_header->indices);
+}
+
+std::span<const GLTFPrimitive> CookedScene::primitives() const {
+    return section<GLTFPrimitive>(m_header->primitives);
+}
+
+std::span<const GLTFMaterial> CookedScene::materials() const {
+    return section<GLTFMaterial>(m_header->materials);
+}
+
+std::span<const CookedSceneFormat::TextureRecord> CookedScene::textures() const {
+    return section<CookedSceneFormat::TextureRecord>(m_header->textures);
+}
+
+bool CookedScene::usesBlockCompression() const {
+    for (const auto& record : textures()) {
+        if (CookedSceneFormat::isBlockCompressed(record.format)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const unsigned char* CookedScene::textureData(const CookedSceneFormat::TextureRecord& record) const {
+    return m_file.data() + record.dataOffset;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <span>
+#include <string>
+
+#include "cooked_scene_format.h"
+#include "gltf_loader.h"
+#include "mapped_file.h"
+
+// A cooked .slmscene mapped into memory. Every accessor points straight into the mapping,
+// so the data stays valid only while this object is alive.
+class CookedScene {
+public:
+    // Returns false if the file is missing, truncated, was written by another format version, or
+    // has a primitive whose vertex, index or material range lies outside its section
+    bool open(const std::string& path);
+
+    glm::vec3 modelScale() const;
+    std::span<const Vertex> vertices() const;
+    std::span<const uint32_t> indices() const;
+    std::span<const GLTFPrimitive> primitives() const;
+    std::span<const GLTFMaterial> materials() const;
+    std::span<const CookedSceneFormat::TextureRecord> textures() const;
+    bool usesBlockCompression() const;
+    const unsigned char* textureData(const CookedSceneFormat::TextureRecord& record) const;
+
+private:
+    template<typename T>
+    std::span<const T> section(const CookedSceneFormat::Section& section) const {
+        return { reinterpret_cast<const T*>(m_file.data() + section.offset), static_cast<size_t>(section.count) };
+    }
+
+    bool validSection(const CookedSceneFormat::Section& section, uint64_t stride) const;
+
+    MappedFile m_file;
+    const CookedSceneFormat::Header* m_header = nullptr;
+};
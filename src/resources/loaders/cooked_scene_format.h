@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+
+// On-disk layout of a cooked .slmscene file, shared by the cooker and the runtime loader.
+// Offsets are absolute from the start of the file and every section starts on SECTION_ALIGNMENT,
+// so the runtime can use the sections in place from a memory mapping.
+namespace CookedSceneFormat {
+    constexpr uint32_t MAGIC = 0x534D4C53; // "SLMS"
+    constexpr uint32_t VERSION = 3;
+    constexpr uint64_t SECTION_ALIGNMENT = 16;
+
+    struct Section {
+        uint64_t offset;
+        uint64_t count;
+    };
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vertexStride;   // sizeof(Vertex) when cooked; a mismatch means the file is stale
+        uint32_t primitiveStride;
+        uint32_t materialStride;
+        uint32_t reserved;
+        float modelScale[3];
+        uint32_t reserved1;
+        Section vertices;        // Vertex
+        Section indices;         // uint32_t
+        Section primitives;      // GLTFPrimitive
+        Section materials;       // GLTFMaterial
+        Section textures;        // TextureRecord, indexed like GLTFModel::textures
+    };
+
+    struct TextureRecord {
+        uint32_t format;         // VkFormat; VK_FORMAT_UNDEFINED for textures no material uses
+        uint32_t width;
+        uint32_t height;
+        uint32_t mipLevels;
+        uint8_t swizzle[4];      // VkComponentSwizzle per view component (r, g, b, a)
+        uint32_t reserved;
+        uint64_t dataOffset;     // Mip 0 first, each level tightly packed
+        uint64_t dataSize;
+    };
+
+    inline uint64_t alignUp(uint64_t value) {
+        return (value + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+    }
+
+    inline bool isBlockCompressed(uint32_t format) {
+        return format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK;
+    }
+
+    // Bytes of one mip level; 0 for formats the container does not carry
+    inline uint64_t levelSize(uint32_t format, uint32_t width, uint32_t height) {
+        const uint64_t blocks = uint64_t((width + 3) / 4) * ((height + 3) / 4);
+        switch (format) {
+            case VK_FORMAT_R8G8B8A8_SRGB:
+            case VK_FORMAT_R8G8B8A8_UNORM:
+                return uint64_t(width) * height * 4;
+            case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+            case VK_FORMAT_BC4_UNORM_BLOCK:
+                return blocks * 8;
+            case VK_FORMAT_BC3_UNORM_BLOCK:
+            case VK_FORMAT_BC3_SRGB_BLOCK:
+            case VK_FORMAT_BC5_UNORM_BLOCK:
+                return blocks * 16;
+            default:
+                return 0;
+        }
+    }
+
+    // Bytes of the whole mip chain a record describes
+    inline uint64_t payloadSize(const TextureRecord& record) {
+        uint64_t size = 0;
+        for (uint32_t level = 0; level < record.mipLevels; ++level) {
+            const uint32_t width = record.width >> level;
+            const uint32_t height = record.height >> level;
+            size += levelSize(record.format, width ? width : 1, height ? height : 1);
+        }
+        return size;
+    }
+}
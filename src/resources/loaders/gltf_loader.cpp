@@ -3,13 +3,26 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #define TINYGLTF_IMPLEMENTATION
+// Images are decoded by the texture pipeline; tinygltf only records external URIs
+#define TINYGLTF_NO_EXTERNAL_IMAGE
 #define STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <algorithm>
 #include <iostream>
+#include <limits>
 #include <tiny_gltf.h>
 #include "shared/scene_data.h"
 
 namespace {
+    // Replaces tinygltf's stb decode: embedded images keep their encoded bytes
+    bool KeepEncodedImage(tinygltf::Image* image, const int, std::string*, std::string*,
+                          int, int, const unsigned char* bytes, int size, void*)
+    {
+        image->image.assign(bytes, bytes + size);
+        image->as_is = true;
+        return true;
+    }
+
     void ProcessPrimitive(
         const tinygltf::Model& model,
         const tinygltf::Primitive& primitive,
@@ -53,9 +66,13 @@ namespace {
 
         // Process vertices
         const size_t vertexCount = posAccessor.count;
+        primData.boundsMin = glm::vec3(std::numeric_limits<float>::max());
+        primData.boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
         for (size_t i = 0; i < vertexCount; ++i) {
             Vertex v{};
             v.pos = glm::make_vec3(&positions[3 * i]) *   globalScale ;
+            primData.boundsMin = glm::min(primData.boundsMin, v.pos);
+            primData.boundsMax = glm::max(primData.boundsMax, v.pos);
             v.texCoord = glm::make_vec2(&texCoords[2 * i]);
             v.normal   = glm::make_vec3(&normals[3*i]);
             if (hasTangents) {
@@ -104,6 +121,7 @@ namespace {
 bool GLTFLoader::LoadFromFile(const std::string& path, GLTFModel& outModel) {
     tinygltf::Model model;
     tinygltf::TinyGLTF loader;
+    loader.SetImageLoader(KeepEncodedImage, nullptr);
     std::string err, warn;
 
     bool success = path.find(".glb") != std::string::npos ?
@@ -160,10 +178,20 @@ bool GLTFLoader::LoadFromFile(const std::string& path, GLTFModel& outModel) {
 
     // Process textures
     for (const auto& tex : model.textures) {
-        const auto& image = model.images[tex.source];
         GLTFTexture texture;
-        texture.uri = image.uri;
-        outModel.textures.push_back(texture);
+        if (tex.source >= 0) {
+            auto& image = model.images[tex.source];
+            texture.uri = image.uri;
+            // Several textures may share one image; only the last one can take the bytes by move
+            const bool lastUse = std::none_of(&tex + 1, model.textures.data() + model.textures.size(),
+                [&tex](const tinygltf::Texture& other) { return other.source == tex.source; });
+            if (lastUse) {
+                texture.encodedData = std::move(image.image);
+            } else {
+                texture.encodedData = image.image;
+            }
+        }
+        outModel.textures.push_back(std::move(texture));
     }
     std::cout << "Total textures loaded: " << outModel.textures.size() << std::endl;
 
@@ -1,17 +1,23 @@
 ﻿// gltf_loader.h
 #pragma once
+#include <cstdint>
 #include <vector>
+#include <span>
 #include <glm/glm.hpp>
 #include <string>
 
 #include "data_structures.h"
 
 struct GLTFPrimitive {
+    static constexpr uint32_t NO_MATERIAL = UINT32_MAX; // glTF material -1
+
     uint32_t vertexOffset;
     uint32_t vertexCount;
     uint32_t indexOffset;
     uint32_t indexCount;
     uint32_t materialIndex;
+    glm::vec3 boundsMin;    // World-space AABB of the primitive's vertices
+    glm::vec3 boundsMax;
 };
 
 struct GLTFMaterial {
@@ -23,7 +29,17 @@ struct GLTFMaterial {
 };
 
 struct GLTFTexture {
-    std::string uri;
+    std::string uri;                        // External image, relative to the model; empty when embedded
+    std::vector<unsigned char> encodedData; // Embedded image bytes (data URI or buffer view), still compressed
+};
+
+// Non-owning view of scene geometry and materials, backed by a GLTFModel or a cooked scene mapping
+struct GLTFModelView {
+    std::span<const Vertex> vertices;
+    std::span<const uint32_t> indices;
+    std::span<const GLTFPrimitive> primitives;
+    std::span<const GLTFMaterial> materials;
+    size_t textureCount = 0;
 };
 
 struct GLTFModel {
@@ -32,6 +48,10 @@ struct GLTFModel {
     std::vector<GLTFPrimitive> primitives;
     std::vector<GLTFMaterial> materials;
     std::vector<GLTFTexture> textures;
+
+    GLTFModelView view() const {
+        return { vertices, indices, primitives, materials, textures.size() };
+    }
 };
 
 class GLTFLoader {
@@ -0,0 +1,89 @@
+#include "render_target_pool.h"
+
+#include <stdexcept>
+
+RenderTargetPool::RenderTargetPool(VkDevice device, VmaAllocator allocator, DebugMessenger* debugMessenger)
+    : m_device(device), m_allocator(allocator), m_debugMessenger(debugMessenger) {
+}
+
+const ManagedTexture& RenderTargetPool::request(const std::string& name, const Desc& desc) {
+    auto [it, inserted] = m_targets.try_emplace(name);
+    Target& target = it->second;
+    if (!inserted && target.desc == desc) {
+        return target.texture;
+    }
+
+    // Frames already recorded may still sample or render to the old image
+    DeletionQueue::get().retire(target.viewDeletion);
+    DeletionQueue::get().retire(target.imageDeletion);
+    target.desc = desc;
+    createTarget(name, target);
+    return target.texture;
+}
+
+void RenderTargetPool::createTarget(const std::string& name, Target& target) {
+    const Desc& desc = target.desc;
+
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.extent = { desc.width, desc.height, 1 };
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.format = desc.format;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageInfo.usage = desc.usage;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    ManagedTexture texture;
+    if (vmaCreateImage(m_allocator, &imageInfo, &allocInfo, &texture.image, &texture.allocation, nullptr) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create render target " + name + "!");
+    }
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = texture.image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = desc.format;
+    viewInfo.subresourceRange = { desc.aspect, 0, 1, 0, 1 };
+
+    if (vkCreateImageView(m_device, &viewInfo, nullptr, &texture.view) != VK_SUCCESS) {
+        vmaDestroyImage(m_allocator, texture.image, texture.allocation);
+        throw std::runtime_error("Failed to create render target view " + name + "!");
+    }
+
+    texture.width = desc.width;
+    texture.height = desc.height;
+    texture.format = desc.format;
+    texture.usage = desc.usage;
+    texture.memoryUsage = VMA_MEMORY_USAGE_GPU_ONLY;
+    texture.aspect = desc.aspect;
+
+    if (m_debugMessenger) {
+        m_debugMessenger->setObjectName(reinterpret_cast<uint64_t>(texture.image), VK_OBJECT_TYPE_IMAGE, name.c_str());
+        m_debugMessenger->setObjectName(reinterpret_cast<uint64_t>(texture.view), VK_OBJECT_TYPE_IMAGE_VIEW,
+                                        (name + "_View").c_str());
+    }
+
+    VkDevice device = m_device;
+    VmaAllocator allocator = m_allocator;
+    VkImage image = texture.image;
+    VmaAllocation allocation = texture.allocation;
+    VkImageView view = texture.view;
+    // Two entries keep each capture small enough to be stored inline; the view is registered
+    // last so a flush destroys it before the image
+    target.imageDeletion = DeletionQueue::get().push([allocator, image, allocation]() {
+        vmaDestroyImage(allocator, image, allocation);
+    });
+    target.viewDeletion = DeletionQueue::get().push([device, view]() {
+        vkDestroyImageView(device, view, nullptr);
+    });
+
+    target.texture = texture;
+    ++m_allocationCount;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vulkan/vulkan.h>
+
+#include "debug_messenger.h"
+#include "deletion_queue.h"
+#include "texture_registry.h"
+#include "vk_mem_alloc.h"
+
+// Resolution-dependent render targets, looked up by name. Requesting a target again with the same
+// description returns the existing allocation; a different one (a resize) retires the old image
+// through the DeletionQueue, so it is freed once the frames in flight that use it have completed.
+class RenderTargetPool {
+public:
+    struct Desc {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        VkImageUsageFlags usage = 0;
+        VkImageAspectFlags aspect = 0;
+
+        bool operator==(const Desc&) const = default;
+    };
+
+    RenderTargetPool(VkDevice device, VmaAllocator allocator, DebugMessenger* debugMessenger);
+    RenderTargetPool(const RenderTargetPool&) = delete;
+    RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+    // The reference stays valid until the same name is requested with another description
+    const ManagedTexture& request(const std::string& name, const Desc& desc);
+
+    size_t targetCount() const { return m_targets.size(); }
+    // Images created since startup; stays flat while requests are served from the pool
+    uint32_t allocationCount() const { return m_allocationCount; }
+
+private:
+    struct Target {
+        Desc desc;
+        ManagedTexture texture;
+        DeletionQueue::Handle imageDeletion = DeletionQueue::INVALID_HANDLE;
+        DeletionQueue::Handle viewDeletion = DeletionQueue::INVALID_HANDLE;
+    };
+
+    void createTarget(const std::string& name, Target& target);
+
+    VkDevice m_device;
+    VmaAllocator m_allocator;
+    DebugMessenger* m_debugMessenger;
+
+    std::unordered_map<std::string, Target> m_targets;  // Node-based, so references survive inserts
+    uint32_t m_allocationCount = 0;
+};
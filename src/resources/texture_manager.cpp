@@ -1,87 +1,181 @@
 #include "texture_manager.h"
 #include "buffer_manager.h"
 #include "command_manager.h"
+#include "upload_batcher.h"
+#include "image_transition_manager.h"
 
 
 #include "stb_image.h"
+#include <algorithm>
+#include <bit>
 #include <stdexcept>
 #include "deletion_queue.h"
 
-static int imageID = 0;
-// Define and initialize static member
-int TextureManager::samplerIndex = 0;
-
-TextureManager::TextureManager(VkDevice device, VmaAllocator allocator,
+TextureManager::TextureManager(VkPhysicalDevice physicalDevice, VkDevice device, VmaAllocator allocator,
                              CommandManager* commandManager, BufferManager* bufferManager, DebugMessenger* debugMessenger)
-    : m_device(device), m_allocator(allocator),
-      m_commandManager(commandManager), m_bufferManager(bufferManager), m_debugMessenger(debugMessenger)
+    : m_physicalDevice(physicalDevice), m_device(device), m_allocator(allocator),
+      m_commandManager(commandManager), m_bufferManager(bufferManager), m_debugMessenger(debugMessenger),
+      m_uploadBatcher(std::make_unique<UploadBatcher>(device, allocator, commandManager))
 {
 }
 
-ManagedTexture& TextureManager::loadTexture(
+TextureManager::~TextureManager() = default;
+
+void TextureManager::beginUploadBatch() {
+    m_uploadBatchDepth++;
+}
+
+void TextureManager::endUploadBatch() {
+    if (m_uploadBatchDepth == 0) {
+        throw std::logic_error("endUploadBatch called without a matching beginUploadBatch!");
+    }
+    if (--m_uploadBatchDepth == 0) {
+        m_uploadBatcher->flush();
+    }
+}
+
+uint32_t TextureManager::mipLevelsFor(uint32_t width, uint32_t height, VkFormat format) const {
+    // The chain is built with linear blits, which not every format supports (e.g. RGBA32F on some GPUs)
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(m_physicalDevice, format, &properties);
+    constexpr VkFormatFeatureFlags required =
+        VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    if ((properties.optimalTilingFeatures & required) != required) {
+        return 1;
+    }
+    return static_cast<uint32_t>(std::bit_width(std::max(width, height)));
+}
+
+void TextureManager::uploadImage(VkImage image, const void* data, VkDeviceSize size, uint32_t width, uint32_t height,
+                                 uint32_t mipLevels) {
+    m_uploadBatcher->enqueueImage(image, data, size, width, height, mipLevels);
+
+    // Outside a batch every upload is submitted on its own so the texture is ready on return
+    if (m_uploadBatchDepth == 0) {
+        m_uploadBatcher->flush();
+    }
+}
+
+TextureHandle TextureManager::loadTexture(
     const std::string& filepath,
     VkFormat           format
 ) {
+    return uploadTexture(decodeImage(filepath), format, filepath);
+}
+
+DecodedImage TextureManager::decodeImage(const std::string& filepath) {
     int texWidth, texHeight, texChannels;
     stbi_uc* pixels = stbi_load(
         filepath.c_str(), &texWidth, &texHeight, &texChannels,
         STBI_rgb_alpha
     );
     if (!pixels) {
-        throw std::runtime_error("Failed to load texture image!");
+        throw std::runtime_error("Failed to load texture image: " + filepath);
     }
 
-    VkDeviceSize imageSize = texWidth * texHeight * 4;
+    DecodedImage image;
+    image.width = static_cast<uint32_t>(texWidth);
+    image.height = static_cast<uint32_t>(texHeight);
+    image.pixels.assign(pixels, pixels + static_cast<size_t>(texWidth) * texHeight * 4);
+    stbi_image_free(pixels);
+    return image;
+}
 
-    // Staging buffer (unchanged)
-    ManagedBuffer staging = m_bufferManager->createBuffer(
-        imageSize,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VMA_MEMORY_USAGE_CPU_TO_GPU
+DecodedImage TextureManager::decodeImage(const unsigned char* encoded, size_t size, const std::string& debugName) {
+    int texWidth, texHeight, texChannels;
+    stbi_uc* pixels = stbi_load_from_memory(
+        encoded, static_cast<int>(size), &texWidth, &texHeight, &texChannels,
+        STBI_rgb_alpha
     );
-    void* data;
-    vmaMapMemory(m_allocator, staging.allocation, &data);
-    memcpy(data, pixels, static_cast<size_t>(imageSize));
-    vmaUnmapMemory(m_allocator, staging.allocation);
+    if (!pixels) {
+        throw std::runtime_error("Failed to decode embedded texture image: " + debugName);
+    }
+
+    DecodedImage image;
+    image.width = static_cast<uint32_t>(texWidth);
+    image.height = static_cast<uint32_t>(texHeight);
+    image.pixels.assign(pixels, pixels + static_cast<size_t>(texWidth) * texHeight * 4);
     stbi_image_free(pixels);
+    return image;
+}
+
+TextureHandle TextureManager::uploadTexture(const DecodedImage& image, VkFormat format, const std::string& debugName) {
+    VkDeviceSize imageSize = image.pixels.size();
 
     // Create the GPU image with the supplied format
     ManagedTexture texture;
-    createImage(
-        texWidth, texHeight,
+    texture.width = image.width;
+    texture.height = image.height;
+    texture.format = format;
+    texture.mipLevels = mipLevelsFor(image.width, image.height, format);
+    allocateImage(
+        image.width, image.height,
         format,
         VK_IMAGE_TILING_OPTIMAL,
-        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
         VMA_MEMORY_USAGE_GPU_ONLY,
-        texture.image, texture.allocation
+        texture.image, texture.allocation,
+        texture.mipLevels
     );
 
-    // Transition, copy, and transition again
-    transitionImageLayout(
-        texture.image, format,
-        VK_IMAGE_LAYOUT_UNDEFINED,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+    uploadImage(texture.image, image.pixels.data(), imageSize, image.width, image.height, texture.mipLevels);
+
+    // Create the view with the same format
+    texture.view = createImageView(
+        texture.image,
+        format,
+        VK_IMAGE_ASPECT_COLOR_BIT,
+        texture.mipLevels
     );
-    copyBufferToImage(staging.buffer, texture.image, texWidth, texHeight);
-    transitionImageLayout(
-        texture.image, format,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    texture.sampler = createSampler();
+    texture.hasSampler = true;
+
+    return registerTexture(texture, debugName);
+}
+
+TextureHandle TextureManager::uploadTextureLevels(VkFormat format, uint32_t width, uint32_t height,
+                                                  const void* data, VkDeviceSize size, std::span<const VkDeviceSize> levelOffsets,
+                                                  VkComponentMapping components, const std::string& debugName) {
+    ManagedTexture texture;
+    texture.width = width;
+    texture.height = height;
+    texture.format = format;
+    texture.mipLevels = static_cast<uint32_t>(levelOffsets.size());
+    allocateImage(
+        width, height,
+        format,
+        VK_IMAGE_TILING_OPTIMAL,
+        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        texture.image, texture.allocation,
+        texture.mipLevels
     );
 
-    // Create the view with the same format
+    std::vector<VkBufferImageCopy> regions(levelOffsets.size());
+    for (uint32_t level = 0; level < texture.mipLevels; ++level) {
+        regions[level].bufferOffset = levelOffsets[level];
+        regions[level].imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 };
+        regions[level].imageExtent = { std::max(width >> level, 1u), std::max(height >> level, 1u), 1 };
+    }
+    m_uploadBatcher->enqueueImageLevels(texture.image, data, size, texture.mipLevels, std::move(regions));
+    if (m_uploadBatchDepth == 0) {
+        m_uploadBatcher->flush();
+    }
+
     texture.view = createImageView(
         texture.image,
         format,
-        VK_IMAGE_ASPECT_COLOR_BIT
+        VK_IMAGE_ASPECT_COLOR_BIT,
+        texture.mipLevels,
+        components
     );
     texture.sampler = createSampler();
+    texture.hasSampler = true;
 
-    m_managedTextures.push_back(texture);
-    return m_managedTextures.back();
+    return registerTexture(texture, debugName);
 }
 
-ManagedTexture& TextureManager::loadHDRTexture(const std::string& path) {
+TextureHandle TextureManager::loadHDRTexture(const std::string& path) {
     int width, height, channels;
     float* pixels = stbi_loadf(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
     if (!pixels) {
@@ -90,77 +184,61 @@ ManagedTexture& TextureManager::loadHDRTexture(const std::string& path) {
 
     VkDeviceSize imageSize = width * height * 4 * sizeof(float);
 
-    ManagedBuffer staging = m_bufferManager->createBuffer(
-        imageSize,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VMA_MEMORY_USAGE_CPU_TO_GPU
-    );
-
-    void* data;
-    vmaMapMemory(m_allocator, staging.allocation, &data);
-    memcpy(data, pixels, static_cast<size_t>(imageSize));
-    vmaUnmapMemory(m_allocator, staging.allocation);
-    stbi_image_free(pixels);
-
     ManagedTexture texture;
     VkFormat format = VK_FORMAT_R32G32B32A32_SFLOAT;
-    createImage(
+    texture.width = width;
+    texture.height = height;
+    texture.format = format;
+    texture.mipLevels = mipLevelsFor(width, height, format);
+    allocateImage(
         width, height,
         format,
         VK_IMAGE_TILING_OPTIMAL,
-        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
         VMA_MEMORY_USAGE_GPU_ONLY,
-        texture.image, texture.allocation
+        texture.image, texture.allocation,
+        texture.mipLevels
     );
 
-    transitionImageLayout(
-        texture.image, format,
-        VK_IMAGE_LAYOUT_UNDEFINED,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
-    );
-    copyBufferToImage(staging.buffer, texture.image, width, height);
-    transitionImageLayout(
-        texture.image, format,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-    );
+    uploadImage(texture.image, pixels, imageSize, width, height, texture.mipLevels);
+    stbi_image_free(pixels);
 
     texture.view = createImageView(
         texture.image,
         format,
-        VK_IMAGE_ASPECT_COLOR_BIT
+        VK_IMAGE_ASPECT_COLOR_BIT,
+        texture.mipLevels
     );
     texture.sampler = createSampler();
+    texture.hasSampler = true;
 
-    m_managedTextures.push_back(texture);
-    return m_managedTextures.back();
+    return registerTexture(texture, path);
 }
 
-ManagedTexture& TextureManager::createTexture(uint32_t width, uint32_t height, VkFormat format,
-                                              VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkImageAspectFlags aspect, bool createSampler, const std::string& debugName)
+TextureHandle TextureManager::createTexture(uint32_t width, uint32_t height, VkFormat format,
+                                            VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkImageAspectFlags aspect, bool createSampler, const std::string& debugName)
 {
     ManagedTexture texture;
+    texture.width = width;
+    texture.height = height;
+    texture.format = format;
+    texture.usage = usage;
+    texture.memoryUsage = memoryUsage;
+    texture.aspect = aspect;
 
-    createImage(width, height, format, VK_IMAGE_TILING_OPTIMAL, usage, memoryUsage,
+    allocateImage(width, height, format, VK_IMAGE_TILING_OPTIMAL, usage, memoryUsage,
         texture.image, texture.allocation);
     texture.view = createImageView(texture.image, format, aspect);
 
     if (createSampler) {
         texture.sampler = TextureManager::createSampler();
+        texture.hasSampler = true;
     }
 
-    if (!debugName.empty())
-    {
-        m_debugMessenger->setObjectName(
-        reinterpret_cast<uint64_t>(texture.image),
-        VK_OBJECT_TYPE_IMAGE, debugName.c_str());
-    }
-
-    m_managedTextures.push_back(texture);
-    return m_managedTextures.back();
+    return registerTexture(texture, debugName);
 }
 
-ManagedTexture& TextureManager::createTexture(const unsigned char* data, uint32_t width, uint32_t height, uint32_t channels, const std::string&  debugName) {
+TextureHandle TextureManager::createTexture(const unsigned char* data, uint32_t width, uint32_t height, uint32_t channels, const std::string&  debugName) {
     // Determine format based on channels
     VkFormat format = VK_FORMAT_R8G8B8A8_SRGB; // Default to RGBA
     if (channels == 1) {
@@ -174,17 +252,6 @@ ManagedTexture& TextureManager::createTexture(const unsigned char* data, uint32_
     // Calculate image size
     VkDeviceSize imageSize = width * height * channels;
 
-    // Create staging buffer
-    ManagedBuffer staging = m_bufferManager->createBuffer(
-        imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU
-    );
-
-    // Copy data to staging buffer
-    void* mappedData;
-    vmaMapMemory(m_allocator, staging.allocation, &mappedData);
-    memcpy(mappedData, data, static_cast<size_t>(imageSize));
-    vmaUnmapMemory(m_allocator, staging.allocation);
-
     // Create image
     ManagedTexture texture;
     texture.width = width;
@@ -195,47 +262,30 @@ ManagedTexture& TextureManager::createTexture(const unsigned char* data, uint32_
     texture.aspect = VK_IMAGE_ASPECT_COLOR_BIT;
     texture.hasSampler = true;
 
-    createImage(width, height, format, VK_IMAGE_TILING_OPTIMAL,
+    allocateImage(width, height, format, VK_IMAGE_TILING_OPTIMAL,
         VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
         VMA_MEMORY_USAGE_GPU_ONLY, texture.image, texture.allocation);
 
-    // Transition image layout for copy operation
-    transitionImageLayout(texture.image, format,
-        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-    // Copy buffer data to image
-    copyBufferToImage(staging.buffer, texture.image, width, height);
-
-    // Transition image layout for shader access
-    transitionImageLayout(texture.image, format,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    uploadImage(texture.image, data, imageSize, width, height);
 
     // Create image view and sampler
     texture.view = createImageView(texture.image, format, VK_IMAGE_ASPECT_COLOR_BIT);
     texture.sampler = createSampler();
 
-    if (!debugName.empty())
-    {
-        m_debugMessenger->setObjectName(
-        reinterpret_cast<uint64_t>(texture.image),
-        VK_OBJECT_TYPE_IMAGE, debugName.c_str());
-    }
-
-    // Add to managed textures
-    m_managedTextures.push_back(texture);
-    return m_managedTextures.back();
+    return registerTexture(texture, debugName);
 }
 
-ManagedTexture& TextureManager::createCubeTexture(uint32_t size, VkFormat format,
+TextureHandle TextureManager::createCubeTexture(uint32_t size, VkFormat format,
                                                 VkImageUsageFlags usage, VmaMemoryUsage memoryUsage)
 {
     ManagedTexture texture;
-    createImage(
+    allocateImage(
         size, size, format,
         VK_IMAGE_TILING_OPTIMAL,
         usage,
         memoryUsage,
         texture.image, texture.allocation,
+        1,
         6,  // layers for cube map
         VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT  // cube map flag
     );
@@ -251,49 +301,50 @@ ManagedTexture& TextureManager::createCubeTexture(uint32_t size, VkFormat format
     // Don't create view here - we'll create face views separately
     texture.view = VK_NULL_HANDLE;
 
-    m_debugMessenger->setObjectName(
-    reinterpret_cast<uint64_t>(texture.image),
-    VK_OBJECT_TYPE_IMAGE,
-    "CubeMap_Image"
-);
+    return registerTexture(texture, "CubeMap_Image");
+}
+
+TextureHandle TextureManager::registerTexture(const ManagedTexture& texture, const std::string& debugName) {
+    if (!debugName.empty()) {
+        m_debugMessenger->setObjectName(
+            reinterpret_cast<uint64_t>(texture.image),
+            VK_OBJECT_TYPE_IMAGE, debugName.c_str());
+    }
 
-    m_managedTextures.push_back(texture);
-    return m_managedTextures.back();
+    // Split so both captures fit the DeletionQueue's inline storage; release() retires both.
+    // The views entry is registered last so a flush destroys it before the image.
+    TextureRegistry::Deletion deletion;
+    deletion.image = DeletionQueue::get().push(
+        [allocator = m_allocator, image = texture.image, allocation = texture.allocation]() {
+            vmaDestroyImage(allocator, image, allocation);
+        });
+    if (texture.view != VK_NULL_HANDLE || texture.sampler != VK_NULL_HANDLE) {
+        deletion.views = DeletionQueue::get().push(
+            [device = m_device, view = texture.view, sampler = texture.sampler]() {
+                if (sampler != VK_NULL_HANDLE) {
+                    vkDestroySampler(device, sampler, nullptr);
+                }
+                if (view != VK_NULL_HANDLE) {
+                    vkDestroyImageView(device, view, nullptr);
+                }
+            });
+    }
+    return m_textures.insert(texture, deletion, debugName);
 }
 
 void TextureManager::createImage(uint32_t width, uint32_t height, VkFormat format,
                                  VkImageTiling tiling, VkImageUsageFlags usage,
                                  VmaMemoryUsage memoryUsage, VkImage& image, VmaAllocation& allocation,
-                                 uint32_t layers, VkImageCreateFlags flags) const  // Add layers and flags
+                                 uint32_t layers, VkImageCreateFlags flags) const
 {
-    VkImageCreateInfo imageInfo{};
-    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-    imageInfo.flags = flags;  // Add flags
-    imageInfo.imageType = VK_IMAGE_TYPE_2D;
-    imageInfo.extent = { width, height, 1 };
-    imageInfo.mipLevels = 1;
-    imageInfo.arrayLayers = layers;  // Use layers
-    imageInfo.format = format;
-    imageInfo.tiling = tiling;
-    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    imageInfo.usage = usage;
-    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-    VmaAllocationCreateInfo allocInfo{};
-    allocInfo.usage = memoryUsage;
-
-    if (vmaCreateImage(m_allocator, &imageInfo, &allocInfo, &image, &allocation, nullptr) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to create Vulkan image!");
-    }
+    allocateImage(width, height, format, tiling, usage, memoryUsage, image, allocation, 1, layers, flags);
 
     VmaAllocator allocCopy = m_allocator;
     VkImage       imageCopy = image;
     VmaAllocation allocHandle = allocation;
 
 
-    DeletionQueue::get().pushFunction("Image_" + std::to_string(imageID++),
-        [allocCopy, imageCopy, allocHandle]() {
+    DeletionQueue::get().push([allocCopy, imageCopy, allocHandle]() {
             vmaDestroyImage(allocCopy, imageCopy, allocHandle);
         });
 }
@@ -301,48 +352,25 @@ void TextureManager::createImage(uint32_t width, uint32_t height, VkFormat forma
 void TextureManager::transitionSwapChainLayout(VkCommandBuffer cmd, VkImage image, VkImageLayout oldLayout,
                                                VkImageLayout newLayout, VkPipelineStageFlags2 srcStageMask, VkPipelineStageFlags2 dstStageMask,
                                                VkAccessFlags2 srcAccessMask, VkAccessFlags2 dstAccessMask) {
-
-    VkImageMemoryBarrier2 barrier{
-        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
-        .srcStageMask = srcStageMask,
-        .srcAccessMask = srcAccessMask,
-        .dstStageMask = dstStageMask,
-        .dstAccessMask = dstAccessMask,
-        .oldLayout = oldLayout,
-        .newLayout = newLayout,
-        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .image = image,
-        .subresourceRange = {
-            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-            .baseMipLevel = 0,
-            .levelCount = 1,
-            .baseArrayLayer = 0,
-            .layerCount = 1
-        }
-    };
-
-    VkDependencyInfo dependencyInfo{
-        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-        .imageMemoryBarrierCount = 1,
-        .pImageMemoryBarriers = &barrier
-    };
-
-    vkCmdPipelineBarrier2(cmd, &dependencyInfo);
-
+    ImageTransitionManager::BarrierBatch barriers;
+    barriers.image(ImageTransitionManager::mipRangeBarrier(
+        image, oldLayout, newLayout, srcStageMask, srcAccessMask, dstStageMask, dstAccessMask, 0, 1));
+    barriers.flush(cmd);
 }
 
 
-void TextureManager::createImage(uint32_t width, uint32_t height, VkFormat format,
-                                 VkImageTiling tiling, VkImageUsageFlags usage,
-                                 VmaMemoryUsage memoryUsage, VkImage& image, VmaAllocation& allocation) const
+void TextureManager::allocateImage(uint32_t width, uint32_t height, VkFormat format,
+                                   VkImageTiling tiling, VkImageUsageFlags usage,
+                                   VmaMemoryUsage memoryUsage, VkImage& image, VmaAllocation& allocation,
+                                   uint32_t mipLevels, uint32_t layers, VkImageCreateFlags flags) const
 {
     VkImageCreateInfo imageInfo{};
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.flags = flags;
     imageInfo.imageType = VK_IMAGE_TYPE_2D;
     imageInfo.extent = { width, height, 1 };
-    imageInfo.mipLevels = 1;
-    imageInfo.arrayLayers = 1;
+    imageInfo.mipLevels = mipLevels;
+    imageInfo.arrayLayers = layers;
     imageInfo.format = format;
     imageInfo.tiling = tiling;
     imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -356,26 +384,19 @@ void TextureManager::createImage(uint32_t width, uint32_t height, VkFormat forma
     if (vmaCreateImage(m_allocator, &imageInfo, &allocInfo, &image, &allocation, nullptr) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create Vulkan image!");
     }
-
-    VmaAllocator allocCopy = m_allocator;
-    VkImage       imageCopy = image;
-    VmaAllocation allocHandle = allocation;
-
-
-    DeletionQueue::get().pushFunction("Image_" + std::to_string(imageID++),[allocCopy, imageCopy, allocHandle]() {
-        vmaDestroyImage(allocCopy, imageCopy, allocHandle);
-        });
 }
 
-VkImageView TextureManager::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags) const {
+VkImageView TextureManager::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags,
+                                            uint32_t mipLevels, VkComponentMapping components) const {
     VkImageViewCreateInfo viewInfo{};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     viewInfo.image = image;
     viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
     viewInfo.format = format;
+    viewInfo.components = components;
     viewInfo.subresourceRange.aspectMask = aspectFlags;
     viewInfo.subresourceRange.baseMipLevel = 0;
-    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.levelCount = mipLevels;
     viewInfo.subresourceRange.baseArrayLayer = 0;
     viewInfo.subresourceRange.layerCount = 1;
 
@@ -383,13 +404,6 @@ VkImageView TextureManager::createImageView(VkImage image, VkFormat format, VkIm
     if (vkCreateImageView(m_device, &viewInfo, nullptr, &imageView) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create image view!");
     }
-    VkDevice     deviceCopy = m_device;
-    VkImageView  viewCopy = imageView;
-
-    static int imageViewIndex = 0;
-    DeletionQueue::get().pushFunction("ImageViewTexture_" + std::to_string(imageViewIndex++), [deviceCopy, viewCopy]() {
-        vkDestroyImageView(deviceCopy, viewCopy, nullptr);
-        });
     return imageView;
 }
 
@@ -406,94 +420,12 @@ VkSampler TextureManager::createSampler() const {
     samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
     samplerInfo.unnormalizedCoordinates = VK_FALSE;
     samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
 
     VkSampler sampler;
     if (vkCreateSampler(m_device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create sampler!");
     }
-    VkDevice deviceCopy = m_device;
-    VkSampler samplerCopy = sampler;
-
-    DeletionQueue::get().pushFunction("Sampler_" + std::to_string( samplerIndex++), [deviceCopy, samplerCopy]() {
-        vkDestroySampler(deviceCopy, samplerCopy, nullptr);
-        });
-
     return sampler;
 }
-
-void TextureManager::transitionImageLayout(VkImage image, VkFormat format,
-                                         VkImageLayout oldLayout, VkImageLayout newLayout) const
-{
-    VkCommandBuffer cmd = m_commandManager->beginSingleTimeCommands();
-
-    VkImageMemoryBarrier2 barrier{
-        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
-        .srcStageMask = VK_PIPELINE_STAGE_2_NONE,
-        .srcAccessMask = 0,
-        .dstStageMask = VK_PIPELINE_STAGE_2_NONE,
-        .dstAccessMask = 0,
-        .oldLayout = oldLayout,
-        .newLayout = newLayout,
-        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .image = image,
-        .subresourceRange = {
-            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-            .baseMipLevel = 0,
-            .levelCount = 1,
-            .baseArrayLayer = 0,
-            .layerCount = 1
-        }
-    };
-
-    // Common transitions for texture uploading
-    if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED &&
-        newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
-    {
-        barrier.srcStageMask = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT;
-        barrier.dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
-        barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
-    }
-    else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL &&
-             newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-    {
-        barrier.srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
-        barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
-        barrier.dstStageMask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
-        barrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
-    }
-    else {
-        throw std::invalid_argument("Unsupported layout transition!");
-    }
-
-    // Define a dependency (synchronization scope) between commands before and after the barrier.
-    VkDependencyInfo dependencyInfo{
-        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-        .imageMemoryBarrierCount = 1,
-        .pImageMemoryBarriers = &barrier
-    };
-
-    // Insert a memory barrier into the command buffer
-    vkCmdPipelineBarrier2(cmd, &dependencyInfo);
-
-    m_commandManager->endSingleTimeCommands(cmd);
-}
-
-void TextureManager::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) const {
-    VkCommandBuffer cmd = m_commandManager->beginSingleTimeCommands();
-
-    VkBufferImageCopy region{};
-    region.bufferOffset = 0;
-    region.bufferRowLength = 0;
-    region.bufferImageHeight = 0;
-    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    region.imageSubresource.mipLevel = 0;
-    region.imageSubresource.baseArrayLayer = 0;
-    region.imageSubresource.layerCount = 1;
-    region.imageOffset = { 0, 0, 0 };
-    region.imageExtent = { width, height, 1 };
-
-    vkCmdCopyBufferToImage(cmd, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-    m_commandManager->endSingleTimeCommands(cmd);
-}
@@ -4,50 +4,73 @@
 #include "vk_mem_alloc.h"
 #include <vector>
 #include <string>
+#include <memory>
+#include <span>
 
 #include "debug_messenger.h"
+#include "texture_registry.h"
 
 class BufferManager;
 class CommandManager;
+class UploadBatcher;
 
-struct ManagedTexture {
-    VkImage image = VK_NULL_HANDLE;
-    VmaAllocation allocation = nullptr;
-    VkImageView view = VK_NULL_HANDLE;
-    VkSampler sampler = VK_NULL_HANDLE; // Optional (only for sampled images)
-    std::string id; // Unique identifier for recreation
-    uint32_t width = 0; // Store dimensions for debugging
+// CPU-side RGBA8 pixels, produced by decodeImage() and consumed by uploadTexture()
+struct DecodedImage {
+    std::vector<unsigned char> pixels;
+    uint32_t width = 0;
     uint32_t height = 0;
-    VkFormat format = VK_FORMAT_UNDEFINED;
-    VkImageUsageFlags usage = 0;
-    VmaMemoryUsage memoryUsage = VMA_MEMORY_USAGE_UNKNOWN;
-    VkImageAspectFlags aspect = 0;
-    bool hasSampler = false;
 };
 
-
 class TextureManager {
 public:
-    TextureManager(VkDevice device, VmaAllocator allocator,
+    TextureManager(VkPhysicalDevice physicalDevice, VkDevice device, VmaAllocator allocator,
         CommandManager* commandManager, BufferManager* bufferManager, DebugMessenger* debugMessenger);
+    ~TextureManager();
     TextureManager(const TextureManager&) = delete;
     TextureManager& operator=(const TextureManager&) = delete;
     TextureManager(TextureManager&&) = delete;
     TextureManager& operator=(TextureManager&&) = delete;
 
-    ManagedTexture& loadTexture(
+    // Uploads issued between begin/end are submitted together when the outermost end is reached.
+    // Textures created inside a batch must not be sampled before endUploadBatch returns.
+    void beginUploadBatch();
+    void endUploadBatch();
+
+    // Textures are owned by the registry; the handles stay valid until release()
+    TextureHandle loadTexture(
         const std::string& filepath,
         VkFormat           format     = VK_FORMAT_R8G8B8A8_SRGB
     );
-    ManagedTexture& loadHDRTexture(const std::string& path);
-
-    ManagedTexture& createTexture(uint32_t width, uint32_t height, VkFormat format,
+    TextureHandle loadHDRTexture(const std::string& path);
+
+    // Thread-safe: touches no Vulkan state, so it can run on worker threads
+    static DecodedImage decodeImage(const std::string& filepath);
+    static DecodedImage decodeImage(const unsigned char* encoded, size_t size, const std::string& debugName);
+    TextureHandle uploadTexture(const DecodedImage& image, VkFormat format = VK_FORMAT_R8G8B8A8_SRGB,
+                                const std::string& debugName = "");
+    // Uploads a complete, pre-built mip chain; levelOffsets[i] is where level i starts in data
+    // Block-compressed formats are accepted as long as the device supports sampling them.
+    TextureHandle uploadTextureLevels(VkFormat format, uint32_t width, uint32_t height,
+                                      const void* data, VkDeviceSize size, std::span<const VkDeviceSize> levelOffsets,
+                                      VkComponentMapping components = {}, const std::string& debugName = "");
+
+    TextureHandle createTexture(uint32_t width, uint32_t height, VkFormat format,
         VkImageUsageFlags usage, VmaMemoryUsage memoryUsage,
         VkImageAspectFlags aspect, bool createSampler = false, const std::string& debugName = "");
-    ManagedTexture& createTexture(const unsigned char* data, uint32_t width, uint32_t height, uint32_t channels, const std::string& debugName = "");
+    TextureHandle createTexture(const unsigned char* data, uint32_t width, uint32_t height, uint32_t channels, const std::string& debugName = "");
+
+    // No view is created; cube and face views are up to the caller
+    TextureHandle createCubeTexture(uint32_t size, VkFormat format,
+                                    VkImageUsageFlags usage, VmaMemoryUsage memoryUsage);
+
+    const ManagedTexture& get(TextureHandle handle) const { return m_textures.get(handle); }
+    // For views the caller created and destroys itself, e.g. the sampling view of a cube texture
+    void setView(TextureHandle handle, VkImageView view) { m_textures.setView(handle, view); }
+    const TextureRegistry& registry() const { return m_textures; }
+    // The image, view and sampler are destroyed once the frames in flight are done with them
+    void release(TextureHandle handle) { m_textures.release(handle); }
 
-    ManagedTexture& createCubeTexture(uint32_t size, VkFormat format,
-                                     VkImageUsageFlags usage, VmaMemoryUsage memoryUsage);
+    // A bare image outside the registry, for callers that build their own views; destroyed at shutdown
     void createImage(uint32_t width, uint32_t height, VkFormat format,
                                  VkImageTiling tiling, VkImageUsageFlags usage,
                                  VmaMemoryUsage memoryUsage, VkImage& image, VmaAllocation& allocation,
@@ -59,32 +82,32 @@ public:
                                           VkPipelineStageFlags2 srcStageMask, VkPipelineStageFlags2 dstStageMask,
                                           VkAccessFlags2 srcAccessMask, VkAccessFlags2 dstAccessMask);
 
-    const std::vector<ManagedTexture>& getTextures() const { return m_managedTextures; }
-
-    // Static method to access samplerIndex
-    static int getSamplerIndex() { return samplerIndex; }
-    static void incrementSamplerIndex() { samplerIndex++; }
-
 private:
+    VkPhysicalDevice m_physicalDevice;
     VkDevice m_device;
     VmaAllocator m_allocator;
     CommandManager* m_commandManager;
     BufferManager* m_bufferManager;
     DebugMessenger* m_debugMessenger;
 
-    std::vector<ManagedTexture> m_managedTextures;
+    TextureRegistry m_textures;
 
-    void createImage(uint32_t width, uint32_t height, VkFormat format,
-        VkImageTiling tiling, VkImageUsageFlags usage,
-        VmaMemoryUsage memoryUsage, VkImage& image, VmaAllocation& allocation) const;
+    std::unique_ptr<UploadBatcher> m_uploadBatcher;
+    uint32_t m_uploadBatchDepth = 0;
 
-    VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags) const;
-    VkSampler createSampler() const;
+    // Unlike the public createImage these leave destruction to registerTexture
+    void allocateImage(uint32_t width, uint32_t height, VkFormat format,
+        VkImageTiling tiling, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage,
+        VkImage& image, VmaAllocation& allocation, uint32_t mipLevels = 1,
+        uint32_t layers = 1, VkImageCreateFlags flags = 0) const;
+    TextureHandle registerTexture(const ManagedTexture& texture, const std::string& debugName);
 
-    void transitionImageLayout(VkImage image, VkFormat format,
-        VkImageLayout oldLayout, VkImageLayout newLayout) const;
-    void copyBufferToImage(VkBuffer buffer, VkImage image,
-        uint32_t width, uint32_t height) const;
+    VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels = 1,
+                                VkComponentMapping components = {}) const;
+    VkSampler createSampler() const;
 
-    static int samplerIndex;
+    // Full chain down to 1x1, or a single level when the format cannot be blitted with linear filtering
+    uint32_t mipLevelsFor(uint32_t width, uint32_t height, VkFormat format) const;
+    void uploadImage(VkImage image, const void* data, VkDeviceSize size, uint32_t width, uint32_t height,
+                     uint32_t mipLevels = 1);
 };
@@ -0,0 +1,105 @@
+#include "texture_registry.h"
+
+#include <stdexcept>
+
+TextureHandle TextureRegistry::insert(const ManagedTexture& texture, Deletion deletion, std::string debugName) {
+    uint32_t index;
+    if (!m_freeSlots.empty()) {
+        index = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    } else {
+        index = m_slotCount++;
+        if (index / PAGE_SIZE >= m_pages.size()) {
+            m_pages.push_back(std::make_unique<Page>());
+        }
+        m_debugNames.emplace_back();
+    }
+
+    Slot& entry = slot(index);
+    entry.texture = texture;
+    entry.deletion = deletion;
+    entry.live = true;
+    m_debugNames[index] = std::move(debugName);
+    ++m_liveCount;
+    return { index, entry.generation };
+}
+
+uint32_t TextureRegistry::checkedIndex(TextureHandle handle) const {
+    if (!contains(handle)) {
+        throw std::out_of_range("Stale or invalid texture handle!");
+    }
+    return handle.index;
+}
+
+const ManagedTexture& TextureRegistry::get(TextureHandle handle) const {
+    return slot(checkedIndex(handle)).texture;
+}
+
+void TextureRegistry::setView(TextureHandle handle, VkImageView view) {
+    slot(checkedIndex(handle)).texture.view = view;
+}
+
+bool TextureRegistry::contains(TextureHandle handle) const {
+    if (handle.index >= m_slotCount) {
+        return false;
+    }
+    const Slot& entry = slot(handle.index);
+    return entry.live && entry.generation == handle.generation;
+}
+
+const std::string& TextureRegistry::debugName(TextureHandle handle) const {
+    return m_debugNames[checkedIndex(handle)];
+}
+
+void TextureRegistry::release(TextureHandle handle) {
+    Slot& entry = slot(checkedIndex(handle));
+    // Frames in flight may still sample the texture
+    DeletionQueue::get().retire(entry.deletion.views);
+    DeletionQueue::get().retire(entry.deletion.image);
+
+    entry.texture = {};
+    entry.deletion = {};
+    entry.live = false;
+    ++entry.generation;
+    m_debugNames[handle.index].clear();
+    m_freeSlots.push_back(handle.index);
+    --m_liveCount;
+}
+
+uint32_t TextureDescriptorArray::add(TextureHandle handle) {
+    auto [it, inserted] = m_indices.try_emplace(key(handle), size());
+    if (inserted) {
+        m_handles.push_back(handle);
+    }
+    return it->second;
+}
+
+uint32_t TextureDescriptorArray::reserve() {
+    m_handles.emplace_back();
+    return size() - 1;
+}
+
+void TextureDescriptorArray::assign(uint32_t index, TextureHandle handle) {
+    m_handles.at(index) = handle;
+    m_indices.try_emplace(key(handle), index);
+}
+
+void TextureDescriptorArray::clear() {
+    m_handles.clear();
+    m_indices.clear();
+}
+
+std::vector<VkDescriptorImageInfo> TextureDescriptorArray::imageInfos(const TextureRegistry& registry,
+                                                                      VkImageLayout layout) const {
+    std::vector<VkDescriptorImageInfo> infos;
+    infos.reserve(m_handles.size());
+    for (TextureHandle handle : m_handles) {
+        const ManagedTexture& texture = registry.get(handle);
+        infos.push_back({
+            .sampler = texture.sampler,
+            .imageView = texture.view,
+            .imageLayout = layout
+        });
+    }
+    return infos;
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "deletion_queue.h"
+#include "vk_mem_alloc.h"
+
+struct ManagedTexture {
+    VkImage image = VK_NULL_HANDLE;
+    VmaAllocation allocation = nullptr;
+    VkImageView view = VK_NULL_HANDLE;
+    VkSampler sampler = VK_NULL_HANDLE; // Optional (only for sampled images)
+    uint32_t width = 0;
+    uint32_t height = 0;
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    uint32_t mipLevels = 1;
+    VkImageUsageFlags usage = 0;
+    VmaMemoryUsage memoryUsage = VMA_MEMORY_USAGE_UNKNOWN;
+    VkImageAspectFlags aspect = 0;
+    bool hasSampler = false;
+};
+
+// Names a texture in a TextureRegistry. A handle whose texture was released goes stale instead of
+// aliasing whatever reuses the slot.
+struct TextureHandle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool isValid() const { return index != UINT32_MAX; }
+    bool operator==(const TextureHandle&) const = default;
+};
+
+// Generational slot map of textures. Slots live in fixed-size pages, so references returned by
+// get() stay valid while other textures are added; only releasing the texture invalidates them.
+// Debug names are kept apart from the slots that lookups touch.
+class TextureRegistry {
+public:
+    // DeletionQueue entries for the texture's objects, retired together on release
+    struct Deletion {
+        DeletionQueue::Handle image = DeletionQueue::INVALID_HANDLE;
+        DeletionQueue::Handle views = DeletionQueue::INVALID_HANDLE; // View and sampler
+    };
+
+    TextureHandle insert(const ManagedTexture& texture, Deletion deletion, std::string debugName = {});
+
+    // Throws on a stale or invalid handle
+    const ManagedTexture& get(TextureHandle handle) const;
+    // The registry does not take ownership of the view
+    void setView(TextureHandle handle, VkImageView view);
+    bool contains(TextureHandle handle) const;
+    const std::string& debugName(TextureHandle handle) const;
+
+    // Retires the texture's objects through the DeletionQueue and frees the slot for reuse
+    void release(TextureHandle handle);
+
+    uint32_t size() const { return m_liveCount; }
+
+private:
+    static constexpr uint32_t PAGE_SIZE = 128;
+
+    struct Slot {
+        ManagedTexture texture;
+        Deletion deletion;
+        uint32_t generation = 0;
+        bool live = false;
+    };
+    using Page = std::array<Slot, PAGE_SIZE>;
+
+    Slot& slot(uint32_t index) { return (*m_pages[index / PAGE_SIZE])[index % PAGE_SIZE]; }
+    const Slot& slot(uint32_t index) const { return (*m_pages[index / PAGE_SIZE])[index % PAGE_SIZE]; }
+    uint32_t checkedIndex(TextureHandle handle) const;
+
+    std::vector<std::unique_ptr<Page>> m_pages;
+    std::vector<std::string> m_debugNames; // Indexed like the slots
+    std::vector<uint32_t> m_freeSlots;
+    uint32_t m_slotCount = 0;
+    uint32_t m_liveCount = 0;
+};
+
+// Dense descriptor array indices for a set of textures, in the order they were added. Shaders index
+// the array with what add()/reserve() returned; imageInfos() produces the matching descriptor writes.
+class TextureDescriptorArray {
+public:
+    // Returns the existing index when the texture is already in the array
+    uint32_t add(TextureHandle handle);
+    // An index whose texture is assigned later, e.g. once an asynchronous upload finishes
+    uint32_t reserve();
+    void assign(uint32_t index, TextureHandle handle);
+
+    TextureHandle operator[](uint32_t index) const { return m_handles[index]; }
+    uint32_t size() const { return static_cast<uint32_t>(m_handles.size()); }
+    bool empty() const { return m_handles.empty(); }
+    void clear();
+
+    std::vector<VkDescriptorImageInfo> imageInfos(const TextureRegistry& registry,
+                                                  VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) const;
+
+private:
+    static uint64_t key(TextureHandle handle) {
+        return (static_cast<uint64_t>(handle.generation) << 32) | handle.index;
+    }
+
+    std::vector<TextureHandle> m_handles;
+    std::unordered_map<uint64_t, uint32_t> m_indices;
+};
@@ -1,12 +1,13 @@
 #include "uniform_buffer.h"
 #include "data_structures.h"
 
-UniformBuffer::UniformBuffer(BufferManager* bufferManager, VmaAllocator alloc, VkDeviceSize bufferSize)
+UniformBuffer::UniformBuffer(BufferManager* bufferManager, VmaAllocator alloc, VkDeviceSize bufferSize,
+                             VkBufferUsageFlags usage)
     : allocator(alloc), size(bufferSize)
 {
     managedBuffer = bufferManager->createBuffer(
         bufferSize,
-        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+        usage,
         VMA_MEMORY_USAGE_CPU_TO_GPU
     );
     allocation = managedBuffer.allocation;
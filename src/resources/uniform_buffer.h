@@ -10,7 +10,9 @@
 class UniformBuffer final : public Buffer {
 public:
     UniformBuffer() = default;
-    UniformBuffer(BufferManager* bufferManager, VmaAllocator alloc, VkDeviceSize bufferSize);
+    // Persistently mapped; extra usage bits let the same host-visible memory back storage buffers
+    UniformBuffer(BufferManager* bufferManager, VmaAllocator alloc, VkDeviceSize bufferSize,
+                  VkBufferUsageFlags usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
     UniformBuffer(UniformBuffer&& other) noexcept;
     UniformBuffer& operator=(UniformBuffer&& other) noexcept;
     UniformBuffer(const UniformBuffer&) = delete;
@@ -21,6 +23,10 @@ public:
     void update(const T& data) const {
         std::memcpy(mapped, &data, sizeof(T));
     }
+
+    void write(const void* data, VkDeviceSize bytes, VkDeviceSize offset = 0) const {
+        std::memcpy(static_cast<char*>(mapped) + offset, data, bytes);
+    }
 protected:
     void*               mapped        = nullptr;
     VmaAllocator        allocator     = VK_NULL_HANDLE;
@@ -0,0 +1,221 @@
+#include "upload_batcher.h"
+#include "command_manager.h"
+#include "deletion_queue.h"
+#include "image_transition_manager.h"
+
+#include <algorithm>
+
+#include <cstring>
+#include <stdexcept>
+
+UploadBatcher::UploadBatcher(VkDevice device, VmaAllocator allocator, CommandManager* commandManager,
+                             VkDeviceSize stagingBudget)
+    : m_device(device), m_allocator(allocator), m_commandManager(commandManager), m_stagingBudget(stagingBudget)
+{
+    VkFenceCreateInfo fenceInfo{ .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+    if (vkCreateFence(m_device, &fenceInfo, nullptr, &m_fence) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create upload fence!");
+    }
+
+    DeletionQueue::get().push([device, fence = m_fence]() {
+        vkDestroyFence(device, fence, nullptr);
+    });
+}
+
+void UploadBatcher::enqueueImage(VkImage image, const void* data, VkDeviceSize size, uint32_t width, uint32_t height,
+                                 uint32_t mipLevels) {
+    VkBufferImageCopy region{};
+    region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+    region.imageExtent = { width, height, 1 };
+
+    mipLevels = std::max(mipLevels, 1u);
+    enqueue({ image, VK_NULL_HANDLE, width, height, mipLevels, mipLevels > 1, { region } }, data, size);
+}
+
+void UploadBatcher::enqueueImageLevels(VkImage image, const void* data, VkDeviceSize size, uint32_t mipLevels,
+                                       std::vector<VkBufferImageCopy> regions) {
+    const VkExtent3D extent = regions.empty() ? VkExtent3D{ 1, 1, 1 } : regions.front().imageExtent;
+    enqueue({ image, VK_NULL_HANDLE, extent.width, extent.height, std::max(mipLevels, 1u), false, std::move(regions) },
+            data, size);
+}
+
+void UploadBatcher::enqueue(PendingImage pending, const void* data, VkDeviceSize size) {
+    if (!empty() && m_pendingBytes + size > m_stagingBudget) {
+        flush();
+    }
+
+    StagingBuffer staging = createStagingBuffer(data, size);
+    m_stagingBuffers.push_back(staging);
+    pending.staging = staging.buffer;
+    m_pendingImages.push_back(std::move(pending));
+    m_pendingBytes += size;
+}
+
+void UploadBatcher::flush() {
+    if (empty()) {
+        return;
+    }
+
+    VkCommandBufferAllocateInfo allocInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool = m_commandManager->commandPool(),
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1
+    };
+    VkCommandBuffer cmd;
+    if (vkAllocateCommandBuffers(m_device, &allocInfo, &cmd) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate upload command buffer!");
+    }
+
+    VkCommandBufferBeginInfo beginInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+    };
+    vkBeginCommandBuffer(cmd, &beginInfo);
+    recordUploads(cmd);
+    if (vkEndCommandBuffer(cmd) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to record upload command buffer!");
+    }
+
+    VkCommandBufferSubmitInfo cmdInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+        .commandBuffer = cmd
+    };
+    VkSubmitInfo2 submitInfo{
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+        .commandBufferInfoCount = 1,
+        .pCommandBufferInfos = &cmdInfo
+    };
+    if (vkQueueSubmit2(m_commandManager->graphicsQueue(), 1, &submitInfo, m_fence) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to submit texture uploads!");
+    }
+
+    // Only this batch is waited on, not the whole queue
+    vkWaitForFences(m_device, 1, &m_fence, VK_TRUE, UINT64_MAX);
+    vkResetFences(m_device, 1, &m_fence);
+    vkFreeCommandBuffers(m_device, m_commandManager->commandPool(), 1, &cmd);
+
+    releaseStagingBuffers();
+    m_pendingImages.clear();
+    m_pendingBytes = 0;
+}
+
+UploadBatcher::StagingBuffer UploadBatcher::createStagingBuffer(const void* data, VkDeviceSize size) const {
+    VkBufferCreateInfo bufferInfo{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = size,
+        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE
+    };
+    VmaAllocationCreateInfo allocCreateInfo{
+        .flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+        .usage = VMA_MEMORY_USAGE_AUTO
+    };
+
+    // Not registered in the DeletionQueue: released by flush() once the copy has completed
+    StagingBuffer staging;
+    VmaAllocationInfo allocationInfo;
+    if (vmaCreateBuffer(m_allocator, &bufferInfo, &allocCreateInfo, &staging.buffer, &staging.allocation, &allocationInfo) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create staging buffer!");
+    }
+    memcpy(allocationInfo.pMappedData, data, static_cast<size_t>(size));
+    vmaFlushAllocation(m_allocator, staging.allocation, 0, VK_WHOLE_SIZE);
+    return staging;
+}
+
+void UploadBatcher::recordUploads(VkCommandBuffer cmd) const {
+    constexpr VkPipelineStageFlags2 transferStages = VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_BLIT_BIT;
+    constexpr VkPipelineStageFlags2 shaderStages = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+
+    ImageTransitionManager::BarrierBatch barriers;
+
+    for (const auto& pending : m_pendingImages) {
+        barriers.image(ImageTransitionManager::mipRangeBarrier(
+            pending.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE,
+            transferStages, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            0, pending.mipLevels));
+    }
+    barriers.flush(cmd);
+
+    for (const auto& pending : m_pendingImages) {
+        vkCmdCopyBufferToImage(cmd, pending.staging, pending.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            static_cast<uint32_t>(pending.regions.size()), pending.regions.data());
+    }
+
+    recordMipChains(cmd);
+
+    // A blit chain leaves the levels below the last one in TRANSFER_SRC, the last one is still TRANSFER_DST.
+    // Images uploaded with all their levels are TRANSFER_DST throughout.
+    for (const auto& pending : m_pendingImages) {
+        const uint32_t lastLevel = pending.generateMips ? pending.mipLevels - 1 : 0;
+        if (lastLevel > 0) {
+            barriers.image(ImageTransitionManager::mipRangeBarrier(
+                pending.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_READ_BIT,
+                shaderStages, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+                0, lastLevel));
+        }
+        barriers.image(ImageTransitionManager::mipRangeBarrier(
+            pending.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            transferStages, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            shaderStages, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+            lastLevel, pending.mipLevels - lastLevel));
+    }
+    barriers.flush(cmd);
+}
+
+void UploadBatcher::recordMipChains(VkCommandBuffer cmd) const {
+    uint32_t maxMipLevels = 1;
+    for (const auto& pending : m_pendingImages) {
+        if (pending.generateMips) {
+            maxMipLevels = std::max(maxMipLevels, pending.mipLevels);
+        }
+    }
+
+    // Built level by level across all images so each level costs one barrier batch, not one per image
+    ImageTransitionManager::BarrierBatch barriers;
+    for (uint32_t level = 1; level < maxMipLevels; ++level) {
+        for (const auto& pending : m_pendingImages) {
+            if (pending.generateMips && level < pending.mipLevels) {
+                barriers.image(ImageTransitionManager::mipRangeBarrier(
+                    pending.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                    VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                    VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_READ_BIT,
+                    level - 1, 1));
+            }
+        }
+        barriers.flush(cmd);
+
+        for (const auto& pending : m_pendingImages) {
+            if (!pending.generateMips || level >= pending.mipLevels) {
+                continue;
+            }
+
+            VkImageBlit blit{};
+            blit.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1 };
+            blit.srcOffsets[1] = {
+                static_cast<int32_t>(std::max(pending.width >> (level - 1), 1u)),
+                static_cast<int32_t>(std::max(pending.height >> (level - 1), 1u)),
+                1
+            };
+            blit.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 };
+            blit.dstOffsets[1] = {
+                static_cast<int32_t>(std::max(pending.width >> level, 1u)),
+                static_cast<int32_t>(std::max(pending.height >> level, 1u)),
+                1
+            };
+            vkCmdBlitImage(cmd,
+                pending.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                pending.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                1, &blit, VK_FILTER_LINEAR);
+        }
+    }
+}
+
+void UploadBatcher::releaseStagingBuffers() {
+    for (const auto& staging : m_stagingBuffers) {
+        vmaDestroyBuffer(m_allocator, staging.buffer, staging.allocation);
+    }
+    m_stagingBuffers.clear();
+}
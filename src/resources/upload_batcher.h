@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include "vk_mem_alloc.h"
+#include <vector>
+
+class CommandManager;
+
+// Collects texture uploads and submits them together: one barrier batch into TRANSFER_DST,
+// all buffer-to-image copies, the blit chains for the remaining mips (one barrier batch per level),
+// and one barrier batch into SHADER_READ_ONLY. Completion is tracked with a fence and the staging
+// memory is released as soon as the GPU is done with it.
+class UploadBatcher {
+public:
+    // Flush early once this much staging memory is pending
+    static constexpr VkDeviceSize DEFAULT_STAGING_BUDGET = 256ull * 1024 * 1024;
+
+    UploadBatcher(VkDevice device, VmaAllocator allocator, CommandManager* commandManager,
+                  VkDeviceSize stagingBudget = DEFAULT_STAGING_BUDGET);
+    UploadBatcher(const UploadBatcher&) = delete;
+    UploadBatcher& operator=(const UploadBatcher&) = delete;
+    UploadBatcher(UploadBatcher&&) = delete;
+    UploadBatcher& operator=(UploadBatcher&&) = delete;
+
+    // Copies data into a staging buffer right away. data fills mip 0; levels 1..mipLevels-1 are blitted
+    // from it, so the format must support linear blits when mipLevels > 1. The whole image ends up in
+    // SHADER_READ_ONLY_OPTIMAL.
+    void enqueueImage(VkImage image, const void* data, VkDeviceSize size, uint32_t width, uint32_t height,
+                      uint32_t mipLevels = 1);
+
+    // Same, for data that already holds every mip level (one copy region per level, nothing is blitted)
+    void enqueueImageLevels(VkImage image, const void* data, VkDeviceSize size, uint32_t mipLevels,
+                            std::vector<VkBufferImageCopy> regions);
+
+    // Records and submits everything queued, waits on the fence and frees the staging buffers
+    void flush();
+
+    bool empty() const { return m_pendingImages.empty(); }
+
+private:
+    struct StagingBuffer {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VmaAllocation allocation = nullptr;
+    };
+
+    struct PendingImage {
+        VkImage image;
+        VkBuffer staging;
+        uint32_t width;
+        uint32_t height;
+        uint32_t mipLevels;
+        bool generateMips;
+        std::vector<VkBufferImageCopy> regions;
+    };
+
+    void enqueue(PendingImage pending, const void* data, VkDeviceSize size);
+    StagingBuffer createStagingBuffer(const void* data, VkDeviceSize size) const;
+    void recordUploads(VkCommandBuffer cmd) const;
+    void recordMipChains(VkCommandBuffer cmd) const;
+    void releaseStagingBuffers();
+
+    VkDevice m_device;
+    VmaAllocator m_allocator;
+    CommandManager* m_commandManager;
+    VkFence m_fence = VK_NULL_HANDLE;
+
+    VkDeviceSize m_stagingBudget;
+    VkDeviceSize m_pendingBytes = 0;
+    std::vector<StagingBuffer> m_stagingBuffers;
+    std::vector<PendingImage> m_pendingImages;
+};
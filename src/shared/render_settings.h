@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+// Rendering settings: runtime toggles edited from the Stats panel, plus startup choices from the command line
+inline struct RenderSettings {
+    // Off: the prepass only clears depth and the G-buffer pass depth-tests and writes on its own,
+    // which is the baseline the overdraw statistics compare against
+    bool depthPrepass = true;
+
+    // Extra point/spot lights scattered through the scene bounds on top of the scene's own light
+    // (--lights N, Stats panel); the light set is regenerated when this changes
+    uint32_t stressLights = 0;
+
+    // Lighting pass as 16x16 compute tiles with per-tile light culling instead of the
+    // fullscreen fragment shader over the light clusters (--compute-lighting, Stats panel)
+    bool computeLighting = false;
+
+    // Blend between logarithmic (1) and uniform (0) shadow cascade splits (Stats panel)
+    float shadowSplitLambda = 0.75f;
+
+    // Off: every shadow cascade is refitted and redrawn each frame instead of reusing its cached layer
+    bool shadowCaching = true;
+
+    // Threads recording the CPU-culled geometry passes into secondary command buffers; 0 uses every
+    // worker plus the render thread, 1 records inline (--record-threads N, Stats panel)
+    uint32_t recordingThreads = 0;
+
+    // Cull and draw on the CPU even where GPU culling is supported, so the per-draw recording cost
+    // shows up in the frame timings (--cpu-culling)
+    bool forceCpuCulling = false;
+
+    // Preferred deferred target formats, read once when the renderer starts (--hdr-format,
+    // --normal-format); GBufferFormats falls back to wider ones the device supports
+    VkFormat hdrFormat = VK_FORMAT_B10G11R11_UFLOAT_PACK32;
+    VkFormat normalFormat = VK_FORMAT_R16G16_UNORM;
+} renderSettings;
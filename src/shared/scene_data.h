@@ -2,14 +2,26 @@
 #include "data_structures.h"
 #include "index_buffer.h"
 #include "ssbo_buffer.h"
+#include "frame_graph.h"
 #include "texture_manager.h"
+#include "culling/gpu_culler.h"
 
 struct MainSceneGlobalData {
-    // Resources
-    std::vector<ManagedTexture> modelTextures;
-    std::vector<ManagedTexture> materialTextures;
-    std::vector<ManagedTexture> normalTextures;
+    // Resources. Primitives index these arrays (materialIndex, metalRoughTextureIndex, normalTextureIndex)
+    TextureDescriptorArray modelTextures;
+    TextureDescriptorArray materialTextures;
+    TextureDescriptorArray normalTextures;
     std::vector<GLTFPrimitiveData> primitives;
+    SSBOBuffer primitiveBuffer;             // primitives, read by the cull shader and at gl_InstanceIndex
+    uint64_t primitiveBufferAddress;
+
+    // Culling results per view, rebuilt before the passes that draw them. With indirect count support
+    // the GPU culls into the draw lists; otherwise the CPU culls into the index lists.
+    bool gpuCulling = false;
+    std::array<GpuCuller::DrawList, MAX_FRAMES_IN_FLIGHT> cameraDrawLists;
+    std::array<GpuCuller::DrawList, SHADOW_CASCADE_COUNT> shadowDrawLists;
+    std::vector<uint32_t> cameraVisiblePrimitives;
+    std::array<std::vector<uint32_t>, SHADOW_CASCADE_COUNT> shadowVisiblePrimitives;
     SSBOBuffer vertexBuffer;
     uint64_t vertexBufferAddress;
     IndexBuffer indexBuffer;
@@ -32,33 +44,53 @@ struct MainSceneGlobalData {
         std::vector<VkDescriptorImageInfo> textureImageInfos;
         std::vector<VkDescriptorImageInfo> materialImageInfos;
         std::vector<VkDescriptorImageInfo> normalImageInfos;
-        VkDescriptorBufferInfo omniLightBufferInfo;
+        VkDescriptorBufferInfo lightBufferInfo;           // LightData[], read through lightClusterBufferInfo
+        VkDescriptorBufferInfo lightClusterBufferInfo;
         VkDescriptorBufferInfo cameraExposureBufferInfo;
         VkDescriptorBufferInfo directionalLightBufferInfo;
     };
     std::array<FrameData, MAX_FRAMES_IN_FLIGHT> frameData;
+
+    // Draws one view's culled primitives; the index buffer and pass push constants must be bound
+    void drawVisible(VkCommandBuffer cmd, const GpuCuller::DrawList& drawList,
+                     const std::vector<uint32_t>& visiblePrimitives) const {
+        if (gpuCulling) {
+            GpuCuller::draw(cmd, drawList);
+            return;
+        }
+        drawPrimitives(cmd, visiblePrimitives, 0, static_cast<uint32_t>(visiblePrimitives.size()));
+    }
+
+    // CPU-culled draws [begin, end) of visiblePrimitives, the unit of parallel recording
+    void drawPrimitives(VkCommandBuffer cmd, const std::vector<uint32_t>& visiblePrimitives,
+                        uint32_t begin, uint32_t end) const {
+        for (uint32_t i = begin; i < end; ++i) {
+            const uint32_t primitiveIndex = visiblePrimitives[i];
+            const auto& primitive = primitives[primitiveIndex];
+            vkCmdDrawIndexed(cmd, primitive.indexCount, 1, primitive.indexOffset, 0, primitiveIndex);
+        }
+    }
 };
 
 inline glm::vec3 globalScale{1.0f, 1.0f, 1.0f};
 
 struct PassDependencies {
-    // Per-frame textures
+    // Per-frame depth buffer (gDepth), written once by the depth prepass
     std::array<ManagedTexture*, MAX_FRAMES_IN_FLIGHT> depthTextures;
-    std::array<ManagedTexture*, MAX_FRAMES_IN_FLIGHT> albedoTextures;
-    std::array<ManagedTexture*, MAX_FRAMES_IN_FLIGHT> normalTextures;
-    std::array<ManagedTexture*, MAX_FRAMES_IN_FLIGHT> paramTextures;
-    std::array<ManagedTexture*, MAX_FRAMES_IN_FLIGHT> hdrTextures;
 
     // Static Textures
-    ManagedTexture* equirectTexture;
-    ManagedTexture* cubeMap;
-    ManagedTexture* irradianceMap;
-    ManagedTexture* shadowMap;
-
-    // Layout tracking
-    std::array<VkImageLayout, MAX_FRAMES_IN_FLIGHT> depthLayouts;
-    std::array<ManagedTexture*, MAX_FRAMES_IN_FLIGHT> perFrameDepthTextures;
+    const ManagedTexture* cubeMap;
+    const ManagedTexture* irradianceMap;
+    ManagedTexture* shadowMap;              // SHADOW_CASCADE_COUNT layers; view is the 2D array view
 
-    void transitionDepth(VkCommandBuffer cmd, uint32_t frameIndex,
-                         VkImageLayout newLayout);
+    // Frame graph images. The G-buffer and HDR targets are transients the passes register in
+    // initialize(); the graph owns them and derives every layout transition between the passes.
+    FrameGraph* frameGraph = nullptr;
+    FrameGraph::ResourceId depth = 0;       // Imported, bound to depthTextures[frameIndex]
+    FrameGraph::ResourceId shadowMapImage = 0;
+    FrameGraph::ResourceId swapchain = 0;
+    FrameGraph::ResourceId albedo = 0;
+    FrameGraph::ResourceId normal = 0;
+    FrameGraph::ResourceId params = 0;
+    FrameGraph::ResourceId hdr = 0;
 };
\ No newline at end of file
@@ -3,11 +3,11 @@
 
 // 16‐byte alignment is guaranteed on most GPUs,
 // but push constants themselves have offset/size rules at the pipeline‐layout level.
+// Per-primitive material indices are read from the primitive buffer at gl_InstanceIndex,
+// so these stay constant for a whole pass.
 struct PushConstants {
     uint64_t vertexBufferAddress;
-    uint32_t baseColorTextureIndex;      // Index for albedo texture
-    uint32_t metalRoughTextureIndex;     // Index for material texture
-    uint32_t normalTextureIndex;         // Index for normal texture
+    uint64_t primitiveBufferAddress;     // GLTFPrimitiveData[], indexed by gl_InstanceIndex
     uint32_t textureCount;
     glm::vec3 modelScale;
 };
@@ -18,6 +18,30 @@ struct TonePush {
 
 struct ShadowPushConstants {
     uint64_t vertexBufferAddress;
+    uint64_t primitiveBufferAddress;
     glm::vec3 modelScale;
-    uint32_t baseColorTextureIndex;
-};
\ No newline at end of file
+    uint32_t cascadeIndex;               // Selects DirectionalLightData::cascadeViewProj and the array layer
+};
+
+// Must stay within the guaranteed 128 bytes of push constant space
+struct CullPushConstants {
+    glm::vec4 frustumPlanes[6];
+    uint64_t primitiveBufferAddress;
+    uint64_t drawCommandAddress;         // VkDrawIndexedIndirectCommand[]
+    uint64_t drawCountAddress;           // uint32_t, reset before every dispatch
+    uint32_t primitiveCount;
+};
+static_assert(sizeof(CullPushConstants) <= 128);
+// Must stay within the guaranteed 128 bytes of push constant space
+struct LightClusterPushConstants {
+    glm::mat4 view;
+    glm::vec2 ndcToView;                 // 1 / proj[0][0], 1 / proj[1][1]: view-space x/y per NDC unit at depth 1
+    glm::vec2 screenSize;
+    glm::vec2 tileSize;                  // Pixels covered by one cluster column
+    float zNear;
+    float zFar;
+    uint64_t lightBufferAddress;         // LightData[]
+    uint64_t clusterBufferAddress;       // LightClusterer::Header followed by the cluster light lists
+    uint32_t lightCount;
+};
+static_assert(sizeof(LightClusterPushConstants) <= 128);
@@ -0,0 +1,197 @@
+#include "bc_encoder.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+    using Block = std::array<unsigned char, 16 * 4>;
+
+    Block fetchBlock(const unsigned char* rgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY) {
+        Block block;
+        for (uint32_t y = 0; y < 4; ++y) {
+            const uint32_t sy = std::min(blockY * 4 + y, height - 1);
+            for (uint32_t x = 0; x < 4; ++x) {
+                const uint32_t sx = std::min(blockX * 4 + x, width - 1);
+                std::memcpy(&block[(y * 4 + x) * 4], rgba + (size_t(sy) * width + sx) * 4, 4);
+            }
+        }
+        return block;
+    }
+
+    uint16_t to565(const int color[3]) {
+        return static_cast<uint16_t>(((color[0] * 31 + 127) / 255) << 11 |
+                                     ((color[1] * 63 + 127) / 255) << 5 |
+                                     ((color[2] * 31 + 127) / 255));
+    }
+
+    void from565(uint16_t packed, int color[3]) {
+        const int r = (packed >> 11) & 31;
+        const int g = (packed >> 5) & 63;
+        const int b = packed & 31;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+    }
+
+    // Bounding box of the block, diagonal picked from the covariance signs, inset by 1/16 to reduce error
+    void encodeColorBlock(const Block& block, unsigned char* out) {
+        int minColor[3] = { 255, 255, 255 };
+        int maxColor[3] = { 0, 0, 0 };
+        for (int i = 0; i < 16; ++i) {
+            for (int c = 0; c < 3; ++c) {
+                minColor[c] = std::min(minColor[c], int(block[i * 4 + c]));
+                maxColor[c] = std::max(maxColor[c], int(block[i * 4 + c]));
+            }
+        }
+
+        int center[3];
+        for (int c = 0; c < 3; ++c) {
+            center[c] = (minColor[c] + maxColor[c]) / 2;
+        }
+        int covRG = 0;
+        int covRB = 0;
+        for (int i = 0; i < 16; ++i) {
+            const int r = block[i * 4 + 0] - center[0];
+            covRG += r * (block[i * 4 + 1] - center[1]);
+            covRB += r * (block[i * 4 + 2] - center[2]);
+        }
+        if (covRG < 0) {
+            std::swap(minColor[1], maxColor[1]);
+        }
+        if (covRB < 0) {
+            std::swap(minColor[2], maxColor[2]);
+        }
+
+        for (int c = 0; c < 3; ++c) {
+            const int inset = (maxColor[c] - minColor[c]) / 16;
+            maxColor[c] = std::clamp(maxColor[c] - inset, 0, 255);
+            minColor[c] = std::clamp(minColor[c] + inset, 0, 255);
+        }
+
+        uint16_t color0 = to565(maxColor);
+        uint16_t color1 = to565(minColor);
+        if (color0 < color1) {
+            std::swap(color0, color1);
+        }
+
+        // color0 > color1 selects the four-color mode; equal endpoints encode as a solid block
+        uint32_t indices = 0;
+        if (color0 != color1) {
+            int palette[4][3];
+            from565(color0, palette[0]);
+            from565(color1, palette[1]);
+            for (int c = 0; c < 3; ++c) {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+
+            for (int i = 0; i < 16; ++i) {
+                int bestIndex = 0;
+                int bestError = INT32_MAX;
+                for (int p = 0; p < 4; ++p) {
+                    int error = 0;
+                    for (int c = 0; c < 3; ++c) {
+                        const int d = block[i * 4 + c] - palette[p][c];
+                        error += d * d;
+                    }
+                    if (error < bestError) {
+                        bestError = error;
+                        bestIndex = p;
+                    }
+                }
+                indices |= uint32_t(bestIndex) << (i * 2);
+            }
+        }
+
+        out[0] = static_cast<unsigned char>(color0 & 0xFF);
+        out[1] = static_cast<unsigned char>(color0 >> 8);
+        out[2] = static_cast<unsigned char>(color1 & 0xFF);
+        out[3] = static_cast<unsigned char>(color1 >> 8);
+        std::memcpy(out + 4, &indices, 4);
+    }
+
+    // Eight-value mode (endpoint0 > endpoint1) over the channel's min/max
+    void encodeChannelBlock(const Block& block, int channel, unsigned char* out) {
+        int minValue = 255;
+        int maxValue = 0;
+        for (int i = 0; i < 16; ++i) {
+            minValue = std::min(minValue, int(block[i * 4 + channel]));
+            maxValue = std::max(maxValue, int(block[i * 4 + channel]));
+        }
+
+        uint64_t indices = 0;
+        if (maxValue != minValue) {
+            int palette[8];
+            palette[0] = maxValue;
+            palette[1] = minValue;
+            for (int p = 1; p < 7; ++p) {
+                palette[p + 1] = ((7 - p) * maxValue + p * minValue) / 7;
+            }
+
+            for (int i = 0; i < 16; ++i) {
+                const int value = block[i * 4 + channel];
+                int bestIndex = 0;
+                int bestError = INT32_MAX;
+                for (int p = 0; p < 8; ++p) {
+                    const int error = std::abs(value - palette[p]);
+                    if (error < bestError) {
+                        bestError = error;
+                        bestIndex = p;
+                    }
+                }
+                indices |= uint64_t(bestIndex) << (i * 3);
+            }
+        }
+
+        out[0] = static_cast<unsigned char>(maxValue);
+        out[1] = static_cast<unsigned char>(minValue);
+        for (int byte = 0; byte < 6; ++byte) {
+            out[2 + byte] = static_cast<unsigned char>(indices >> (byte * 8));
+        }
+    }
+
+    template<size_t BlockBytes, typename EncodeFn>
+    std::vector<unsigned char> encodeImage(const unsigned char* rgba, uint32_t width, uint32_t height, EncodeFn&& encode) {
+        const uint32_t blocksX = (width + 3) / 4;
+        const uint32_t blocksY = (height + 3) / 4;
+        std::vector<unsigned char> out(size_t(blocksX) * blocksY * BlockBytes);
+        for (uint32_t by = 0; by < blocksY; ++by) {
+            for (uint32_t bx = 0; bx < blocksX; ++bx) {
+                encode(fetchBlock(rgba, width, height, bx, by), &out[(size_t(by) * blocksX + bx) * BlockBytes]);
+            }
+        }
+        return out;
+    }
+}
+
+namespace BCEncoder {
+    std::vector<unsigned char> encodeBC1(const unsigned char* rgba, uint32_t width, uint32_t height) {
+        return encodeImage<8>(rgba, width, height, [](const Block& block, unsigned char* out) {
+            encodeColorBlock(block, out);
+        });
+    }
+
+    std::vector<unsigned char> encodeBC3(const unsigned char* rgba, uint32_t width, uint32_t height) {
+        return encodeImage<16>(rgba, width, height, [](const Block& block, unsigned char* out) {
+            encodeChannelBlock(block, 3, out);
+            encodeColorBlock(block, out + 8);
+        });
+    }
+
+    std::vector<unsigned char> encodeBC4(const unsigned char* rgba, uint32_t width, uint32_t height, int channel) {
+        return encodeImage<8>(rgba, width, height, [channel](const Block& block, unsigned char* out) {
+            encodeChannelBlock(block, channel, out);
+        });
+    }
+
+    std::vector<unsigned char> encodeBC5(const unsigned char* rgba, uint32_t width, uint32_t height,
+                                         int channelX, int channelY) {
+        return encodeImage<16>(rgba, width, height, [channelX, channelY](const Block& block, unsigned char* out) {
+            encodeChannelBlock(block, channelX, out);
+            encodeChannelBlock(block, channelY, out + 8);
+        });
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Fast CPU block compressors for the cooker. Input is tightly packed RGBA8; edge blocks of images
+// that are not a multiple of 4 replicate the last row/column. Output is the raw block stream,
+// row-major, as Vulkan expects it for the matching VK_FORMAT_BC*_BLOCK format.
+namespace BCEncoder {
+    // RGB endpoints with a bounding-box fit (alpha is dropped)
+    std::vector<unsigned char> encodeBC1(const unsigned char* rgba, uint32_t width, uint32_t height);
+
+    // BC1 color plus an 8-level alpha block
+    std::vector<unsigned char> encodeBC3(const unsigned char* rgba, uint32_t width, uint32_t height);
+
+    // One channel of the input, 0 = R ... 3 = A
+    std::vector<unsigned char> encodeBC4(const unsigned char* rgba, uint32_t width, uint32_t height, int channel);
+
+    // Two channels of the input, stored as the R and G of the compressed texture
+    std::vector<unsigned char> encodeBC5(const unsigned char* rgba, uint32_t width, uint32_t height,
+                                         int channelX, int channelY);
+}
@@ -0,0 +1,306 @@
+// Offline cook step: glTF -> versioned, memory-mappable .slmscene (see cooked_scene_format.h).
+// Usage: SalamanderCooker <input.gltf> <output.slmscene> [--no-compression]
+#include "bc_encoder.h"
+#include "loaders/cooked_scene_format.h"
+#include "loaders/gltf_loader.h"
+#include "shared/scene_data.h"
+#include "thread_pool.h"
+
+#include "stb_image.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+
+namespace {
+    enum class TextureRole {
+        Unused,
+        BaseColor,
+        Normal,
+        MetallicRoughness
+    };
+
+    struct CookedTexture {
+        CookedSceneFormat::TextureRecord record{};
+        std::vector<unsigned char> payload;
+    };
+
+    const std::array<float, 256>& srgbToLinearTable() {
+        static const std::array<float, 256> table = [] {
+            std::array<float, 256> values{};
+            for (int i = 0; i < 256; ++i) {
+                const float c = static_cast<float>(i) / 255.0f;
+                values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            return values;
+        }();
+        return table;
+    }
+
+    unsigned char linearToSrgb(float linear) {
+        const float c = linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+        return static_cast<unsigned char>(std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+    }
+
+    // 2x2 box filter; odd edges reuse the last row/column. sRGB color channels are averaged in linear space.
+    std::vector<unsigned char> downsample(const unsigned char* src, uint32_t width, uint32_t height, bool srgb) {
+        const uint32_t dstWidth = std::max(width / 2, 1u);
+        const uint32_t dstHeight = std::max(height / 2, 1u);
+        const auto& toLinear = srgbToLinearTable();
+
+        std::vector<unsigned char> dst(size_t(dstWidth) * dstHeight * 4);
+        for (uint32_t y = 0; y < dstHeight; ++y) {
+            const uint32_t y0 = std::min(y * 2, height - 1);
+            const uint32_t y1 = std::min(y * 2 + 1, height - 1);
+            for (uint32_t x = 0; x < dstWidth; ++x) {
+                const uint32_t x0 = std::min(x * 2, width - 1);
+                const uint32_t x1 = std::min(x * 2 + 1, width - 1);
+                const unsigned char* taps[4] = {
+                    src + (size_t(y0) * width + x0) * 4, src + (size_t(y0) * width + x1) * 4,
+                    src + (size_t(y1) * width + x0) * 4, src + (size_t(y1) * width + x1) * 4
+                };
+
+                unsigned char* out = dst.data() + (size_t(y) * dstWidth + x) * 4;
+                for (int c = 0; c < 4; ++c) {
+                    if (srgb && c < 3) {
+                        const float sum = toLinear[taps[0][c]] + toLinear[taps[1][c]] + toLinear[taps[2][c]] + toLinear[taps[3][c]];
+                        out[c] = linearToSrgb(sum * 0.25f);
+                    } else {
+                        const int sum = taps[0][c] + taps[1][c] + taps[2][c] + taps[3][c];
+                        out[c] = static_cast<unsigned char>((sum + 2) / 4);
+                    }
+                }
+            }
+        }
+        return dst;
+    }
+
+    struct Level {
+        std::vector<unsigned char> rgba;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    // Format, payload encoder and view swizzle per role. Compressed:
+    //   base color -> BC1 (BC3 when any texel is not opaque, the G-buffer pass alpha-tests it)
+    //   normal     -> BC5 holding XY, Z is rebuilt in gbuffer.frag
+    //   metal-rough-> BC5 holding the G/B channels, swizzled back into .g/.b by the view
+    void encodeLevels(const std::vector<Level>& levels, TextureRole role, bool compress, CookedTexture& cooked) {
+        uint8_t swizzle[4] = { VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY,
+                               VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY };
+        std::vector<unsigned char> (*encode)(const Level&) = nullptr;
+
+        if (!compress) {
+            cooked.record.format = role == TextureRole::BaseColor ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+            encode = [](const Level& level) { return level.rgba; };
+        } else if (role == TextureRole::BaseColor) {
+            const auto& top = levels.front().rgba;
+            bool opaque = true;
+            for (size_t i = 3; i < top.size() && opaque; i += 4) {
+                opaque = top[i] == 255;
+            }
+            cooked.record.format = opaque ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC3_SRGB_BLOCK;
+            encode = opaque
+                ? +[](const Level& level) { return BCEncoder::encodeBC1(level.rgba.data(), level.width, level.height); }
+                : +[](const Level& level) { return BCEncoder::encodeBC3(level.rgba.data(), level.width, level.height); };
+        } else if (role == TextureRole::Normal) {
+            cooked.record.format = VK_FORMAT_BC5_UNORM_BLOCK;
+            encode = [](const Level& level) { return BCEncoder::encodeBC5(level.rgba.data(), level.width, level.height, 0, 1); };
+        } else {
+            cooked.record.format = VK_FORMAT_BC5_UNORM_BLOCK;
+            encode = [](const Level& level) { return BCEncoder::encodeBC5(level.rgba.data(), level.width, level.height, 1, 2); };
+            swizzle[0] = VK_COMPONENT_SWIZZLE_ZERO;
+            swizzle[1] = VK_COMPONENT_SWIZZLE_R;
+            swizzle[2] = VK_COMPONENT_SWIZZLE_G;
+            swizzle[3] = VK_COMPONENT_SWIZZLE_ONE;
+        }
+
+        std::copy(std::begin(swizzle), std::end(swizzle), cooked.record.swizzle);
+        for (const auto& level : levels) {
+            std::vector<unsigned char> encoded = encode(level);
+            cooked.payload.insert(cooked.payload.end(), encoded.begin(), encoded.end());
+        }
+    }
+
+    CookedTexture cookTexture(const GLTFTexture& texture, const std::filesystem::path& baseDir, TextureRole role, bool compress) {
+        int width, height, channels;
+        stbi_uc* pixels = texture.encodedData.empty()
+            ? stbi_load((baseDir / texture.uri).string().c_str(), &width, &height, &channels, STBI_rgb_alpha)
+            : stbi_load_from_memory(texture.encodedData.data(), static_cast<int>(texture.encodedData.size()),
+                                    &width, &height, &channels, STBI_rgb_alpha);
+        if (!pixels) {
+            throw std::runtime_error("Failed to decode texture " + texture.uri);
+        }
+
+        std::vector<Level> levels;
+        levels.push_back({ std::vector<unsigned char>(pixels, pixels + size_t(width) * height * 4),
+                           static_cast<uint32_t>(width), static_cast<uint32_t>(height) });
+        stbi_image_free(pixels);
+
+        const bool srgb = role == TextureRole::BaseColor;
+        while (levels.back().width > 1 || levels.back().height > 1) {
+            const Level& previous = levels.back();
+            Level next{ downsample(previous.rgba.data(), previous.width, previous.height, srgb),
+                        std::max(previous.width / 2, 1u), std::max(previous.height / 2, 1u) };
+            levels.push_back(std::move(next));
+        }
+
+        CookedTexture cooked;
+        cooked.record.width = levels.front().width;
+        cooked.record.height = levels.front().height;
+        cooked.record.mipLevels = static_cast<uint32_t>(levels.size());
+        encodeLevels(levels, role, compress, cooked);
+        cooked.record.dataSize = cooked.payload.size();
+        return cooked;
+    }
+
+    // The first role that references a texture wins
+    std::vector<TextureRole> textureRoles(const GLTFModel& model) {
+        std::vector<TextureRole> roles(model.textures.size(), TextureRole::Unused);
+        auto assign = [&roles](int index, TextureRole role) {
+            if (index >= 0 && static_cast<size_t>(index) < roles.size() && roles[index] == TextureRole::Unused) {
+                roles[index] = role;
+            }
+        };
+        for (const auto& material : model.materials) {
+            assign(material.baseColorTexture, TextureRole::BaseColor);
+            assign(material.normalTexture, TextureRole::Normal);
+            assign(material.metallicRoughnessTexture, TextureRole::MetallicRoughness);
+        }
+        return roles;
+    }
+
+    class SceneWriter {
+    public:
+        explicit SceneWriter(const std::filesystem::path& path) : m_out(path, std::ios::binary | std::ios::trunc) {
+            if (!m_out) {
+                throw std::runtime_error("Failed to open " + path.string() + " for writing");
+            }
+            // Header is written last, once every offset is known
+            CookedSceneFormat::Header placeholder{};
+            write(&placeholder, sizeof(placeholder));
+        }
+
+        template<typename T>
+        CookedSceneFormat::Section writeSection(const std::vector<T>& items) {
+            const uint64_t offset = align();
+            write(items.data(), items.size() * sizeof(T));
+            return { offset, items.size() };
+        }
+
+        uint64_t writeBlob(const std::vector<unsigned char>& bytes) {
+            const uint64_t offset = align();
+            write(bytes.data(), bytes.size());
+            return offset;
+        }
+
+        void finish(const CookedSceneFormat::Header& header) {
+            m_out.seekp(0);
+            m_out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            m_out.flush();
+            if (!m_out) {
+                throw std::runtime_error("Failed to write cooked scene");
+            }
+        }
+
+    private:
+        void write(const void* data, size_t size) {
+            m_out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            m_position += size;
+        }
+
+        uint64_t align() {
+            static constexpr char zeros[CookedSceneFormat::SECTION_ALIGNMENT] = {};
+            const uint64_t aligned = CookedSceneFormat::alignUp(m_position);
+            write(zeros, static_cast<size_t>(aligned - m_position));
+            return aligned;
+        }
+
+        std::ofstream m_out;
+        uint64_t m_position = 0;
+    };
+}
+
+int main(int argc, char** argv) {
+    const bool compress = !(argc == 4 && std::string_view(argv[3]) == "--no-compression");
+    if (argc != 3 && compress) {
+        std::cerr << "Usage: " << argv[0] << " <input.gltf> <output.slmscene> [--no-compression]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try {
+        const auto start = std::chrono::steady_clock::now();
+        const std::filesystem::path inputPath = argv[1];
+        const std::filesystem::path outputPath = argv[2];
+
+        GLTFModel model;
+        if (!GLTFLoader::LoadFromFile(inputPath.string(), model)) {
+            throw std::runtime_error("Failed to load " + inputPath.string());
+        }
+
+        // Decode and mip every referenced texture in parallel, keeping the glTF texture order
+        const std::vector<TextureRole> roles = textureRoles(model);
+        std::vector<std::future<CookedTexture>> jobs(model.textures.size());
+        {
+            ThreadPool pool;
+            const std::filesystem::path baseDir = inputPath.parent_path();
+            for (size_t i = 0; i < model.textures.size(); ++i) {
+                if (roles[i] == TextureRole::Unused) {
+                    continue;
+                }
+                jobs[i] = pool.submit([&model, &baseDir, &roles, i, compress]() {
+                    return cookTexture(model.textures[i], baseDir, roles[i], compress);
+                });
+            }
+        }
+
+        std::filesystem::create_directories(outputPath.parent_path());
+        SceneWriter writer(outputPath);
+
+        CookedSceneFormat::Header header{};
+        header.magic = CookedSceneFormat::MAGIC;
+        header.version = CookedSceneFormat::VERSION;
+        header.vertexStride = sizeof(Vertex);
+        header.primitiveStride = sizeof(GLTFPrimitive);
+        header.materialStride = sizeof(GLTFMaterial);
+        header.modelScale[0] = globalScale.x;
+        header.modelScale[1] = globalScale.y;
+        header.modelScale[2] = globalScale.z;
+        header.vertices = writer.writeSection(model.vertices);
+        header.indices = writer.writeSection(model.indices);
+        header.primitives = writer.writeSection(model.primitives);
+        header.materials = writer.writeSection(model.materials);
+
+        std::vector<CookedSceneFormat::TextureRecord> records(model.textures.size());
+        uint64_t payloadBytes = 0;
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            if (!jobs[i].valid()) {
+                continue;
+            }
+            CookedTexture cooked = jobs[i].get();
+            cooked.record.dataOffset = writer.writeBlob(cooked.payload);
+            records[i] = cooked.record;
+            payloadBytes += cooked.payload.size();
+        }
+        header.textures = writer.writeSection(records);
+        writer.finish(header);
+
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Cooked " << inputPath.filename().string() << " -> " << outputPath.string() << ": "
+                  << model.vertices.size() << " vertices, " << model.primitives.size() << " primitives, "
+                  << model.textures.size() << " textures (" << payloadBytes / (1024 * 1024) << " MiB) in "
+                  << seconds << " s" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -38,7 +38,7 @@ void ImGuiDescriptorManager::createDescriptorPool() {
         throw std::runtime_error("Failed to create ImGui descriptor pool");
     }
 
-    DeletionQueue::get().pushFunction("ImGuiDescriptorPool", [device = m_device, pool = m_pool]() {
+    DeletionQueue::get().push([device = m_device, pool = m_pool]() {
         ImGui_ImplVulkan_Shutdown();
         ImGui_ImplGlfw_Shutdown();
         ImGui::DestroyContext();
@@ -21,8 +21,7 @@ MainDescriptorManager::MainDescriptorManager(
         throw std::runtime_error("Failed to create descriptor pool");
     }
 
-    static int poolIndex = 0;
-    DeletionQueue::get().pushFunction("DescriptorPool_" + std::to_string(poolIndex++), [device, pool = m_pool]() {
+    DeletionQueue::get().push([device, pool = m_pool]() {
         vkDestroyDescriptorPool(device, pool, nullptr);
     });
 
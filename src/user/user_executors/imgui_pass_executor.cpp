@@ -2,6 +2,11 @@
 #include <imgui_impl_vulkan.h>
 #include <imgui_impl_glfw.h>
 #include <array>
+#include <algorithm>
+#include <thread>
+#include "profiling/gpu_profiler.h"
+#include "shared/render_settings.h"
+#include "lighting/light_clusterer.h"
 
 ImGuiPassExecutor::ImGuiPassExecutor(Resources resources)
     : m_resources(std::move(resources))
@@ -60,6 +65,11 @@ void ImGuiPassExecutor::execute(VkCommandBuffer cmd)
     // Optionally show frame time
     ImGui::Text("Frame Time: %.3f ms/frame", 1000.0f / io.Framerate);
 
+    drawGpuTimings();
+    drawDepthPrepassStats();
+    drawLightSettings();
+    drawFrameGraphStats();
+
     ImGui::End();
 
     // Render ImGui
@@ -69,6 +79,170 @@ void ImGuiPassExecutor::execute(VkCommandBuffer cmd)
     }
 }
 
+void ImGuiPassExecutor::drawGpuTimings() const
+{
+    const GpuProfiler* profiler = m_resources.profiler;
+    if (!profiler || !profiler->enabled()) {
+        ImGui::TextDisabled("GPU timestamps not supported");
+        return;
+    }
+
+    const auto& scopes = profiler->scopeStats();
+    const auto& frame = profiler->frameStats();
+
+    ImGui::Separator();
+    ImGui::Text("GPU Frame: %.3f ms (avg %.3f, min %.3f, max %.3f)",
+                frame.lastMs, frame.avgMs, frame.minMs, frame.maxMs);
+
+    if (ImGui::BeginTable("GpuPasses", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+        ImGui::TableSetupColumn("Pass");
+        ImGui::TableSetupColumn("Last");
+        ImGui::TableSetupColumn("Avg");
+        ImGui::TableSetupColumn("Min");
+        ImGui::TableSetupColumn("Max");
+        ImGui::TableHeadersRow();
+        for (const auto& scope : scopes) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(scope.name.c_str());
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", scope.lastMs);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", scope.avgMs);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", scope.minMs);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", scope.maxMs);
+        }
+        ImGui::EndTable();
+    }
+
+    // Stacked bar of the averaged pass times, scaled to the averaged GPU frame time
+    const float width = ImGui::GetContentRegionAvail().x;
+    const float height = ImGui::GetTextLineHeight();
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    const double total = std::max(frame.avgMs, 1e-6);
+
+    drawList->AddRectFilled(origin, ImVec2(origin.x + width, origin.y + height), IM_COL32(40, 40, 40, 255));
+    float x = origin.x;
+    for (size_t i = 0; i < scopes.size(); ++i) {
+        const float segment = width * static_cast<float>(scopes[i].avgMs / total);
+        const ImU32 color = ImColor::HSV(static_cast<float>(i) / static_cast<float>(scopes.size()), 0.6f, 0.9f);
+        drawList->AddRectFilled(ImVec2(x, origin.y), ImVec2(std::min(x + segment, origin.x + width), origin.y + height), color);
+        x += segment;
+    }
+    ImGui::Dummy(ImVec2(width, height));
+
+    // Legend
+    for (size_t i = 0; i < scopes.size(); ++i) {
+        const ImVec4 color = ImColor::HSV(static_cast<float>(i) / static_cast<float>(scopes.size()), 0.6f, 0.9f);
+        ImGui::ColorButton(scopes[i].name.c_str(), color, ImGuiColorEditFlags_NoTooltip, ImVec2(height, height));
+        ImGui::SameLine();
+        ImGui::Text("%s %.0f%%", scopes[i].name.c_str(), 100.0 * scopes[i].avgMs / total);
+    }
+}
+
+void ImGuiPassExecutor::drawDepthPrepassStats()
+{
+    ImGui::Separator();
+    ImGui::Checkbox("Depth prepass", &renderSettings.depthPrepass);
+    // Only CPU-culled passes are split across threads; 0 uses the whole pool
+    int recordingThreads = static_cast<int>(renderSettings.recordingThreads);
+    if (ImGui::SliderInt("Recording threads", &recordingThreads, 0, static_cast<int>(std::thread::hardware_concurrency()))) {
+        renderSettings.recordingThreads = static_cast<uint32_t>(recordingThreads);
+    }
+
+    const GpuProfiler* profiler = m_resources.profiler;
+    if (!profiler || !profiler->statisticsEnabled()) {
+        ImGui::TextDisabled("Pipeline statistics not supported");
+        return;
+    }
+
+    // Fragment shader invocations per pixel of the G-buffer pass; 1.0 means every pixel is shaded once
+    const double pixels = static_cast<double>(m_resources.extent.width) * m_resources.extent.height;
+    auto& current = m_prepassMeasurements[renderSettings.depthPrepass ? 1 : 0];
+    current.valid = true;
+    current.overdraw = static_cast<double>(profiler->fragmentInvocations()) / std::max(pixels, 1.0);
+    current.gBufferMs = 0.0;
+    for (const auto& scope : profiler->scopeStats()) {
+        if (scope.name == "GBufferPass") {
+            current.gBufferMs = scope.avgMs;
+        }
+    }
+
+    if (ImGui::BeginTable("PrepassComparison", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+        ImGui::TableSetupColumn("G-buffer");
+        ImGui::TableSetupColumn("Overdraw");
+        ImGui::TableSetupColumn("Avg ms");
+        ImGui::TableHeadersRow();
+        static constexpr std::array<const char*, 2> labels = { "Prepass off", "Prepass on" };
+        for (size_t i = 0; i < m_prepassMeasurements.size(); ++i) {
+            const auto& measurement = m_prepassMeasurements[i];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(labels[i]);
+            if (!measurement.valid) {
+                ImGui::TableNextColumn(); ImGui::TextDisabled("-");
+                ImGui::TableNextColumn(); ImGui::TextDisabled("-");
+                continue;
+            }
+            ImGui::TableNextColumn(); ImGui::Text("%.2fx", measurement.overdraw);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", measurement.gBufferMs);
+        }
+        ImGui::EndTable();
+    }
+}
+
+void ImGuiPassExecutor::drawLightSettings()
+{
+    ImGui::Separator();
+    int stressLights = static_cast<int>(renderSettings.stressLights);
+    if (ImGui::SliderInt("Stress lights", &stressLights, 0, static_cast<int>(LightClusterer::MAX_LIGHTS) - 1)) {
+        renderSettings.stressLights = static_cast<uint32_t>(stressLights);
+    }
+    // The lighting pass falls back to the fragment path when the device cannot run the compute one
+    const bool computeLighting = renderSettings.computeLighting && m_resources.computeLightingSupported;
+    if (m_resources.computeLightingSupported) {
+        ImGui::Checkbox("Compute lighting", &renderSettings.computeLighting);
+    } else {
+        bool unavailable = false;
+        ImGui::BeginDisabled();
+        ImGui::Checkbox("Compute lighting", &unavailable);
+        ImGui::EndDisabled();
+        ImGui::SameLine();
+        ImGui::TextDisabled("(unsupported on this device)");
+    }
+    ImGui::SliderFloat("Cascade split lambda", &renderSettings.shadowSplitLambda, 0.0f, 1.0f);
+    ImGui::Checkbox("Shadow caching", &renderSettings.shadowCaching);
+
+    const GpuProfiler* profiler = m_resources.profiler;
+    if (!profiler || !profiler->enabled()) {
+        return;
+    }
+
+    // Last averaged LightingPass time of each path, so both can be compared on the same view
+    for (const auto& scope : profiler->scopeStats()) {
+        if (scope.name == "LightingPass") {
+            m_lightingMs[computeLighting ? 1 : 0] = scope.avgMs;
+        }
+    }
+    ImGui::Text("LightingPass avg ms: fragment %.3f, compute %.3f", m_lightingMs[0], m_lightingMs[1]);
+}
+
+void ImGuiPassExecutor::drawFrameGraphStats() const
+{
+    const GpuProfiler* profiler = m_resources.profiler;
+    if (!profiler) {
+        return;
+    }
+
+    const auto& stats = profiler->frameGraphStats();
+    constexpr double MiB = 1024.0 * 1024.0;
+    ImGui::Separator();
+    ImGui::Text("Frame graph: %u/%u passes (%u culled)", stats.passes - stats.culledPasses, stats.passes, stats.culledPasses);
+    ImGui::Text("Barriers: %u images in %u batches", stats.imageBarriers, stats.barrierBatches);
+    // Versus one allocation per attachment and frame in flight
+    ImGui::Text("Attachments: %.1f MiB (%.1f MiB unaliased, %.1f MiB saved)",
+                static_cast<double>(stats.allocatedBytes) / MiB,
+                static_cast<double>(stats.separateBytes) / MiB,
+                static_cast<double>(stats.separateBytes - std::min(stats.allocatedBytes, stats.separateBytes)) / MiB);
+}
+
 void ImGuiPassExecutor::end(VkCommandBuffer cmd)
 {
     vkCmdEndRendering(cmd);
@@ -5,6 +5,8 @@
 #include <imgui.h>
 #include <vector>
 
+class GpuProfiler;
+
 class ImGuiPassExecutor : public RenderPassExecutor {
 public:
     struct Resources {
@@ -12,6 +14,8 @@ public:
         std::vector<VkImageView>    swapchainImageViews;
         std::array<VkImageView, MAX_FRAMES_IN_FLIGHT> depthImageViews;
         uint32_t*                       currentFrame;
+        const GpuProfiler*              profiler;
+        bool                            computeLightingSupported;
     };
 
 
@@ -26,5 +30,20 @@ public:
     void end(VkCommandBuffer cmd) override;
 
 private:
+    void drawGpuTimings() const;
+    void drawDepthPrepassStats();
+    void drawLightSettings();
+    void drawFrameGraphStats() const;
+
+    // Last G-buffer measurement with the depth prepass off [0] and on [1]
+    struct PrepassMeasurement {
+        bool valid = false;
+        double overdraw = 0.0;
+        double gBufferMs = 0.0;
+    };
+
     Resources m_resources;
+    std::array<PrepassMeasurement, 2> m_prepassMeasurements{};
+    // Averaged LightingPass time of the fragment [0] and compute [1] paths
+    std::array<double, 2> m_lightingMs{};
 };
\ No newline at end of file
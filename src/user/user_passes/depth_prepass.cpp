@@ -2,9 +2,11 @@
 
 #include "config.h"
 #include "depth_format.h"
-#include "image_transition_manager.h"
 #include "pipeline.h"
+#include "parallel_recorder.h"
+#include "pipeline_build_queue.h"
 #include "descriptors/descriptor_set_layout_builder.h"
+#include "shared/render_settings.h"
 #include "shared/scene_data.h"
 
 #ifdef USE_TINYGLTF
@@ -19,7 +21,7 @@ void DepthPrepass::initialize(const RenderTarget::SharedResources& shared,
     m_dependencies = &dependencies;
     
     createDescriptors();
-    createPipeline();
+    m_shared->pipelineBuilds->enqueue([this]() { createPipeline(); });
 }
 
 void DepthPrepass::cleanup() {
@@ -29,32 +31,42 @@ void DepthPrepass::cleanup() {
 }
 
 void DepthPrepass::recreateSwapChain() {
-    for (auto& layout : m_dependencies->depthLayouts) {
-        layout = VK_IMAGE_LAYOUT_UNDEFINED;
-    }
 }
 
-void DepthPrepass::execute(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t imageIndex) {
-
-    // Transition per-frame depth image to initial layout
-    ImageTransitionManager::transitionDepthAttachment(
-        cmd,
-        m_dependencies->perFrameDepthTextures[frameIndex]->image,
-        m_dependencies->depthLayouts[*m_shared->currentFrame],
-        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
-    );
+void DepthPrepass::declare(FrameGraph::PassBuilder& builder, uint32_t frameIndex) {
+    // Always cleared here, even with the prepass disabled
+    builder.write(m_dependencies->depth, FrameGraph::Usage::DepthAttachment, true);
+}
 
+void DepthPrepass::execute(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t imageIndex) {
     VkRenderingAttachmentInfo depthAttachment = {
         .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
-        .imageView = m_dependencies->perFrameDepthTextures[frameIndex]->view,
+        .imageView = m_dependencies->depthTextures[frameIndex]->view,
         .imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
         .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
         .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
         .clearValue = {.depthStencil = {1.0f, 0}}
     };
 
+    // With the prepass disabled only the clear remains and the G-buffer pass resolves visibility itself.
+    // Long CPU-culled draw lists are recorded in chunks on the workers while the primary carries on.
+    const std::vector<uint32_t>& visible = m_globalData->cameraVisiblePrimitives;
+    const auto drawCount = static_cast<uint32_t>(visible.size());
+    const bool parallel = renderSettings.depthPrepass && !m_globalData->gpuCulling &&
+                          m_shared->recorder->chunkCount(drawCount) > 1;
+    ParallelRecorder::Batch batch;
+    if (parallel) {
+        const ParallelRecorder::RenderingFormats formats{ .depth = m_shared->depthFormat };
+        batch = m_shared->recorder->record(frameIndex, formats, 0, drawCount,
+            [this, frameIndex, &visible](VkCommandBuffer secondary, uint32_t begin, uint32_t end) {
+                bindDrawState(secondary, frameIndex);
+                m_globalData->drawPrimitives(secondary, visible, begin, end);
+            });
+    }
+
     VkRenderingInfo renderInfo = {
         .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+        .flags = parallel ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : 0u,
         .renderArea = {{0, 0}, m_shared->swapChain->extent()},
         .layerCount = 1,
         .colorAttachmentCount = 0,
@@ -62,6 +74,18 @@ void DepthPrepass::execute(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t im
     };
     
     vkCmdBeginRendering(cmd, &renderInfo);
+    if (parallel) {
+        m_shared->recorder->execute(cmd, batch);
+    } else {
+        bindDrawState(cmd, frameIndex);
+        if (renderSettings.depthPrepass) {
+            m_globalData->drawVisible(cmd, m_globalData->cameraDrawLists[frameIndex], visible);
+        }
+    }
+    vkCmdEndRendering(cmd);
+}
+
+void DepthPrepass::bindDrawState(VkCommandBuffer cmd, uint32_t frameIndex) const {
     vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline->handle());
     
     // Set dynamic viewport/scissor
@@ -89,86 +113,17 @@ void DepthPrepass::execute(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t im
     // Bind index buffer
     vkCmdBindIndexBuffer(cmd, m_globalData->indexBuffer.handle(), 0, VK_INDEX_TYPE_UINT32);
     
-    // Draw all primitives
-    for (const auto& primitive : m_globalData->primitives) {
-        PushConstants pc = {
-            .vertexBufferAddress = m_globalData->vertexBufferAddress,
-            .baseColorTextureIndex = primitive.materialIndex,
-            .metalRoughTextureIndex = primitive.metalRoughTextureIndex,
-            .normalTextureIndex = primitive.normalTextureIndex,
-            .textureCount = static_cast<uint32_t>(m_globalData->modelTextures.size()),
-            .modelScale = globalScale
-        };
-        vkCmdPushConstants(
-            cmd, m_pipeline->layout(), 
-            VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstants), &pc
-        );
-        vkCmdDrawIndexed(
-            cmd, primitive.indexCount, 1, 
-            primitive.indexOffset, 0, 0
-        );
-    }
-    
-    vkCmdEndRendering(cmd);
-
-    // Update layout tracking
-    m_dependencies->depthLayouts[frameIndex] = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-    ImageTransitionManager::transitionDepthAttachment(
-           cmd,
-           m_dependencies->perFrameDepthTextures[frameIndex]->image,
-           VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-           VK_IMAGE_LAYOUT_GENERAL
-       );
-
-    m_dependencies->depthLayouts[frameIndex] = VK_IMAGE_LAYOUT_GENERAL;
-
-    // Transition the destination to TRANSFER_DST_OPTIMAL
-    ImageTransitionManager::transitionDepthAttachment(
-        cmd,
-        m_dependencies->depthTextures[frameIndex]->image,
-        VK_IMAGE_LAYOUT_UNDEFINED,  // First use in this frame
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
-    );
-
-    // Copy depth from framebuffer depth to our sampling depth texture
-    VkImageCopy copyRegion{};
-    copyRegion.srcSubresource.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-    copyRegion.srcSubresource.mipLevel = 0;
-    copyRegion.srcSubresource.baseArrayLayer = 0;
-    copyRegion.srcSubresource.layerCount = 1;
-    copyRegion.dstSubresource.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-    copyRegion.dstSubresource.mipLevel = 0;
-    copyRegion.dstSubresource.baseArrayLayer = 0;
-    copyRegion.dstSubresource.layerCount = 1;
-    copyRegion.extent = {m_shared->swapChain->extent().width, m_shared->swapChain->extent().height, 1};
-
-    vkCmdCopyImage(
-        cmd,
-        m_dependencies->perFrameDepthTextures[frameIndex]->image,
-        VK_IMAGE_LAYOUT_GENERAL,  // GENERAL layout supports transfer source operations
-        m_dependencies->depthTextures[frameIndex]->image,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        1,
-        &copyRegion
-    );
-
-    // Transition the depth texture to shader read-only optimal for sampling
-    ImageTransitionManager::transitionDepthAttachment(
-        cmd,
-        m_dependencies->depthTextures[frameIndex]->image,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
+    // Material indices come from the primitive buffer, so one push covers every draw
+    PushConstants pc = {
+        .vertexBufferAddress = m_globalData->vertexBufferAddress,
+        .primitiveBufferAddress = m_globalData->primitiveBufferAddress,
+        .textureCount = static_cast<uint32_t>(m_globalData->modelTextures.size()),
+        .modelScale = globalScale
+    };
+    vkCmdPushConstants(
+        cmd, m_pipeline->layout(),
+        VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstants), &pc
     );
-
-    ImageTransitionManager::transitionDepthAttachment(
-       cmd,
-       m_dependencies->perFrameDepthTextures[frameIndex]->image,
-       VK_IMAGE_LAYOUT_GENERAL,
-       VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
-   );
-    m_dependencies->depthLayouts[frameIndex] = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
-
 }
 
 void DepthPrepass::createPipeline() {
@@ -12,10 +12,13 @@ public:
     void cleanup() override;
     void recreateSwapChain() override;
     void execute(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t imageIndex) override;
+    void declare(FrameGraph::PassBuilder& builder, uint32_t frameIndex) override;
 
 private:
     void createPipeline();
     void createDescriptors();
+    // Everything the draws need, recorded into the primary or into each parallel secondary
+    void bindDrawState(VkCommandBuffer cmd, uint32_t frameIndex) const;
 
     // Resources
     const RenderTarget::SharedResources* m_shared = nullptr;
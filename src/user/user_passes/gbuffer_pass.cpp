@@ -2,8 +2,12 @@
 
 #include "config.h"
 #include "pipeline.h"
+#include "parallel_recorder.h"
+#include "pipeline_build_queue.h"
 #include "descriptors/descriptor_set_layout_builder.h"
-#include "image_transition_manager.h"
+#include "gbuffer_formats.h"
+#include "profiling/gpu_profiler.h"
+#include "shared/render_settings.h"
 #include "shared/scene_data.h"
 #include "target/render_target.h"
 
@@ -18,39 +22,41 @@ void GBufferPass::initialize(const RenderTarget::SharedResources& shared,
     m_globalData = &globalData;
     m_dependencies = &dependencies;
     
-    createAttachments();
+    registerAttachments();
     createDescriptors();
-    createPipeline();
+    createPipelines();
 }
 
 void GBufferPass::cleanup() {
     m_pipeline.reset();
+    m_depthWritePipeline.reset();
     m_descriptorManager.reset();
     m_descriptorLayout.reset();
-    // Textures cleaned up by texture manager
+    // Attachments are owned by the frame graph
 }
 
 void GBufferPass::recreateSwapChain() {
-    createAttachments();
+}
+
+void GBufferPass::declare(FrameGraph::PassBuilder& builder, uint32_t frameIndex) {
+    builder.write(m_dependencies->albedo, FrameGraph::Usage::ColorAttachment, true);
+    builder.write(m_dependencies->normal, FrameGraph::Usage::ColorAttachment, true);
+    builder.write(m_dependencies->params, FrameGraph::Usage::ColorAttachment, true);
+    if (renderSettings.depthPrepass) {
+        builder.read(m_dependencies->depth, FrameGraph::Usage::DepthReadOnly);
+    } else {
+        builder.write(m_dependencies->depth, FrameGraph::Usage::DepthAttachment, false);
+    }
 }
 
 void GBufferPass::execute(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t imageIndex) {
-    // Transition attachments
-    ImageTransitionManager::transitionColorAttachment(
-        cmd, m_albedoTextures[frameIndex].image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
-    );
-    ImageTransitionManager::transitionColorAttachment(
-        cmd, m_normalTextures[frameIndex].image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
-    );
-    ImageTransitionManager::transitionColorAttachment(
-        cmd, m_paramTextures[frameIndex].image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
-    );
-    
+    const FrameGraph& graph = *m_dependencies->frameGraph;
+
     // Set up attachments
     std::array<VkRenderingAttachmentInfo, 3> colorAttachments = {{
         {
             .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR,
-            .imageView = m_albedoTextures[frameIndex].view,
+            .imageView = graph.texture(m_dependencies->albedo).view,
             .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
             .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
             .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
@@ -58,7 +64,7 @@ void GBufferPass::execute(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t ima
         },
         {
             .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR,
-            .imageView = m_normalTextures[frameIndex].view,
+            .imageView = graph.texture(m_dependencies->normal).view,
             .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
             .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
             .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
@@ -66,7 +72,7 @@ void GBufferPass::execute(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t ima
         },
         {
             .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR,
-            .imageView = m_paramTextures[frameIndex].view,
+            .imageView = graph.texture(m_dependencies->params).view,
             .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
             .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
             .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
@@ -75,17 +81,50 @@ void GBufferPass::execute(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t ima
     }};
 
 
+    // Shared with the depth prepass; every visible pixel then passes the EQUAL test exactly once.
+    // Without the prepass the attachment must be writable.
+    const bool prepass = renderSettings.depthPrepass;
+    const ManagedTexture& depthTexture = *m_dependencies->depthTextures[frameIndex];
+    const VkImageLayout depthLayout = prepass
+        ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
+        : VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
     VkRenderingAttachmentInfo depthAttachment = {
         .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR,
-        .imageView = m_dependencies->depthTextures[frameIndex]->view,
-        .imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+        .imageView = depthTexture.view,
+        .imageLayout = depthLayout,
         .loadOp = VK_ATTACHMENT_LOAD_OP_LOAD,
         .storeOp = VK_ATTACHMENT_STORE_OP_STORE
     };
 
 
+    // Long CPU-culled draw lists are recorded in chunks on the workers. The overdraw statistics query
+    // is active around this pass, so secondaries inherit it, which needs inheritedQueries.
+    const Pipeline& pipeline = prepass ? *m_pipeline : *m_depthWritePipeline;
+    const std::vector<uint32_t>& visible = m_globalData->cameraVisiblePrimitives;
+    const auto drawCount = static_cast<uint32_t>(visible.size());
+    const VkQueryPipelineStatisticFlags statistics = m_shared->profiler->statisticsEnabled()
+        ? VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT : 0;
+    const bool parallel = !m_globalData->gpuCulling && m_shared->recorder->chunkCount(drawCount) > 1 &&
+                          (statistics == 0 || m_shared->recorder->canRecordInsideQueries());
+    ParallelRecorder::Batch batch;
+    if (parallel) {
+        const GBufferFormats& formats = *m_shared->gBufferFormats;
+        const ParallelRecorder::RenderingFormats renderingFormats{
+            .color = { formats.albedo(), formats.normal(), formats.params() },
+            .colorCount = 3,
+            .depth = m_shared->depthFormat
+        };
+        batch = m_shared->recorder->record(frameIndex, renderingFormats, statistics, drawCount,
+            [this, frameIndex, &pipeline, &visible](VkCommandBuffer secondary, uint32_t begin, uint32_t end) {
+                bindDrawState(secondary, frameIndex, pipeline);
+                m_globalData->drawPrimitives(secondary, visible, begin, end);
+            });
+    }
+
     VkRenderingInfo renderInfo = {
         .sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR,
+        .flags = parallel ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : 0u,
         .renderArea = {{0, 0}, m_shared->swapChain->extent()},
         .layerCount = 1,
         .colorAttachmentCount = static_cast<uint32_t>(colorAttachments.size()),
@@ -94,7 +133,18 @@ void GBufferPass::execute(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t ima
     };
     
     vkCmdBeginRendering(cmd, &renderInfo);
-    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline->handle());
+    if (parallel) {
+        m_shared->recorder->execute(cmd, batch);
+    } else {
+        bindDrawState(cmd, frameIndex, pipeline);
+        // Draw the primitives that survived camera frustum culling
+        m_globalData->drawVisible(cmd, m_globalData->cameraDrawLists[frameIndex], visible);
+    }
+    vkCmdEndRendering(cmd);
+}
+
+void GBufferPass::bindDrawState(VkCommandBuffer cmd, uint32_t frameIndex, const Pipeline& pipeline) const {
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.handle());
     
     // Set dynamic viewport/scissor
     VkViewport viewport = {
@@ -112,7 +162,7 @@ void GBufferPass::execute(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t ima
     vkCmdBindDescriptorSets(
         cmd, 
         VK_PIPELINE_BIND_POINT_GRAPHICS,
-        m_pipeline->layout(),
+        pipeline.layout(),
         0, 1,
         &m_descriptorManager->getDescriptorSets()[frameIndex],
         0, nullptr
@@ -121,52 +171,41 @@ void GBufferPass::execute(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t ima
     // Bind index buffer
     vkCmdBindIndexBuffer(cmd, m_globalData->indexBuffer.handle(), 0, VK_INDEX_TYPE_UINT32);
     
-    // Draw all primitives
-    for (const auto& primitive : m_globalData->primitives) {
-        PushConstants pc = {
-            .vertexBufferAddress = m_globalData->vertexBufferAddress,
-            .baseColorTextureIndex = primitive.materialIndex,
-            .metalRoughTextureIndex = primitive.metalRoughTextureIndex,
-            .normalTextureIndex = primitive.normalTextureIndex,
-            .textureCount = static_cast<uint32_t>(m_globalData->modelTextures.size()),
-            .modelScale = globalScale
-        };
-        vkCmdPushConstants(
-            cmd, m_pipeline->layout(), 
-            VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstants), &pc
-        );
-        vkCmdDrawIndexed(
-            cmd, primitive.indexCount, 1, 
-            primitive.indexOffset, 0, 0
-        );
-    }
-    
-    vkCmdEndRendering(cmd);
-    
-    // Transition attachments to shader read
-    ImageTransitionManager::transitionToShaderRead(
-        cmd, m_albedoTextures[frameIndex].image, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-    );
-    ImageTransitionManager::transitionToShaderRead(
-        cmd, m_normalTextures[frameIndex].image, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-    );
-    ImageTransitionManager::transitionToShaderRead(
-        cmd, m_paramTextures[frameIndex].image, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    // Material indices come from the primitive buffer, so one push covers every draw
+    PushConstants pc = {
+        .vertexBufferAddress = m_globalData->vertexBufferAddress,
+        .primitiveBufferAddress = m_globalData->primitiveBufferAddress,
+        .textureCount = static_cast<uint32_t>(m_globalData->modelTextures.size()),
+        .modelScale = globalScale
+    };
+    vkCmdPushConstants(
+        cmd, pipeline.layout(),
+        VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstants), &pc
     );
+}
 
+void GBufferPass::createPipelines() {
+    // Independent variants, so each is its own build job
+    m_shared->pipelineBuilds->enqueue([this]() {
+        m_pipeline = createPipeline(VK_FALSE, VK_COMPARE_OP_EQUAL);
+    });
+    m_shared->pipelineBuilds->enqueue([this]() {
+        m_depthWritePipeline = createPipeline(VK_TRUE, VK_COMPARE_OP_LESS_OR_EQUAL);
+    });
 }
 
-void GBufferPass::createPipeline() {
+std::unique_ptr<Pipeline> GBufferPass::createPipeline(VkBool32 depthWrite, VkCompareOp depthCompare) const {
     static constexpr std::array<VkDynamicState, 2> dynamicStates = {
         VK_DYNAMIC_STATE_VIEWPORT,
         VK_DYNAMIC_STATE_SCISSOR
     };
     
-    // Attachment formats
+    // Attachment formats, in the order of gbuffer.frag's outputs
+    const GBufferFormats& formats = *m_shared->gBufferFormats;
     std::array<VkFormat, 3> colorFormats = {
-        VK_FORMAT_R8G8B8A8_SRGB,
-        VK_FORMAT_R8G8B8A8_SRGB,
-        VK_FORMAT_R8G8_UNORM
+        formats.albedo(),
+        formats.normal(),
+        formats.params()
     };
     
     VkPipelineRenderingCreateInfo renderingInfo{};
@@ -220,8 +259,8 @@ void GBufferPass::createPipeline() {
     config.depthStencil = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
         .depthTestEnable = VK_TRUE,
-        .depthWriteEnable = VK_FALSE,
-        .depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL,
+        .depthWriteEnable = depthWrite,
+        .depthCompareOp = depthCompare,
         .depthBoundsTestEnable = VK_FALSE,
         .stencilTestEnable = VK_FALSE
     };
@@ -245,70 +284,22 @@ void GBufferPass::createPipeline() {
     
     config.rendering = renderingInfo;
     
-    m_pipeline = std::make_unique<Pipeline>(
+    return std::make_unique<Pipeline>(
         m_shared->context,
         m_descriptorLayout->handle(),
         config
     );
 }
 
-void GBufferPass::createAttachments() {
-    const auto& extent = m_shared->swapChain->extent();
-    VkImageUsageFlags usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | 
-                             VK_IMAGE_USAGE_SAMPLED_BIT | 
-                             VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
-
-    for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-        // Albedo (SRGB)
-        m_albedoTextures[i] = m_shared->textureManager->createTexture(
-            extent.width, extent.height,
-            VK_FORMAT_R8G8B8A8_SRGB,
-            usage,
-            VMA_MEMORY_USAGE_GPU_ONLY,
-            VK_IMAGE_ASPECT_COLOR_BIT,
-            true
-        );
-
-        // Normal (UNORM)
-        m_normalTextures[i] = m_shared->textureManager->createTexture(
-            extent.width, extent.height,
-            VK_FORMAT_R8G8B8A8_SRGB,
-            usage,
-            VMA_MEMORY_USAGE_GPU_ONLY,
-            VK_IMAGE_ASPECT_COLOR_BIT,
-            true
-        );
-
-        // Parameters (RG8)
-        m_paramTextures[i] = m_shared->textureManager->createTexture(
-            extent.width, extent.height,
-            VK_FORMAT_R8G8_UNORM,
-            usage,
-            VMA_MEMORY_USAGE_GPU_ONLY,
-            VK_IMAGE_ASPECT_COLOR_BIT,
-            true
-        );
+void GBufferPass::registerAttachments() {
+    // Sized and allocated by the frame graph; lighting samples them through gBufferSampler
+    const GBufferFormats& formats = *m_shared->gBufferFormats;
+    const VkImageUsageFlags usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
 
-        VkImageUsageFlags depthUsage =
-               VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
-               VK_IMAGE_USAGE_SAMPLED_BIT |
-               VK_IMAGE_USAGE_TRANSFER_DST_BIT;  // Allow for transitions
-
-        m_depthTextures[i] = m_shared->textureManager->createTexture(
-            extent.width, extent.height,
-            VK_FORMAT_D32_SFLOAT,
-            depthUsage,
-            VMA_MEMORY_USAGE_GPU_ONLY,
-            VK_IMAGE_ASPECT_DEPTH_BIT,
-            false
-        );
-
-        // Update dependencies
-        m_dependencies->albedoTextures[i] = &m_albedoTextures[i];
-        m_dependencies->normalTextures[i] = &m_normalTextures[i];
-        m_dependencies->paramTextures[i] = &m_paramTextures[i];
-        m_dependencies->depthTextures[i] = &m_depthTextures[i];
-    }
+    FrameGraph& graph = *m_dependencies->frameGraph;
+    m_dependencies->albedo = graph.createTransient("GBuffer_Albedo", formats.albedo(), usage, VK_IMAGE_ASPECT_COLOR_BIT);
+    m_dependencies->normal = graph.createTransient("GBuffer_Normal", formats.normal(), usage, VK_IMAGE_ASPECT_COLOR_BIT);
+    m_dependencies->params = graph.createTransient("GBuffer_Params", formats.params(), usage, VK_IMAGE_ASPECT_COLOR_BIT);
 }
 
 void GBufferPass::createDescriptors() {
@@ -13,24 +13,23 @@ public:
     void cleanup() override;
     void recreateSwapChain() override;
     void execute(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t imageIndex) override;
+    void declare(FrameGraph::PassBuilder& builder, uint32_t frameIndex) override;
 
 private:
-    void createPipeline();
-    void createAttachments();
+    void createPipelines();
+    std::unique_ptr<Pipeline> createPipeline(VkBool32 depthWrite, VkCompareOp depthCompare) const;
+    void registerAttachments();
     void createDescriptors();
+    // Everything the draws need, recorded into the primary or into each parallel secondary
+    void bindDrawState(VkCommandBuffer cmd, uint32_t frameIndex, const Pipeline& pipeline) const;
 
     // Resources
     const RenderTarget::SharedResources* m_shared = nullptr;
     MainSceneGlobalData* m_globalData = nullptr;
     PassDependencies* m_dependencies = nullptr;
     
-    std::unique_ptr<Pipeline> m_pipeline;
+    std::unique_ptr<Pipeline> m_pipeline;              // EQUAL against the prepass depth, no writes
+    std::unique_ptr<Pipeline> m_depthWritePipeline;    // Used while the depth prepass is disabled
     std::unique_ptr<DescriptorSetLayout> m_descriptorLayout;
     std::unique_ptr<MainDescriptorManager> m_descriptorManager;
-    
-    // Attachments
-    std::array<ManagedTexture, MAX_FRAMES_IN_FLIGHT> m_depthTextures;
-    std::array<ManagedTexture, MAX_FRAMES_IN_FLIGHT> m_albedoTextures;
-    std::array<ManagedTexture, MAX_FRAMES_IN_FLIGHT> m_normalTextures;
-    std::array<ManagedTexture, MAX_FRAMES_IN_FLIGHT> m_paramTextures;
 };
\ No newline at end of file
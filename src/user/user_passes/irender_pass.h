@@ -12,4 +12,9 @@ public:
     virtual void cleanup() = 0;
     virtual void recreateSwapChain() = 0;
     virtual void execute(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t imageIndex) = 0;
+
+    // Lists the frame graph images the next execute() touches; called every frame before it
+    virtual void declare(FrameGraph::PassBuilder& builder, uint32_t frameIndex) = 0;
+    // Called after the frame graph (re)allocates its transients, at startup and on resize
+    virtual void updateAttachmentBindings() {}
 };
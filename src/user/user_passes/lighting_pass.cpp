@@ -2,8 +2,10 @@
 
 #include "config.h"
 #include "pipeline.h"
+#include "pipeline_build_queue.h"
 #include "descriptors/descriptor_set_layout_builder.h"
-#include "image_transition_manager.h"
+#include "gbuffer_formats.h"
+#include "shared/render_settings.h"
 
 void LightingPass::initialize(const RenderTarget::SharedResources& shared,
                              MainSceneGlobalData& globalData,
@@ -11,35 +13,59 @@ void LightingPass::initialize(const RenderTarget::SharedResources& shared,
     m_shared = &shared;
     m_globalData = &globalData;
     m_dependencies = &dependencies;
+    m_computeSupported = computeSupported(shared);
     
-    createAttachments();
+    registerAttachments();
     createDescriptors();
-    createPipeline();
+    m_shared->pipelineBuilds->enqueue([this]() { createPipeline(); });
+    if (m_computeSupported) {
+        m_shared->pipelineBuilds->enqueue([this]() { createComputePipeline(); });
+    }
+}
+
+bool LightingPass::computeSupported(const RenderTarget::SharedResources& shared) {
+    return shared.context->supportsStorageImageWriteWithoutFormat() && shared.gBufferFormats->hdrSupportsStorage();
 }
 
 void LightingPass::cleanup() {
     m_pipeline.reset();
+    m_computePipeline.reset();
     m_descriptorManager.reset();
     m_descriptorLayout.reset();
 }
 
 void LightingPass::recreateSwapChain() {
-    createAttachments();
+}
+
+void LightingPass::updateAttachmentBindings() {
     updateDescriptors();
 }
 
+void LightingPass::declare(FrameGraph::PassBuilder& builder, uint32_t frameIndex) {
+    const bool compute = renderSettings.computeLighting && m_computeSupported;
+    const FrameGraph::Usage sampled = compute ? FrameGraph::Usage::SampledCompute : FrameGraph::Usage::SampledFragment;
+    builder.read(m_dependencies->albedo, sampled);
+    builder.read(m_dependencies->normal, sampled);
+    builder.read(m_dependencies->params, sampled);
+    builder.read(m_dependencies->depth, sampled);
+    builder.read(m_dependencies->shadowMapImage, sampled);
+    builder.write(m_dependencies->hdr,
+                  compute ? FrameGraph::Usage::StorageWriteCompute : FrameGraph::Usage::ColorAttachment, true);
+}
+
 void LightingPass::execute(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t imageIndex) {
-    // Transition HDR texture
-    ImageTransitionManager::transitionColorAttachment(
-        cmd, m_hdrTextures[frameIndex].image,
-        VK_IMAGE_LAYOUT_UNDEFINED, 
-        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
-    );
-    
+    if (renderSettings.computeLighting && m_computeSupported) {
+        executeCompute(cmd, frameIndex);
+    } else {
+        executeGraphics(cmd, frameIndex);
+    }
+}
+
+void LightingPass::executeGraphics(VkCommandBuffer cmd, uint32_t frameIndex) {
     // Set up HDR attachment
     VkRenderingAttachmentInfo colorAttachment = {
       .sType         = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR,
-        .imageView     = m_hdrTextures[frameIndex].view,
+        .imageView     = m_dependencies->frameGraph->texture(m_dependencies->hdr).view,
         .imageLayout   = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
         .loadOp        = VK_ATTACHMENT_LOAD_OP_CLEAR,
         .storeOp       = VK_ATTACHMENT_STORE_OP_STORE,
@@ -82,13 +108,29 @@ void LightingPass::execute(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t im
     vkCmdDraw(cmd, 3, 1, 0, 0);
     
     vkCmdEndRendering(cmd);
+}
 
-    // Transition to shader read
-    ImageTransitionManager::transitionToShaderRead(
+void LightingPass::executeCompute(VkCommandBuffer cmd, uint32_t frameIndex) {
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipeline->handle());
+    vkCmdBindDescriptorSets(
         cmd,
-         m_hdrTextures[frameIndex].image,
-        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        m_computePipeline->layout(),
+        0, 1,
+        &m_descriptorManager->getDescriptorSets()[frameIndex],
+        0, nullptr
+    );
+    const VkExtent2D extent = m_shared->swapChain->extent();
+    vkCmdDispatch(cmd, (extent.width + TILE_SIZE - 1) / TILE_SIZE, (extent.height + TILE_SIZE - 1) / TILE_SIZE, 1);
+}
+
+void LightingPass::createComputePipeline() {
+    // Shares the graphics pipeline's descriptor sets; binding 11 is its storage view of the HDR target
+    m_computePipeline = std::make_unique<ComputePipeline>(
+        m_shared->context,
+        std::string(BUILD_RESOURCE_DIR) + "/shaders/lighting_comp.spv",
+        VkPushConstantRange{},
+        m_descriptorLayout->handle()
     );
 }
 
@@ -98,7 +140,7 @@ void LightingPass::createPipeline() {
         VK_DYNAMIC_STATE_SCISSOR
     };
     
-    VkFormat hdrFormat = VK_FORMAT_R32G32B32A32_SFLOAT;
+    VkFormat hdrFormat = m_shared->gBufferFormats->hdr();
     VkPipelineRenderingCreateInfo renderingInfo{};
     renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
     renderingInfo.colorAttachmentCount = 1;
@@ -177,46 +219,41 @@ void LightingPass::createPipeline() {
     );
 }
 
-void LightingPass::createAttachments() {
-    for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-        const auto& extent = m_shared->swapChain->extent();
-        VkImageUsageFlags usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
-                                 VK_IMAGE_USAGE_SAMPLED_BIT |
-                                 VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
-
-        m_hdrTextures[i] = m_shared->textureManager->createTexture(
-            extent.width, extent.height,
-            VK_FORMAT_R32G32B32A32_SFLOAT,
-            usage,
-            VMA_MEMORY_USAGE_GPU_ONLY,
-            VK_IMAGE_ASPECT_COLOR_BIT,
-            true
-        );
-
-        m_dependencies->hdrTextures[i] = &m_hdrTextures[i];
+void LightingPass::registerAttachments() {
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    if (m_computeSupported) {
+        usage |= VK_IMAGE_USAGE_STORAGE_BIT;
     }
+    m_dependencies->hdr = m_dependencies->frameGraph->createTransient(
+        "HDR", m_shared->gBufferFormats->hdr(), usage, VK_IMAGE_ASPECT_COLOR_BIT);
 }
 
 void LightingPass::createDescriptors() {
     // Descriptor layout (matches original)
     DescriptorSetLayoutBuilder layoutBuilder(m_shared->context->device());
+    // Every binding is visible to both lighting paths
+    constexpr VkShaderStageFlags stages = VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
     m_descriptorLayout = layoutBuilder
         .addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 
-                   VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)
-        .addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)  // Albedo
-        .addBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)  // Normal
-        .addBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)  // Params
-        .addBinding(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)  // Depth
-        .addBinding(5, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         VK_SHADER_STAGE_FRAGMENT_BIT)  // Lights
-        .addBinding(6, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)  // Cube map
-        .addBinding(7, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)  // Irradiance map
-        .addBinding(8, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,  VK_SHADER_STAGE_FRAGMENT_BIT )        // Directional Light
-        .addBinding(9, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,  VK_SHADER_STAGE_FRAGMENT_BIT ) // Shadow map
+                   VK_SHADER_STAGE_VERTEX_BIT | stages)
+        .addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, stages)  // Albedo
+        .addBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, stages)  // Normal
+        .addBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, stages)  // Params
+        .addBinding(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, stages)  // Depth
+        .addBinding(5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         stages)  // Lights
+        .addBinding(6, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, stages)  // Cube map
+        .addBinding(7, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, stages)  // Irradiance map
+        .addBinding(8, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         stages)  // Directional Light
+        .addBinding(9, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, stages)  // Shadow map
+        .addBinding(10, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,        stages)  // Light clusters
+        .addBinding(11, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)  // HDR output (compute path)
         .build();
     
     // Descriptor pool
     std::vector<VkDescriptorPoolSize> poolSizes = {
-        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 3 * MAX_FRAMES_IN_FLIGHT},
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2 * MAX_FRAMES_IN_FLIGHT},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 * MAX_FRAMES_IN_FLIGHT},
+        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, MAX_FRAMES_IN_FLIGHT},
         {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 9 * MAX_FRAMES_IN_FLIGHT}
     };
     
@@ -226,25 +263,27 @@ void LightingPass::createDescriptors() {
         poolSizes,
         MAX_FRAMES_IN_FLIGHT
     );
-    updateDescriptors();
+    // Written by updateAttachmentBindings() once the frame graph has allocated the attachments
 }
 
 void LightingPass::updateDescriptors() const {
+    const FrameGraph& graph = *m_dependencies->frameGraph;
+
     // Update descriptor sets
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
         VkDescriptorImageInfo albedoInfo = {
             .sampler = m_globalData->gBufferSampler,
-            .imageView = m_dependencies->albedoTextures[i]->view,
+            .imageView = graph.texture(m_dependencies->albedo).view,
             .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
         };
         VkDescriptorImageInfo normalInfo = {
             .sampler = m_globalData->gBufferSampler,
-            .imageView = m_dependencies->normalTextures[i]->view,
+            .imageView = graph.texture(m_dependencies->normal).view,
             .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
         };
         VkDescriptorImageInfo paramsInfo = {
             .sampler = m_globalData->gBufferSampler,
-            .imageView = m_dependencies->paramTextures[i]->view,
+            .imageView = graph.texture(m_dependencies->params).view,
             .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
         };
         VkDescriptorImageInfo depthInfo = {
@@ -271,6 +310,12 @@ void LightingPass::updateDescriptors() const {
             .imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
         };
 
+        VkDescriptorImageInfo hdrStorageInfo = {
+            .sampler = VK_NULL_HANDLE,
+            .imageView = graph.texture(m_dependencies->hdr).view,
+            .imageLayout = VK_IMAGE_LAYOUT_GENERAL
+        };
+
         std::vector<MainDescriptorManager::DescriptorUpdateInfo> updates = {
             {
                 .binding = 0,
@@ -309,8 +354,8 @@ void LightingPass::updateDescriptors() const {
             },
             {
                 .binding = 5,
-                .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                .bufferInfo = &m_globalData->frameData[i].omniLightBufferInfo,
+                .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .bufferInfo = &m_globalData->frameData[i].lightBufferInfo,
                 .descriptorCount = 1,
                 .isImage = false
             },
@@ -342,9 +387,26 @@ void LightingPass::updateDescriptors() const {
                 .imageInfo = &shadowInfo,
                 .descriptorCount = 1,
                 .isImage = true
+            },
+            {
+                .binding = 10,
+                .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .bufferInfo = &m_globalData->frameData[i].lightClusterBufferInfo,
+                .descriptorCount = 1,
+                .isImage = false
             }
 
         };
+        // Storage view of the HDR target, only created with the compute path
+        if (m_computeSupported) {
+            updates.push_back({
+                .binding = 11,
+                .type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                .imageInfo = &hdrStorageInfo,
+                .descriptorCount = 1,
+                .isImage = true
+            });
+        }
         m_descriptorManager->updateDescriptorSet(i, updates);
     }
 }
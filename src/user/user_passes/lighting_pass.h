@@ -2,6 +2,7 @@
 #include "irender_pass.h"
 #include "render_pass.h"
 #include "pipeline.h"
+#include "compute_pipeline.h"
 #include "descriptors/descriptor_set_layout.h"
 #include "user_descriptor_managers/main_descriptor_manager.h"
 
@@ -13,10 +14,23 @@ public:
     void cleanup() override;
     void recreateSwapChain() override;
     void execute(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t imageIndex) override;
+    void declare(FrameGraph::PassBuilder& builder, uint32_t frameIndex) override;
+    void updateAttachmentBindings() override;
+
+    // The compute path writes the HDR target as a storage image of whatever format was picked
+    static bool computeSupported(const RenderTarget::SharedResources& shared);
 
 private:
+    static constexpr uint32_t TILE_SIZE = 16;   // Workgroup size of lighting.comp
+
+    // Fullscreen triangle (lighting.frag, clustered lights) or 16x16 compute tiles (lighting.comp,
+    // per-tile light culling), chosen every frame by renderSettings.computeLighting
+    void executeGraphics(VkCommandBuffer cmd, uint32_t frameIndex);
+    void executeCompute(VkCommandBuffer cmd, uint32_t frameIndex);
+
     void createPipeline();
-    void createAttachments();
+    void createComputePipeline();
+    void registerAttachments();
     void createDescriptors();
     void updateDescriptors() const;
 
@@ -26,9 +40,8 @@ private:
     PassDependencies* m_dependencies = nullptr;
     
     std::unique_ptr<Pipeline> m_pipeline;
+    std::unique_ptr<ComputePipeline> m_computePipeline;
+    bool m_computeSupported = false;
     std::unique_ptr<DescriptorSetLayout> m_descriptorLayout;
     std::unique_ptr<MainDescriptorManager> m_descriptorManager;
-    
-    // Attachments
-    std::array<ManagedTexture, MAX_FRAMES_IN_FLIGHT> m_hdrTextures;
 };
\ No newline at end of file
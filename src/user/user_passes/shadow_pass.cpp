@@ -1,9 +1,15 @@
 ﻿#include "shadow_pass.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "config.h"
 #include "deletion_queue.h"
-#include "image_transition_manager.h"
+#include "parallel_recorder.h"
+#include "pipeline_build_queue.h"
+#include "camera/camera.h"
 #include "descriptors/descriptor_set_layout_builder.h"
+#include "shared/render_settings.h"
 
 #ifdef USE_TINYGLTF
     #include "loaders/gltf_loader.h"
@@ -16,11 +22,10 @@ void ShadowPass::initialize(const RenderTarget::SharedResources &shared, MainSce
     m_dependencies = &dependencies;
     m_shared = &shared;
 
-    createLightMatrices();
     createShadowMapTexture();
     createUniformBuffers();
     createDescriptors();
-    createPipeline();
+    m_shared->pipelineBuilds->enqueue([this]() { createPipeline(); });
 
 }
 
@@ -30,34 +35,87 @@ void ShadowPass::cleanup() {
 void ShadowPass::recreateSwapChain() {
 }
 
+void ShadowPass::declare(FrameGraph::PassBuilder& builder, uint32_t) {
+    // Cached cascades keep their depth from an earlier frame and stay in the read-only layout.
+    // With nothing to redraw the pass writes nothing, and the graph culls it.
+    if (m_renderMask != 0) {
+        builder.write(m_dependencies->shadowMapImage, FrameGraph::Usage::DepthAttachment, true, m_renderMask);
+    }
+}
+
 void ShadowPass::execute(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t) {
-    // Transition shadow map to depth attachment layout
-    ImageTransitionManager::transitionDepthAttachment(
-        cmd, m_dependencies->shadowMap->image,
-        VK_IMAGE_LAYOUT_UNDEFINED,
-        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
-    );
+    // With CPU culling, every redrawn cascade's draw list is handed to the workers up front so the
+    // cascades record concurrently with each other; the primary then only stitches them together
+    const bool cpuCulled = !m_globalData->gpuCulling;
+    std::array<ParallelRecorder::Batch, SHADOW_CASCADE_COUNT> batches;
+    uint32_t parallelMask = 0;
+    if (cpuCulled) {
+        const ParallelRecorder::RenderingFormats formats{ .depth = m_shadowMapTexture.format };
+        for (uint32_t cascade = 0; cascade < SHADOW_CASCADE_COUNT; ++cascade) {
+            const std::vector<uint32_t>& visible = m_globalData->shadowVisiblePrimitives[cascade];
+            const auto drawCount = static_cast<uint32_t>(visible.size());
+            if (!cascadeNeedsRender(cascade) || m_shared->recorder->chunkCount(drawCount) <= 1) {
+                continue;
+            }
+            batches[cascade] = m_shared->recorder->record(frameIndex, formats, 0, drawCount,
+                [this, frameIndex, cascade, &visible](VkCommandBuffer secondary, uint32_t begin, uint32_t end) {
+                    bindDrawState(secondary, frameIndex, cascade);
+                    m_globalData->drawPrimitives(secondary, visible, begin, end);
+                });
+            parallelMask |= 1u << cascade;
+        }
+    }
 
-    // Set up depth attachment for dynamic rendering
-    VkRenderingAttachmentInfo depthAttachment = {
-        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
-        .imageView = m_dependencies->shadowMap->view,
-        .imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-        .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
-        .clearValue = {.depthStencil = {1.0f, 0}}
-    };
+    for (uint32_t cascade = 0; cascade < SHADOW_CASCADE_COUNT; ++cascade) {
+        if (!cascadeNeedsRender(cascade)) {
+            continue;
+        }
+        const bool parallel = (parallelMask & (1u << cascade)) != 0;
+
+        // Set up depth attachment for dynamic rendering
+        VkRenderingAttachmentInfo depthAttachment = {
+            .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+            .imageView = m_cascadeViews[cascade],
+            .imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+            .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+            .clearValue = {.depthStencil = {1.0f, 0}}
+        };
 
-    VkRenderingInfo renderingInfo = {
-        .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
-        .renderArea = {{0, 0}, {SHADOW_MAP_SIZE, SHADOW_MAP_SIZE}},
-        .layerCount = 1,
-        .pDepthAttachment = &depthAttachment
-    };
+        VkRenderingInfo renderingInfo = {
+            .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+            .flags = parallel ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : 0u,
+            .renderArea = {{0, 0}, {SHADOW_MAP_SIZE, SHADOW_MAP_SIZE}},
+            .layerCount = 1,
+            .pDepthAttachment = &depthAttachment
+        };
+
+        vkCmdBeginRendering(cmd, &renderingInfo);
+        if (parallel) {
+            m_shared->recorder->execute(cmd, batches[cascade]);
+        } else {
+            bindDrawState(cmd, frameIndex, cascade);
+            // Draw the meshes inside this cascade's light frustum
+            m_globalData->drawVisible(cmd, m_globalData->shadowDrawLists[cascade], m_globalData->shadowVisiblePrimitives[cascade]);
+        }
+        vkCmdEndRendering(cmd);
+    }
+}
 
-    vkCmdBeginRendering(cmd, &renderingInfo);
+void ShadowPass::bindDrawState(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t cascade) const {
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline->handle());
+
+    vkCmdBindDescriptorSets(
+        cmd,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        m_pipeline->layout(),
+        0, 1,
+        &m_descriptorManager->getDescriptorSets()[frameIndex],
+        0, nullptr
+    );
+
+    vkCmdBindIndexBuffer(cmd, m_globalData->indexBuffer.handle(), 0, VK_INDEX_TYPE_UINT32);
 
-    // Set viewport/scissor
     VkViewport viewport = {
         0.0f, 0.0f,
         static_cast<float>(SHADOW_MAP_SIZE),
@@ -69,52 +127,156 @@ void ShadowPass::execute(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t) {
     VkRect2D scissor = {{0, 0}, {SHADOW_MAP_SIZE, SHADOW_MAP_SIZE}};
     vkCmdSetScissor(cmd, 0, 1, &scissor);
 
-    // Bind pipeline
-    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline->handle());
-
-    // Bind descriptor set
-    vkCmdBindDescriptorSets(
+    ShadowPushConstants pc = {
+        .vertexBufferAddress = m_globalData->vertexBufferAddress,
+        .primitiveBufferAddress = m_globalData->primitiveBufferAddress,
+        .modelScale = globalScale,
+        .cascadeIndex = cascade
+    };
+    vkCmdPushConstants(
         cmd,
-        VK_PIPELINE_BIND_POINT_GRAPHICS,
         m_pipeline->layout(),
-        0, 1,
-        &m_descriptorManager->getDescriptorSets()[frameIndex],
-        0, nullptr
+        VK_SHADER_STAGE_VERTEX_BIT,
+        0,
+        sizeof(ShadowPushConstants),
+        &pc
     );
+}
 
-    vkCmdBindIndexBuffer(cmd, m_globalData->indexBuffer.handle(), 0, VK_INDEX_TYPE_UINT32);
+void ShadowPass::updateCascades(uint32_t frameIndex, const glm::mat4& cameraView, const glm::mat4& cameraProj) {
+    const auto& aabb = m_globalData->sceneAABB;
+
+    // Shadows end at the far plane or once the whole scene is covered, whichever comes first
+    const float nearZ = Camera::NearPlane;
+    const float farZ = std::min(Camera::FarPlane, nearZ + glm::length(aabb.max - aabb.min));
+
+    // Practical split scheme: logarithmic splits blended with uniform ones by shadowSplitLambda
+    std::array<float, SHADOW_CASCADE_COUNT + 1> splits{};
+    splits[0] = nearZ;
+    for (uint32_t i = 1; i <= SHADOW_CASCADE_COUNT; ++i) {
+        const float p = static_cast<float>(i) / static_cast<float>(SHADOW_CASCADE_COUNT);
+        const float logSplit = nearZ * std::pow(farZ / nearZ, p);
+        const float uniformSplit = nearZ + (farZ - nearZ) * p;
+        splits[i] = glm::mix(uniformSplit, logSplit, renderSettings.shadowSplitLambda);
+    }
 
-    // Draw all meshes
-    for (const auto& primitive : m_globalData->primitives) {
-        ShadowPushConstants pc = {
-            .vertexBufferAddress = m_globalData->vertexBufferAddress,
-            .modelScale = globalScale,
-            .baseColorTextureIndex = primitive.materialIndex
-        };
+    // World-space corners of the camera frustum; index bit 2 selects the far plane
+    const glm::mat4 invViewProj = glm::inverse(cameraProj * cameraView);
+    std::array<glm::vec3, 8> frustumCorners{};
+    for (uint32_t i = 0; i < 8; ++i) {
+        const glm::vec4 corner = invViewProj * glm::vec4(
+            (i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : 0.0f, 1.0f);
+        frustumCorners[i] = glm::vec3(corner) / corner.w;
+    }
 
-        vkCmdPushConstants(
-            cmd,
-            m_pipeline->layout(),
-            VK_SHADER_STAGE_VERTEX_BIT,
-            0,
-            sizeof(ShadowPushConstants),
-            &pc
-        );
+    // The light's orientation only depends on its direction, so it stays fixed while the camera moves
+    const glm::vec3 lightDirection = glm::normalize(directionalLight.directionalLightDirection);
+    const glm::vec3 up = glm::abs(glm::dot(lightDirection, glm::vec3(0.f, 1.f, 0.f))) > 0.99f
+        ? glm::vec3(0.f, 0.f, 1.f)
+        : glm::vec3(0.f, 1.f, 0.f);
+    const glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), lightDirection, up);
+
+    // A new light direction invalidates every cached layer
+    if (lightDirection != m_cachedLightDirection || !renderSettings.shadowCaching) {
+        for (auto& cached : m_cascades) {
+            cached.valid = false;
+        }
+        m_cachedLightDirection = lightDirection;
+    }
+    m_renderMask = 0;
+
+    // Casters anywhere in the scene can shade a cascade, so its depth range spans the whole scene
+    float sceneMinZ = FLT_MAX;
+    float sceneMaxZ = -FLT_MAX;
+    for (uint32_t i = 0; i < 8; ++i) {
+        const glm::vec3 corner((i & 1) ? aabb.max.x : aabb.min.x,
+                               (i & 2) ? aabb.max.y : aabb.min.y,
+                               (i & 4) ? aabb.max.z : aabb.min.z);
+        const float z = (lightView * glm::vec4(corner, 1.0f)).z;
+        sceneMinZ = std::min(sceneMinZ, z);
+        sceneMaxZ = std::max(sceneMaxZ, z);
+    }
 
-        vkCmdDrawIndexed(
-            cmd, primitive.indexCount, 1,
-            primitive.indexOffset, 0, 0
-        );
+    for (uint32_t cascade = 0; cascade < SHADOW_CASCADE_COUNT; ++cascade) {
+        const float tNear = (splits[cascade] - nearZ) / (Camera::FarPlane - nearZ);
+        const float tFar = (splits[cascade + 1] - nearZ) / (Camera::FarPlane - nearZ);
+
+        std::array<glm::vec3, 8> sliceCorners{};
+        glm::vec3 center(0.0f);
+        for (uint32_t i = 0; i < 4; ++i) {
+            const glm::vec3 ray = frustumCorners[i + 4] - frustumCorners[i];
+            sliceCorners[i] = frustumCorners[i] + ray * tNear;
+            sliceCorners[i + 4] = frustumCorners[i] + ray * tFar;
+            center += sliceCorners[i] + sliceCorners[i + 4];
+        }
+        center /= 8.0f;
+
+        // A bounding sphere keeps the cascade's size constant as the camera rotates
+        float radius = 0.0f;
+        for (const auto& corner : sliceCorners) {
+            radius = std::max(radius, glm::length(corner - center));
+        }
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+
+        // The cached layer is reused while the slice's sphere still fits in what it was rendered with
+        auto& cached = m_cascades[cascade];
+        const glm::vec3 lightCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+        const bool covered = cached.valid && cached.radius == radius &&
+            glm::all(glm::greaterThanEqual(lightCenter - radius, cached.boundsMin)) &&
+            glm::all(glm::lessThanEqual(lightCenter + radius, cached.boundsMax));
+
+        if (!covered) {
+            // Moving the frustum in whole texels keeps shadow edges from shimmering between refits
+            const float halfExtent = radius * (1.0f + CACHE_MARGIN);
+            const float texelSize = 2.0f * halfExtent / static_cast<float>(SHADOW_MAP_SIZE);
+            const glm::vec2 minXY = glm::floor((glm::vec2(lightCenter) - halfExtent) / texelSize) * texelSize;
+            const glm::vec2 maxXY = minXY + 2.0f * halfExtent;
+
+            const float minZ = std::min(sceneMinZ, lightCenter.z - halfExtent);
+            const float maxZ = std::max(sceneMaxZ, lightCenter.z + halfExtent);
+
+            // Bottom and top swapped: Y is flipped like the camera projection
+            const glm::mat4 projection = glm::ortho(minXY.x, maxXY.x, maxXY.y, minXY.y, -maxZ, -minZ);
+
+            cached.viewProj = projection * lightView;
+            cached.boundsMin = glm::vec3(minXY, minZ);
+            cached.boundsMax = glm::vec3(maxXY, maxZ);
+            cached.radius = radius;
+            cached.valid = true;
+            m_renderMask |= 1u << cascade;
+        }
+
+        directionalLight.cascadeViewProj[cascade] = cached.viewProj;
+        directionalLight.cascadeSplits[cascade] = splits[cascade + 1];
+    }
+
+    // Moved geometry redraws the cached cascades whose light-space box it overlaps
+    for (const auto& bounds : m_movedBounds) {
+        glm::vec3 boundsMin(FLT_MAX);
+        glm::vec3 boundsMax(-FLT_MAX);
+        for (uint32_t i = 0; i < 8; ++i) {
+            const glm::vec3 corner((i & 1) ? bounds.max.x : bounds.min.x,
+                                   (i & 2) ? bounds.max.y : bounds.min.y,
+                                   (i & 4) ? bounds.max.z : bounds.min.z);
+            const glm::vec3 lightCorner = glm::vec3(lightView * glm::vec4(corner, 1.0f));
+            boundsMin = glm::min(boundsMin, lightCorner);
+            boundsMax = glm::max(boundsMax, lightCorner);
+        }
+        for (uint32_t cascade = 0; cascade < SHADOW_CASCADE_COUNT; ++cascade) {
+            const auto& cached = m_cascades[cascade];
+            if (glm::all(glm::lessThanEqual(boundsMin, cached.boundsMax)) &&
+                glm::all(glm::greaterThanEqual(boundsMax, cached.boundsMin))) {
+                m_renderMask |= 1u << cascade;
+            }
+        }
     }
+    m_movedBounds.clear();
 
-    vkCmdEndRendering(cmd);
+    m_directionalLightingBuffers[frameIndex].update(directionalLight);
+}
 
-    // Transition to shader read-only layout for main pass usage
-    ImageTransitionManager::transitionDepthAttachment(
-        cmd, m_dependencies->shadowMap->image,
-        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-        VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
-    );
+void ShadowPass::invalidateBounds(const MainSceneGlobalData::AABB& bounds) {
+    m_movedBounds.push_back(bounds);
 }
 
 void ShadowPass::createPipeline() {
@@ -177,7 +339,12 @@ void ShadowPass::createPipeline() {
     m_pipeline = std::make_unique<Pipeline>(
         m_shared->context,
         m_descriptorLayout->handle(),
-        config
+        config,
+        VkPushConstantRange{
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+            .offset = 0,
+            .size = sizeof(ShadowPushConstants)
+        }
     );
 }
 
@@ -204,7 +371,7 @@ void ShadowPass::createDescriptors() {
 
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
         VkDescriptorBufferInfo bufferInfo = {
-            .buffer = m_directionalLightingBuffer.handle(),
+            .buffer = m_directionalLightingBuffers[i].handle(),
             .offset = 0,
             .range = sizeof(DirectionalLightData)
         };
@@ -230,83 +397,61 @@ void ShadowPass::createDescriptors() {
     }
 }
 
-void ShadowPass::createLightMatrices() const {
-    const glm::vec3 sceneCenter = (m_globalData->sceneAABB.min + m_globalData->sceneAABB.max) / 2.0f;
-    const glm::vec3 lightDirection = directionalLight.directionalLightDirection;
-
-    const std::vector<glm::vec3> corners = {
-        {m_globalData->sceneAABB.min.x,  m_globalData->sceneAABB.min.y, m_globalData->sceneAABB.min.z},
-        {m_globalData->sceneAABB.max.x,  m_globalData->sceneAABB.min.y, m_globalData->sceneAABB.min.z},
-        {m_globalData->sceneAABB.min.x,  m_globalData->sceneAABB.max.y, m_globalData->sceneAABB.min.z},
-        {m_globalData->sceneAABB.max.x,  m_globalData->sceneAABB.max.y, m_globalData->sceneAABB.min.z},
-        {m_globalData->sceneAABB.min.x,  m_globalData->sceneAABB.min.y, m_globalData->sceneAABB.max.z},
-        {m_globalData->sceneAABB.max.x,  m_globalData->sceneAABB.min.y, m_globalData->sceneAABB.max.z},
-        {m_globalData->sceneAABB.min.x,  m_globalData->sceneAABB.max.y, m_globalData->sceneAABB.max.z},
-        {m_globalData->sceneAABB.max.x,  m_globalData->sceneAABB.max.y, m_globalData->sceneAABB.max.z},
-    };
-
-    //Project corners onto light direction
-    float minProj = FLT_MAX;
-    float maxProj = -FLT_MAX;
-    for (const auto& corner : corners) {
-        const float proj = glm::dot(corner, lightDirection);
-        minProj = std::min(minProj, proj);
-        maxProj = std::max(maxProj, proj);
-    }
-
-    // Calculate distance and position
-    const float distance = maxProj - glm::dot(sceneCenter, lightDirection);
-    const glm::vec3 lightPosition = sceneCenter - lightDirection * distance;
-    directionalLight.directionalLightPosition = lightPosition;
-
-    // Calculate safe up vector
-    const glm::vec3 up = glm::abs(glm:: dot(lightDirection, glm::vec3(0.f, 1.f, 0.f))) > 0.99f
-    ? glm::vec3(0.f, 0.f, 1.f)
-    : glm::vec3(0.f, 1.f, 0.f);
-
-    // Use lightPosition with center to generate view matrix
-    directionalLight.view = glm::lookAt(lightPosition, sceneCenter, up);
-
-    // Find min/max in view/light space
-    glm::vec3 minLightSpace(FLT_MAX);
-    glm::vec3 maxLightSpace(-FLT_MAX);
-    for (const auto& corner : corners) {
-        const glm::vec3 transformedCorner = glm::vec3(directionalLight.view * glm::vec4(corner, 1.0f));
-        minLightSpace = glm::min(minLightSpace, transformedCorner);
-        maxLightSpace = glm::max(maxLightSpace, transformedCorner);
-    }
-
-    // Create orthographic projection matrix
-    const float nearZ = 0.0f;
-    const float farZ = maxLightSpace.z - minLightSpace.z;
-    directionalLight.projection = glm::ortho(minLightSpace.x, maxLightSpace.x,
-                                                minLightSpace.y, maxLightSpace.y,
-                                                nearZ, farZ);
-    directionalLight.projection[1][1] *= -1; // Invert y-axis
-}
-
 void ShadowPass::createUniformBuffers() {
-    m_directionalLightingBuffer = UniformBuffer(
-        m_shared->bufferManager,
-        m_shared->allocator,
-        sizeof(DirectionalLightData)
+    // Rewritten by updateCascades every frame
+    for (auto& buffer : m_directionalLightingBuffers) {
+        buffer = UniformBuffer(
+            m_shared->bufferManager,
+            m_shared->allocator,
+            sizeof(DirectionalLightData)
         );
-
-    m_directionalLightingBuffer.update(directionalLight);
+        buffer.update(directionalLight);
+    }
 }
 
 void ShadowPass::createShadowMapTexture() {
     VkDevice device = m_shared->context->device();
 
-    m_shadowMapTexture = m_shared->textureManager->createTexture(
+    m_shadowMapTexture.width = SHADOW_MAP_SIZE;
+    m_shadowMapTexture.height = SHADOW_MAP_SIZE;
+    m_shadowMapTexture.format = VK_FORMAT_D32_SFLOAT;
+    m_shadowMapTexture.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    m_shadowMapTexture.memoryUsage = VMA_MEMORY_USAGE_GPU_ONLY;
+    m_shadowMapTexture.aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+    m_shared->textureManager->createImage(
         SHADOW_MAP_SIZE, SHADOW_MAP_SIZE,
-        VK_FORMAT_D32_SFLOAT,
-        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-        VMA_MEMORY_USAGE_GPU_ONLY,
-        VK_IMAGE_ASPECT_DEPTH_BIT,
-        false, "ShadowMapTexture"
+        m_shadowMapTexture.format,
+        VK_IMAGE_TILING_OPTIMAL,
+        m_shadowMapTexture.usage,
+        m_shadowMapTexture.memoryUsage,
+        m_shadowMapTexture.image, m_shadowMapTexture.allocation,
+        SHADOW_CASCADE_COUNT, 0
     );
-    m_shadowMapTexture.format = VK_FORMAT_D32_SFLOAT;
+
+    // Array view for sampling, one single-layer view per cascade for rendering
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = m_shadowMapTexture.image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+    viewInfo.format = m_shadowMapTexture.format;
+    viewInfo.subresourceRange = {VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, SHADOW_CASCADE_COUNT};
+    if (vkCreateImageView(device, &viewInfo, nullptr, &m_shadowMapTexture.view) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create shadow map array view");
+    }
+    DeletionQueue::get().push([device, view = m_shadowMapTexture.view]() {
+        vkDestroyImageView(device, view, nullptr);
+    });
+
+    for (uint32_t cascade = 0; cascade < SHADOW_CASCADE_COUNT; ++cascade) {
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.subresourceRange = {VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, cascade, 1};
+        if (vkCreateImageView(device, &viewInfo, nullptr, &m_cascadeViews[cascade]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create shadow cascade view");
+        }
+        DeletionQueue::get().push([device, view = m_cascadeViews[cascade]]() {
+                vkDestroyImageView(device, view, nullptr);
+            });
+    }
 
     // Create sampler with compare enabled
     VkSamplerCreateInfo samplerInfo = {};
@@ -324,13 +469,19 @@ void ShadowPass::createShadowMapTexture() {
     samplerInfo.maxLod = 1.0f;
 
     vkCreateSampler(m_shared->context->device(), &samplerInfo, nullptr, &m_shadowMapTexture.sampler);
+    m_shadowMapTexture.hasSampler = true;
 
     VkSampler mapTextureSamplerCopy = m_shadowMapTexture.sampler;
 
-    DeletionQueue::get().pushFunction("ShadowMapSampler_" + std::to_string(TextureManager::getSamplerIndex()), [device, mapTextureSamplerCopy]() {
+    DeletionQueue::get().push([device, mapTextureSamplerCopy]() {
             vkDestroySampler(device, mapTextureSamplerCopy, nullptr);
         });
 
     m_dependencies->shadowMap = &m_shadowMapTexture;
 
+    // Outlives every frame, so the graph carries its layer states over from one frame to the next
+    FrameGraph& graph = *m_dependencies->frameGraph;
+    m_dependencies->shadowMapImage = graph.importImage(
+        "ShadowMap", VK_IMAGE_ASPECT_DEPTH_BIT, SHADOW_CASCADE_COUNT, VK_IMAGE_LAYOUT_UNDEFINED, false);
+    graph.bindImage(m_dependencies->shadowMapImage, m_shadowMapTexture.image);
 }
@@ -14,25 +14,56 @@ public:
     void cleanup() override;
     void recreateSwapChain() override;
     void execute(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t imageIndex) override;
+    void declare(FrameGraph::PassBuilder& builder, uint32_t frameIndex) override;
+
+    // Splits the camera frustum into SHADOW_CASCADE_COUNT slices and uploads this frame's cascade
+    // matrices. A cascade keeps its cached layer while its slice stays inside the padded footprint it
+    // was rendered with; it is refitted and redrawn when the slice leaves it, when the light turns or
+    // when moved geometry touches it. Call before culling the cascades.
+    void updateCascades(uint32_t frameIndex, const glm::mat4& cameraView, const glm::mat4& cameraProj);
+
+    // Call with the old and the new bounds of anything that moved; cascades they overlap are redrawn
+    void invalidateBounds(const MainSceneGlobalData::AABB& bounds);
+
+    // Whether execute() redraws the cascade this frame; cascades that are not redrawn need no culling
+    bool cascadeNeedsRender(uint32_t cascade) const { return (m_renderMask & (1u << cascade)) != 0; }
 private:
+    // Light-space footprint a cascade layer was last rendered with
+    struct CachedCascade {
+        glm::mat4 viewProj{1.0f};
+        glm::vec3 boundsMin{0.0f};
+        glm::vec3 boundsMax{0.0f};
+        float radius = 0.0f;
+        bool valid = false;
+    };
+
     void createPipeline();
     void createDescriptors();
-    void createLightMatrices() const;
     void createUniformBuffers();
     void createShadowMapTexture();
+    // Pipeline, descriptors and push constants for one cascade, in the primary or a parallel secondary
+    void bindDrawState(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t cascade) const;
 
     const RenderTarget::SharedResources* m_shared = nullptr;
     MainSceneGlobalData* m_globalData = nullptr;
     PassDependencies* m_dependencies = nullptr;
 
-    ManagedTexture m_shadowMapTexture = {};
+    ManagedTexture m_shadowMapTexture = {};                     // One layer per cascade
+    std::array<VkImageView, SHADOW_CASCADE_COUNT> m_cascadeViews{}; // Single-layer views to render into
 
     std::unique_ptr<Pipeline> m_pipeline;
     std::unique_ptr<MainDescriptorManager> m_descriptorManager;
     std::unique_ptr<DescriptorSetLayout> m_descriptorLayout;
 
-    UniformBuffer m_directionalLightingBuffer;
+    std::array<UniformBuffer, MAX_FRAMES_IN_FLIGHT> m_directionalLightingBuffers;
+
+    std::array<CachedCascade, SHADOW_CASCADE_COUNT> m_cascades{};
+    glm::vec3 m_cachedLightDirection{0.0f};
+    std::vector<MainSceneGlobalData::AABB> m_movedBounds;
+    uint32_t m_renderMask = 0;                          // Bit per cascade redrawn this frame
 
-    static constexpr uint32_t SHADOW_MAP_SIZE = 4096;
+    static constexpr uint32_t SHADOW_MAP_SIZE = 2048;   // Per cascade
+    // Extra footprint around each slice's bounding sphere, so small camera moves reuse the cached layer
+    static constexpr float CACHE_MARGIN = 0.1f;
 };
 
@@ -2,6 +2,7 @@
 #include "config.h"
 #include "image_transition_manager.h"
 #include "pipeline.h"
+#include "pipeline_build_queue.h"
 #include "descriptors/descriptor_set_layout_builder.h"
 
 void ToneMappingPass::initialize(const RenderTarget::SharedResources& shared,
@@ -15,7 +16,7 @@ void ToneMappingPass::initialize(const RenderTarget::SharedResources& shared,
     m_currentColorLayouts.assign(count, VK_IMAGE_LAYOUT_UNDEFINED);
 
     createDescriptors();
-    createPipeline();
+    m_shared->pipelineBuilds->enqueue([this]() { createPipeline(); });
 }
 
 void ToneMappingPass::cleanup() {
@@ -25,9 +26,17 @@ void ToneMappingPass::cleanup() {
 }
 
 void ToneMappingPass::recreateSwapChain() {
+}
+
+void ToneMappingPass::updateAttachmentBindings() {
     updateDescriptors();
 }
 
+void ToneMappingPass::declare(FrameGraph::PassBuilder& builder, uint32_t frameIndex) {
+    builder.read(m_dependencies->hdr, FrameGraph::Usage::SampledFragment);
+    builder.write(m_dependencies->swapchain, FrameGraph::Usage::ColorAttachment, true);
+}
+
 void ToneMappingPass::execute(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t imageIndex) {
     // ─── Set up your color attachment for tone mapping ───
     VkRenderingAttachmentInfo colorAttachment = {
@@ -205,8 +214,7 @@ void ToneMappingPass::createDescriptors() {
         poolSizes,
         MAX_FRAMES_IN_FLIGHT
     );
-    
-    updateDescriptors();
+    // Written by updateAttachmentBindings() once the frame graph has allocated the HDR target
 }
 
 void ToneMappingPass::updateDescriptors() const {
@@ -214,7 +222,7 @@ void ToneMappingPass::updateDescriptors() const {
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
         VkDescriptorImageInfo hdrInfo = {
             .sampler = m_globalData->hdrSampler,
-            .imageView = m_dependencies->hdrTextures[i]->view,
+            .imageView = m_dependencies->frameGraph->texture(m_dependencies->hdr).view,
             .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
         };
 
@@ -13,6 +13,8 @@ public:
     void cleanup() override;
     void recreateSwapChain() override;
     void execute(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t imageIndex) override;
+    void declare(FrameGraph::PassBuilder& builder, uint32_t frameIndex) override;
+    void updateAttachmentBindings() override;
 
 private:
     void createPipeline();
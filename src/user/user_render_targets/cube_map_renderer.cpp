@@ -69,11 +69,7 @@ void CubeMapRenderer::createCubeVertexData() {
     // Copy from staging to device buffer
     m_bufferManager->copyBuffer(staging.buffer, m_cubeVertexBuffer.buffer, bufferSize);
 
-    // Get device address
-    VkBufferDeviceAddressInfo addressInfo{};
-    addressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
-    addressInfo.buffer = m_cubeVertexBuffer.buffer;
-    m_vertexBufferAddress = vkGetBufferDeviceAddress(m_context->device(), &addressInfo);
+    m_vertexBufferAddress = m_bufferManager->deviceAddress(m_cubeVertexBuffer.buffer);
 }
 
 void CubeMapRenderer::createDiffuseIrradiancePipeline()
@@ -195,18 +191,17 @@ CubeMapRenderer::CubeMap CubeMapRenderer::createCubeMap(uint32_t size, VkFormat
     return cubeMap;
 }
 
-static int imageViews = 0;
-static int cubeMapViews = 0;
 void CubeMapRenderer::createCubeFaceViews(CubeMap& cubeMap) const {
     VkDevice device = m_context->device();
+    const ManagedTexture& texture = m_textureManager->get(cubeMap.texture);
 
     // Create individual face views
     for (uint32_t face = 0; face < 6; ++face) {
         VkImageViewCreateInfo viewInfo{};
         viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-        viewInfo.image = cubeMap.texture.image;
+        viewInfo.image = texture.image;
         viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-        viewInfo.format = cubeMap.texture.format;
+        viewInfo.format = texture.format;
         viewInfo.subresourceRange = {
             .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
             .baseMipLevel = 0,
@@ -219,8 +214,7 @@ void CubeMapRenderer::createCubeFaceViews(CubeMap& cubeMap) const {
             throw std::runtime_error("Failed to create cube map face view");
         }
 
-        DeletionQueue::get().pushFunction("CubeFaceView_" + std::to_string(++imageViews),
-            [device, view = cubeMap.faceViews[face]]() {
+        DeletionQueue::get().push([device, view = cubeMap.faceViews[face]]() {
                 vkDestroyImageView(device, view, nullptr);
             });
     }
@@ -228,9 +222,9 @@ void CubeMapRenderer::createCubeFaceViews(CubeMap& cubeMap) const {
     // Create a cube map view (for sampling)
     VkImageViewCreateInfo cubeViewInfo{};
     cubeViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-    cubeViewInfo.image = cubeMap.texture.image;
+    cubeViewInfo.image = texture.image;
     cubeViewInfo.viewType = VK_IMAGE_VIEW_TYPE_CUBE;
-    cubeViewInfo.format = cubeMap.texture.format;
+    cubeViewInfo.format = texture.format;
     cubeViewInfo.subresourceRange = {
         .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
         .baseMipLevel = 0,
@@ -243,7 +237,7 @@ void CubeMapRenderer::createCubeFaceViews(CubeMap& cubeMap) const {
         throw std::runtime_error("Failed to create cube map view");
     }
 
-    DeletionQueue::get().pushFunction("CubeMapView_" + std::to_string(++cubeMapViews), [device, view = cubeMap.cubemapView]() {
+    DeletionQueue::get().push([device, view = cubeMap.cubemapView]() {
         vkDestroyImageView(device, view, nullptr);
     });
 }
@@ -251,15 +245,9 @@ void CubeMapRenderer::createCubeFaceViews(CubeMap& cubeMap) const {
 void CubeMapRenderer::renderEquirectToCube(VkCommandBuffer cmd,
                                          const ManagedTexture& equirectTexture,
                                          const CubeMap& cubeMap) const {
+    const ManagedTexture& cubeTexture = m_textureManager->get(cubeMap.texture);
 
-    // Add equirect texture transition
-    ImageTransitionManager::transitionImageLayout(
-        cmd, equirectTexture.image,
-        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-        1, 1
-    );
-
-    // Update descriptor set with actual texture data
+    // The equirect texture's upload already left it shader-readable; update descriptor set with actual texture data
     VkDescriptorImageInfo imageInfo{};
     imageInfo.sampler = m_equirectSampler;
     imageInfo.imageView = equirectTexture.view;
@@ -278,11 +266,15 @@ void CubeMapRenderer::renderEquirectToCube(VkCommandBuffer cmd,
     m_descriptorManager->updateDescriptorSet(0, updates);
 
     // Transition cubemap to render target layout
-    ImageTransitionManager::transitionImageLayout(
-        cmd, cubeMap.texture.image,
+    ImageTransitionManager::BarrierBatch barriers;
+    barriers.image(ImageTransitionManager::mipRangeBarrier(
+        cubeTexture.image,
         VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-        6, 1  // 6 faces, 1 mip
-    );
+        VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE,
+        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+        0, 1, 6  // 1 mip, 6 faces
+    ));
+    barriers.flush(cmd);
 
     // Precomputed view matrices for each face
     const std::array<glm::mat4, 6> viewMatrices = {
@@ -309,7 +301,7 @@ void CubeMapRenderer::renderEquirectToCube(VkCommandBuffer cmd,
 
         VkRenderingInfo renderInfo{};
         renderInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
-        renderInfo.renderArea = {{0, 0}, {cubeMap.texture.width, cubeMap.texture.height}};
+        renderInfo.renderArea = {{0, 0}, {cubeTexture.width, cubeTexture.height}};
         renderInfo.layerCount = 1;
         renderInfo.colorAttachmentCount = 1;
         renderInfo.pColorAttachments = &colorAttachment;
@@ -319,12 +311,12 @@ void CubeMapRenderer::renderEquirectToCube(VkCommandBuffer cmd,
         vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline->handle());
 
         VkViewport viewport{0.0f, 0.0f,
-                           static_cast<float>(cubeMap.texture.width),
-                           static_cast<float>(cubeMap.texture.height),
+                           static_cast<float>(cubeTexture.width),
+                           static_cast<float>(cubeTexture.height),
                            0.0f, 1.0f};
         vkCmdSetViewport(cmd, 0, 1, &viewport);
 
-        VkRect2D scissor{{0, 0}, {cubeMap.texture.width, cubeMap.texture.height}};
+        VkRect2D scissor{{0, 0}, {cubeTexture.width, cubeTexture.height}};
         vkCmdSetScissor(cmd, 0, 1, &scissor);
 
         vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
@@ -348,16 +340,19 @@ void CubeMapRenderer::renderEquirectToCube(VkCommandBuffer cmd,
     }
 
     // Final transition to shader read
-    ImageTransitionManager::transitionImageLayout(
-        cmd, cubeMap.texture.image,
-        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-        6, 1
-    );
+    barriers.image(ImageTransitionManager::mipRangeBarrier(
+        cubeTexture.image,
+        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+        0, 1, 6
+    ));
+    barriers.flush(cmd);
 }
 
 CubeMapRenderer::CubeMap CubeMapRenderer::createDiffuseIrradianceMap(VkCommandBuffer cmd, const CubeMap &environmentMap, uint32_t size) {
  CubeMap irradianceMap = createCubeMap(size, VK_FORMAT_R16G16B16A16_SFLOAT);
+    const VkImage irradianceImage = m_textureManager->get(irradianceMap.texture).image;
 
     if (!m_diffuseIrradiancePipeline) {
         createDiffuseIrradiancePipeline();
@@ -382,12 +377,15 @@ CubeMapRenderer::CubeMap CubeMapRenderer::createDiffuseIrradianceMap(VkCommandBu
 
 
     // Transition irradiance map to render a target
-    ImageTransitionManager::transitionImageLayout(
-        cmd, irradianceMap.texture.image,
-        VK_IMAGE_LAYOUT_UNDEFINED,
-        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-        6, 1
-    );
+    ImageTransitionManager::BarrierBatch barriers;
+    barriers.image(ImageTransitionManager::mipRangeBarrier(
+        irradianceImage,
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE,
+        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+        0, 1, 6
+    ));
+    barriers.flush(cmd);
 
     // Same view matrices as in renderEquirectToCube
     const std::array<glm::mat4, 6> viewMatrices = {
@@ -449,12 +447,14 @@ CubeMapRenderer::CubeMap CubeMapRenderer::createDiffuseIrradianceMap(VkCommandBu
     }
 
     // Transition to shader read
-    ImageTransitionManager::transitionImageLayout(
-        cmd, irradianceMap.texture.image,
-        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-        6, 1
-    );
+    barriers.image(ImageTransitionManager::mipRangeBarrier(
+        irradianceImage,
+        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+        0, 1, 6
+    ));
+    barriers.flush(cmd);
 
     return irradianceMap;
 }
@@ -498,7 +498,7 @@ void CubeMapRenderer::createPipelines() {
         throw std::runtime_error("Failed to create equirect sampler");
     }
 
-    DeletionQueue::get().pushFunction("EquirectSampler", [device, sampler = m_equirectSampler]() {
+    DeletionQueue::get().push([device, sampler = m_equirectSampler]() {
         vkDestroySampler(device, sampler, nullptr);
     });
 
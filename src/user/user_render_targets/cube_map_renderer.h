@@ -24,7 +24,7 @@ public:
     void initialize(Context* context, BufferManager* bufferManager, TextureManager* textureManager);
 
     struct CubeMap {
-        ManagedTexture texture;
+        TextureHandle texture;
         std::array<VkImageView, 6> faceViews;
         VkImageView cubemapView;  // View for entire cubemap
     };
@@ -4,6 +4,8 @@
 #include "descriptors/descriptor_set_layout_builder.h"
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_vulkan.h"
+#include "profiling/gpu_profiler.h"
+#include "user_passes/lighting_pass.h"
 
 void ImGuiTarget::initialize(const SharedResources &shared) {
     m_shared = &shared;
@@ -14,9 +16,11 @@ void ImGuiTarget::initialize(const SharedResources &shared) {
 
 void ImGuiTarget::render(VkCommandBuffer commandBuffer, uint32_t imageIndex)
 {
+    m_shared->profiler->beginScope(commandBuffer, "ImGui");
     m_executor->begin(commandBuffer, imageIndex);
     m_executor->execute(commandBuffer);
     m_executor->end(commandBuffer);
+    m_shared->profiler->endScope(commandBuffer);
 }
 
 void ImGuiTarget::recreateSwapChain() {
@@ -30,7 +34,9 @@ void ImGuiTarget::recreateSwapChain() {
         .extent =  m_shared->swapChain->extent(),
         .swapchainImageViews = m_shared->swapChain->imagesViews(),
         .depthImageViews = depthViews,
-        .currentFrame = m_shared->currentFrame
+        .currentFrame = m_shared->currentFrame,
+        .profiler = m_shared->profiler,
+        .computeLightingSupported = LightingPass::computeSupported(*m_shared)
     };
 
     m_executor = std::make_unique<ImGuiPassExecutor>(std::move(resources));
@@ -61,7 +67,9 @@ void ImGuiTarget::createRenderingResources()
         .extent =  m_shared->swapChain->extent(),
         .swapchainImageViews = m_shared->swapChain->imagesViews(),
         .depthImageViews = depthViews,
-        .currentFrame = m_shared->currentFrame
+        .currentFrame = m_shared->currentFrame,
+        .profiler = m_shared->profiler,
+        .computeLightingSupported = LightingPass::computeSupported(*m_shared)
     };
 
     m_executor = std::make_unique<ImGuiPassExecutor>(std::move(resources));
@@ -86,7 +94,7 @@ void ImGuiTarget::initializeImGui() const {
     init_info.Device = m_shared->context->device();
     init_info.QueueFamily = m_shared->context->findQueueFamilies(m_shared->context->physicalDevice()).graphicsFamily.value();
     init_info.Queue = m_shared->context->graphicsQueue();
-    init_info.PipelineCache = VK_NULL_HANDLE;
+    init_info.PipelineCache = m_shared->context->pipelineCache();
     init_info.DescriptorPool = m_descriptorManager->getPool();
     init_info.MinImageCount = m_shared->swapChain->images().size();
     init_info.ImageCount =  m_shared->swapChain->images().size();
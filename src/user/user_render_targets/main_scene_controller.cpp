@@ -2,10 +2,144 @@
 
 #include "deletion_queue.h"
 #include "depth_format.h"
-#include "image_transition_manager.h"
+#include "lighting/stress_lights.h"
+#include "profiling/gpu_profiler.h"
+#include "shared/render_settings.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <queue>
 
 #ifdef USE_TINYGLTF
     #include "loaders/gltf_loader.h"
+    #include "loaders/cooked_scene.h"
+
+namespace {
+    // Where the CookScene target writes the cooked copy of a model: the same relative path under
+    // BUILD_RESOURCE_DIR, or next to the model when it lives outside SOURCE_RESOURCE_DIR
+    std::filesystem::path cookedPathFor(const std::filesystem::path& modelPath) {
+        const std::filesystem::path relative = modelPath.lexically_relative(SOURCE_RESOURCE_DIR);
+        std::filesystem::path cookedPath = relative.empty() || *relative.begin() == ".."
+            ? modelPath
+            : std::filesystem::path(BUILD_RESOURCE_DIR) / relative;
+        return cookedPath.replace_extension(".slmscene");
+    }
+
+    // A cooked file older than the glTF was cooked from a previous version of the model
+    bool isCookedSceneCurrent(const std::filesystem::path& cookedPath, const std::filesystem::path& modelPath) {
+        std::error_code error;
+        const auto cookedTime = std::filesystem::last_write_time(cookedPath, error);
+        if (error) {
+            return false;
+        }
+        const auto modelTime = std::filesystem::last_write_time(modelPath, error);
+        return !error && cookedTime >= modelTime;
+    }
+
+    // One unique texture; slot is its index in target, fixed before any decoding starts
+    struct TextureLoad {
+        std::string path; // File path, or a dedup key for embedded and cooked images
+        int textureIndex;
+        VkFormat format;  // Ignored for cooked textures, which carry the format chosen by the cooker
+        TextureDescriptorArray* target;
+        uint32_t slot;
+    };
+
+    // Decodes every load on the pool and uploads each one on the calling thread as soon as it is ready.
+    // Completion order varies between runs, but the slots do not.
+    void decodeAndUploadTextures(const std::vector<TextureLoad>& loads, const GLTFModel& model,
+                                 ThreadPool& pool, TextureManager& textureManager) {
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::queue<size_t> completed;
+        std::vector<DecodedImage> decoded(loads.size());
+        std::vector<std::exception_ptr> errors(loads.size());
+
+        std::vector<std::future<void>> jobs;
+        jobs.reserve(loads.size());
+        for (size_t i = 0; i < loads.size(); ++i) {
+            jobs.push_back(pool.submit([&, i]() {
+                try {
+                    const auto& encoded = model.textures[loads[i].textureIndex].encodedData;
+                    decoded[i] = encoded.empty()
+                        ? TextureManager::decodeImage(loads[i].path)
+                        : TextureManager::decodeImage(encoded.data(), encoded.size(), loads[i].path);
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+                std::lock_guard lock(mutex);
+                completed.push(i);
+                condition.notify_one();
+            }));
+        }
+
+        std::exception_ptr firstError;
+        for (size_t processed = 0; processed < loads.size(); ++processed) {
+            size_t index;
+            {
+                std::unique_lock lock(mutex);
+                condition.wait(lock, [&completed]() { return !completed.empty(); });
+                index = completed.front();
+                completed.pop();
+            }
+
+            if (errors[index] && !firstError) {
+                firstError = errors[index];
+            }
+            if (!firstError) {
+                try {
+                    const TextureLoad& load = loads[index];
+                    load.target->assign(load.slot, textureManager.uploadTexture(decoded[index], load.format, load.path));
+                } catch (...) {
+                    firstError = std::current_exception();
+                }
+            }
+            // Pixels are already copied into staging memory
+            decoded[index] = {};
+        }
+
+        // Jobs reference locals of this frame, so all of them must have returned before unwinding
+        for (auto& job : jobs) {
+            job.wait();
+        }
+        if (firstError) {
+            std::rethrow_exception(firstError);
+        }
+    }
+
+    // Cooked payloads are already mipped and in their final format: copy from the mapping into staging and go
+    void uploadCookedTextures(const std::vector<TextureLoad>& loads, const CookedScene& scene, TextureManager& textureManager) {
+        std::vector<VkDeviceSize> levelOffsets;
+        for (const auto& load : loads) {
+            const auto& record = scene.textures()[load.textureIndex];
+            if (record.format == VK_FORMAT_UNDEFINED || record.mipLevels == 0) {
+                throw std::runtime_error("Cooked scene has no payload for texture " + std::to_string(load.textureIndex));
+            }
+
+            levelOffsets.clear();
+            VkDeviceSize offset = 0;
+            for (uint32_t level = 0; level < record.mipLevels; ++level) {
+                levelOffsets.push_back(offset);
+                offset += CookedSceneFormat::levelSize(record.format,
+                    std::max(record.width >> level, 1u), std::max(record.height >> level, 1u));
+            }
+
+            const VkComponentMapping components{
+                static_cast<VkComponentSwizzle>(record.swizzle[0]), static_cast<VkComponentSwizzle>(record.swizzle[1]),
+                static_cast<VkComponentSwizzle>(record.swizzle[2]), static_cast<VkComponentSwizzle>(record.swizzle[3])
+            };
+            load.target->assign(load.slot, textureManager.uploadTextureLevels(
+                static_cast<VkFormat>(record.format), record.width, record.height,
+                scene.textureData(record), record.dataSize, levelOffsets, components, load.path));
+        }
+    }
+}
 #endif
 
 void MainSceneController::initialize(const RenderTarget::SharedResources& shared) {
@@ -14,16 +148,25 @@ void MainSceneController::initialize(const RenderTarget::SharedResources& shared
     createSamplers();
     loadModel(MODEL_PATH);
     createBuffers();
+    createCullingResources();
 
     // Initialize dependencies
     for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        m_dependencies.perFrameDepthTextures[i] = &(*shared.frames)[i].depthTexture;
+        m_dependencies.depthTextures[i] = &(*shared.frames)[i].depthTexture;
     }
 
     m_cubeMapRenderer.initialize(m_shared->context,
                           m_shared->bufferManager,
                           m_shared->textureManager);
 
+    // Passes register their attachments with the graph while initializing
+    m_frameGraph = std::make_unique<FrameGraph>(shared.context, shared.allocator);
+    m_dependencies.frameGraph = m_frameGraph.get();
+    m_dependencies.depth = m_frameGraph->importImage(
+        "Depth", VK_IMAGE_ASPECT_DEPTH_BIT, 1, VK_IMAGE_LAYOUT_UNDEFINED, true);
+    m_dependencies.swapchain = m_frameGraph->importImage(
+        "Swapchain", VK_IMAGE_ASPECT_COLOR_BIT, 1, VK_IMAGE_LAYOUT_UNDEFINED, true);
+
     m_shadowPass.initialize(shared, m_globalData, m_dependencies);
     createIBLResources();
 
@@ -32,6 +175,47 @@ void MainSceneController::initialize(const RenderTarget::SharedResources& shared
     m_gBufferPass.initialize(shared, m_globalData, m_dependencies);
     m_lightingPass.initialize(shared, m_globalData, m_dependencies);
     m_toneMappingPass.initialize(shared, m_globalData, m_dependencies);
+
+    buildFrameGraph();
+}
+
+void MainSceneController::buildFrameGraph() {
+    const auto addPass = [this](IRenderPass& pass, const char* name) {
+        m_frameGraph->addPass(name,
+            [this, &pass](FrameGraph::PassBuilder& builder) { pass.declare(builder, *m_shared->currentFrame); },
+            [this, &pass, name](VkCommandBuffer cmd) { executePass(cmd, pass, name, m_imageIndex); });
+    };
+
+    // Rendering order
+    addPass(m_shadowPass, "ShadowPass");
+    addPass(m_depthPrepass, "DepthPrepass");
+    // Fragment invocations of the G-buffer pass measure its overdraw (Stats panel)
+    m_frameGraph->addPass("GBufferPass",
+        [this](FrameGraph::PassBuilder& builder) { m_gBufferPass.declare(builder, *m_shared->currentFrame); },
+        [this](VkCommandBuffer cmd) {
+            m_shared->profiler->beginStatistics(cmd);
+            executePass(cmd, m_gBufferPass, "GBufferPass", m_imageIndex);
+            m_shared->profiler->endStatistics(cmd);
+        });
+    addPass(m_lightingPass, "LightingPass");
+    addPass(m_toneMappingPass, "ToneMappingPass");
+
+    // PRESENT_SRC_KHR, or TRANSFER_SRC for offscreen targets
+    m_frameGraph->exportImage(m_dependencies.swapchain,
+        m_shared->swapChain->presentLayout() == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+            ? FrameGraph::Usage::Present
+            : FrameGraph::Usage::TransferSrc);
+
+    compileFrameGraph();
+}
+
+void MainSceneController::compileFrameGraph() {
+    m_frameGraph->compile(m_shared->swapChain->extent());
+    m_shadowPass.updateAttachmentBindings();
+    m_depthPrepass.updateAttachmentBindings();
+    m_gBufferPass.updateAttachmentBindings();
+    m_lightingPass.updateAttachmentBindings();
+    m_toneMappingPass.updateAttachmentBindings();
 }
 
 void MainSceneController::cleanup() {
@@ -47,6 +231,7 @@ void MainSceneController::recreateSwapChain() {
         vkWaitForFences(m_shared->context->device(), 1,
                         &(*m_shared->frames)[i].inFlightFence, VK_TRUE, UINT64_MAX);
     }
+    compileFrameGraph();
     m_depthPrepass.recreateSwapChain();
     m_gBufferPass.recreateSwapChain();
     m_lightingPass.recreateSwapChain();
@@ -56,30 +241,36 @@ void MainSceneController::recreateSwapChain() {
 void MainSceneController::render(VkCommandBuffer cmd, uint32_t imageIndex) {
 
     updateUniformBuffers();
+    updateLights();
+
+    const VkExtent2D extent = m_shared->swapChain->extent();
+    const glm::mat4 view = m_shared->camera->GetViewMatrix();
+    const glm::mat4 proj = m_shared->camera->GetProjectionMatrix(
+        static_cast<float>(extent.width) / static_cast<float>(extent.height));
+    m_shadowPass.updateCascades(*m_shared->currentFrame, view, proj);
+
+    m_shared->profiler->beginScope(cmd, "Culling");
+    cullPrimitives(cmd);
+    m_shared->profiler->endScope(cmd);
+
+    m_shared->profiler->beginScope(cmd, "LightClusters");
+    m_lightClusterer.build(cmd, *m_shared->currentFrame, view, proj, extent);
+    m_shared->profiler->endScope(cmd);
+
+    // The graph records the passes with the barriers between them, then the export to the present layout
+    m_imageIndex = imageIndex;
+    m_frameGraph->bindImage(m_dependencies.depth, m_dependencies.depthTextures[*m_shared->currentFrame]->image);
+    // The frame waits for the acquire semaphore at color attachment output
+    m_frameGraph->bindAcquiredImage(m_dependencies.swapchain, m_shared->swapChain->getCurrentImage(imageIndex),
+                                    VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT);
+    m_frameGraph->execute(cmd);
+    m_shared->profiler->setFrameGraphStats(m_frameGraph->stats());
+}
 
-    // Transition swapchain images to initial layout
-    ImageTransitionManager::transitionColorAttachment(
-        cmd,
-        m_shared->swapChain->getCurrentImage(imageIndex),
-        VK_IMAGE_LAYOUT_UNDEFINED,
-        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
-    );
-
-    // Execute passes in rendering order
-    m_depthPrepass.execute(cmd, *m_shared->currentFrame, imageIndex);
-    m_gBufferPass.execute(cmd, *m_shared->currentFrame, imageIndex);
-    m_lightingPass.execute(cmd, *m_shared->currentFrame, imageIndex);
-    m_toneMappingPass.execute(cmd, *m_shared->currentFrame, imageIndex);
-
-
-    // ─── transition INTO PRESENT_SRC_KHR ───
-    ImageTransitionManager::transitionToPresent(
-        cmd,
-        m_shared->swapChain->getCurrentImage(imageIndex),
-        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-        VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
-    );
-
+void MainSceneController::executePass(VkCommandBuffer cmd, IRenderPass& pass, const char* name, uint32_t imageIndex) const {
+    m_shared->profiler->beginScope(cmd, name);
+    pass.execute(cmd, *m_shared->currentFrame, imageIndex);
+    m_shared->profiler->endScope(cmd);
 }
 
 void MainSceneController::updateUniformBuffers() const {
@@ -90,11 +281,95 @@ void MainSceneController::updateUniformBuffers() const {
         static_cast<float>(m_shared->swapChain->extent().width) /
         static_cast<float>(m_shared->swapChain->extent().height)
     );
+    ubo.invView = glm::inverse(ubo.view);
+    ubo.invProj = glm::inverse(ubo.proj);
     ubo.cameraPosition = m_shared->camera->Position;
 
     m_uniformBuffers[*m_shared->currentFrame].update(ubo);
 }
 
+void MainSceneController::updateLights() {
+    if (m_generatedStressLights != renderSettings.stressLights) {
+        m_generatedStressLights = std::min(renderSettings.stressLights, LightClusterer::MAX_LIGHTS - 1);
+
+        // The scene's own light stays at index 0
+        LightData sceneLight{};
+        sceneLight.position = glm::vec3(9.0f, 2.0f, -1.0f);
+        sceneLight.range = 10.f;
+        sceneLight.color = glm::vec3(1.f, 0.f, 0.f);
+        sceneLight.intensity = 100000.f;
+        sceneLight.type = LightType::Point;
+
+        m_lights = generateStressLights(m_generatedStressLights,
+                                        m_globalData.sceneAABB.min, m_globalData.sceneAABB.max);
+        m_lights.insert(m_lights.begin(), sceneLight);
+        renderSettings.stressLights = m_generatedStressLights;
+    }
+
+    m_lightClusterer.uploadLights(*m_shared->currentFrame, m_lights);
+}
+
+void MainSceneController::cullPrimitives(VkCommandBuffer cmd) {
+    // Depth prepass and G-buffer draw the same list
+    const glm::mat4 viewProj = m_shared->camera->GetProjectionMatrix(
+        static_cast<float>(m_shared->swapChain->extent().width) /
+        static_cast<float>(m_shared->swapChain->extent().height)
+    ) * m_shared->camera->GetViewMatrix();
+
+    // GPU views are culled together so they share their barriers
+    std::array<GpuCuller::View, 1 + SHADOW_CASCADE_COUNT> gpuViews;
+    uint32_t gpuViewCount = 0;
+
+    if (m_globalData.gpuCulling) {
+        gpuViews[gpuViewCount++] = { viewProj, &m_globalData.cameraDrawLists[*m_shared->currentFrame] };
+    } else {
+        m_frustumCuller.cull(viewProj, m_globalData.cameraVisiblePrimitives);
+    }
+
+    // Each redrawn shadow cascade draws only what its light frustum (extended back to the light) contains
+    for (uint32_t cascade = 0; cascade < SHADOW_CASCADE_COUNT; ++cascade) {
+        if (!m_shadowPass.cascadeNeedsRender(cascade)) {
+            continue;
+        }
+        const glm::mat4& lightViewProj = directionalLight.cascadeViewProj[cascade];
+        if (m_globalData.gpuCulling) {
+            gpuViews[gpuViewCount++] = { lightViewProj, &m_globalData.shadowDrawLists[cascade] };
+        } else {
+            m_frustumCuller.cull(lightViewProj, m_globalData.shadowVisiblePrimitives[cascade]);
+        }
+    }
+
+    m_gpuCuller.cull(cmd, std::span(gpuViews.data(), gpuViewCount));
+}
+
+void MainSceneController::createCullingResources() {
+    m_globalData.primitiveBuffer = SSBOBuffer(
+        m_shared->bufferManager,
+        m_shared->commandManager,
+        m_shared->allocator,
+        m_globalData.primitives.data(),
+        m_globalData.primitives.size() * sizeof(GLTFPrimitiveData)
+    );
+    m_globalData.primitiveBufferAddress = m_globalData.primitiveBuffer.getDeviceAddress(m_shared->context->device());
+
+    // The CPU culler stays as the fallback for devices without indirect count (and for --cpu-culling)
+    m_globalData.gpuCulling = m_shared->context->supportsIndirectCount() && !renderSettings.forceCpuCulling;
+    if (!m_globalData.gpuCulling) {
+        m_frustumCuller.setPrimitives(m_globalData.primitives);
+        return;
+    }
+
+    m_gpuCuller.initialize(m_shared->context, m_shared->bufferManager, m_shared->pipelineBuilds,
+                           m_globalData.primitiveBufferAddress,
+                           static_cast<uint32_t>(m_globalData.primitives.size()));
+    for (auto& drawList : m_globalData.cameraDrawLists) {
+        drawList = m_gpuCuller.createDrawList();
+    }
+    for (auto& drawList : m_globalData.shadowDrawLists) {
+        drawList = m_gpuCuller.createDrawList();
+    }
+}
+
 void MainSceneController::createSamplers() {
     VkDevice deviceCopy   = m_shared->context->device();
 
@@ -112,14 +387,14 @@ void MainSceneController::createSamplers() {
         .maxAnisotropy = 8.0f,
         .compareEnable = VK_FALSE,
         .minLod = 0.0f,
-        .maxLod = 8.0f,  // Match your mip levels
+        .maxLod = VK_LOD_CLAMP_NONE,
         .borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK,
         .unnormalizedCoordinates = VK_FALSE
     };
     vkCreateSampler(m_shared->context->device(), &samplerInfo, nullptr, &m_globalData.gBufferSampler);
 
     VkSampler gbufferSamplerCopy = m_globalData.gBufferSampler;
-    DeletionQueue::get().pushFunction("GbufferSampler_" + std::to_string(TextureManager::getSamplerIndex()), [deviceCopy, gbufferSamplerCopy]() {
+    DeletionQueue::get().push([deviceCopy, gbufferSamplerCopy]() {
         vkDestroySampler(deviceCopy, gbufferSamplerCopy, nullptr);
     });
 
@@ -134,7 +409,7 @@ void MainSceneController::createSamplers() {
     vkCreateSampler(m_shared->context->device(), &depthSamplerInfo, nullptr, &m_globalData.depthSampler);
 
     VkSampler depthSamplerCopy = m_globalData.depthSampler;
-    DeletionQueue::get().pushFunction("DepthSampler_" + std::to_string(TextureManager::getSamplerIndex()), [deviceCopy, depthSamplerCopy]() {
+    DeletionQueue::get().push([deviceCopy, depthSamplerCopy]() {
         vkDestroySampler(deviceCopy, depthSamplerCopy, nullptr);
     });
 
@@ -149,10 +424,10 @@ void MainSceneController::createSamplers() {
     shadowDepthSamplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
     shadowDepthSamplerInfo.compareEnable = VK_TRUE;
     shadowDepthSamplerInfo.compareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
-    vkCreateSampler(m_shared->context->device(), &depthSamplerInfo, nullptr, &m_globalData.shadowDepthSampler);
+    vkCreateSampler(m_shared->context->device(), &shadowDepthSamplerInfo, nullptr, &m_globalData.shadowDepthSampler);
 
     VkSampler shadowDepthSamplerCopy = m_globalData.shadowDepthSampler;
-    DeletionQueue::get().pushFunction("ShadowDepthSampler_" + std::to_string(TextureManager::getSamplerIndex()), [deviceCopy,  shadowDepthSamplerCopy]() {
+    DeletionQueue::get().push([deviceCopy,  shadowDepthSamplerCopy]() {
         vkDestroySampler(deviceCopy,  shadowDepthSamplerCopy, nullptr);
     });
 
@@ -178,16 +453,43 @@ void MainSceneController::createSamplers() {
     vkCreateSampler(m_shared->context->device(), &hdrSamplerInfo, nullptr, &m_globalData.hdrSampler);
 
     VkSampler samplerCopy = m_globalData.hdrSampler;
-    DeletionQueue::get().pushFunction("ToneMappingSampler_" + std::to_string(TextureManager::getSamplerIndex()), [deviceCopy, samplerCopy]() {
+    DeletionQueue::get().push([deviceCopy, samplerCopy]() {
         vkDestroySampler(deviceCopy, samplerCopy, nullptr);
     });
 }
 
 void MainSceneController::loadModel(const std::string& modelPath) {
 #ifdef USE_TINYGLTF
+    // The cooked scene is used in place from its mapping; without a current one, fall back to parsing the glTF
+    CookedScene cookedScene;
     GLTFModel gltfModel;
-    if (!GLTFLoader::LoadFromFile(modelPath, gltfModel)) {
-        throw std::runtime_error("Failed to load GLTF model");
+    GLTFModelView scene;
+    const std::filesystem::path cookedPath = cookedPathFor(modelPath);
+    bool cooked = false;
+    if (isCookedSceneCurrent(cookedPath, modelPath)) {
+        cooked = cookedScene.open(cookedPath.string());
+    } else if (std::filesystem::exists(cookedPath)) {
+        std::cerr << "Cooked scene " << cookedPath.string() << " is older than " << modelPath
+                  << ", loading glTF instead" << std::endl;
+    }
+    if (cooked && cookedScene.usesBlockCompression() && !m_shared->context->supportsTextureCompressionBC()) {
+        std::cerr << "Cooked scene uses BC textures but the device cannot sample them, loading glTF instead" << std::endl;
+        cooked = false;
+    }
+    if (cooked) {
+        globalScale = cookedScene.modelScale();
+        scene = {
+            .vertices = cookedScene.vertices(),
+            .indices = cookedScene.indices(),
+            .primitives = cookedScene.primitives(),
+            .materials = cookedScene.materials(),
+            .textureCount = cookedScene.textures().size()
+        };
+    } else {
+        if (!GLTFLoader::LoadFromFile(modelPath, gltfModel)) {
+            throw std::runtime_error("Failed to load GLTF model");
+        }
+        scene = gltfModel.view();
     }
 
     // Clear previous data
@@ -195,7 +497,7 @@ void MainSceneController::loadModel(const std::string& modelPath) {
     m_globalData.materialTextures.clear();
     m_globalData.normalTextures.clear();
 
-    if (gltfModel.vertices.empty()) {
+    if (scene.vertices.empty()) {
         // Empty model: set AABB to zero
         m_globalData.sceneAABB = { .min = glm::vec3(0.0f), .max = glm::vec3(0.0f) };
     } else {
@@ -204,7 +506,7 @@ void MainSceneController::loadModel(const std::string& modelPath) {
         auto maxAABB = glm::vec3(std::numeric_limits<float>::lowest());
 
         // Find min/max across all vertices
-        for (const auto& vertex : gltfModel.vertices) {
+        for (const auto& vertex : scene.vertices) {
             minAABB = glm::min(minAABB, vertex.pos);
             maxAABB = glm::max(maxAABB, vertex.pos);
         }
@@ -213,25 +515,42 @@ void MainSceneController::loadModel(const std::string& modelPath) {
         m_globalData.sceneAABB = { .min = minAABB, .max = maxAABB };
     }
 
+    // All model textures go out in as few submissions as the staging budget allows
+    m_shared->textureManager->beginUploadBatch();
+
     // Create a default white texture for base color (index 0)
     unsigned char white[] = {255, 255, 255, 255};
-    m_globalData.modelTextures.push_back(
-        m_shared->textureManager->createTexture(white, 1, 1, 4)
+    m_globalData.modelTextures.add(
+        m_shared->textureManager->createTexture(white, 1, 1, 4, "DefaultBaseColor")
     );
 
     // Separate texture maps for each type
     std::unordered_map<std::string, uint32_t> baseColorMap;
     std::unordered_map<std::string, uint32_t> normalMap;
     std::unordered_map<std::string, uint32_t> materialMap;
-    std::vector<std::string> defaultMaterialKeys; // Local deduplication
+    std::unordered_map<std::string, uint32_t> defaultMaterialMap; // Constant metal/rough textures
+    std::vector<TextureLoad> textureLoads;
+
+    // Embedded images have no file to dedupe on, so they are keyed by texture index
+    const std::string modelDirectory = std::filesystem::path(modelPath).parent_path().string();
+    auto textureKey = [&gltfModel, &modelDirectory, cooked](int textureIndex) {
+        if (cooked) {
+            return "#cooked_" + std::to_string(textureIndex);
+        }
+        const auto& texInfo = gltfModel.textures[textureIndex];
+        if (texInfo.uri.empty()) {
+            return "#embedded_" + std::to_string(textureIndex);
+        }
+        return modelDirectory + "/" + texInfo.uri;
+    };
 
     // Create SSBO for vertices
     m_globalData.vertexBuffer = SSBOBuffer(
         m_shared->bufferManager,
         m_shared->commandManager,
         m_shared->allocator,
-        gltfModel.vertices.data(),
-        sizeof(Vertex) * gltfModel.vertices.size()
+        scene.vertices.data(),
+        scene.vertices.size_bytes()
     );
     m_globalData.vertexBufferAddress = m_globalData.vertexBuffer.getDeviceAddress(m_shared->context->device());
 
@@ -240,59 +559,53 @@ void MainSceneController::loadModel(const std::string& modelPath) {
         m_shared->bufferManager,
         m_shared->commandManager,
         m_shared->allocator,
-        gltfModel.indices
+        scene.indices
     );
 
     // Process primitives
     m_globalData.primitives.clear();
-    m_globalData.primitives.reserve(gltfModel.primitives.size());
+    m_globalData.primitives.reserve(scene.primitives.size());
 
-    for (const auto& srcPrim : gltfModel.primitives) {
+    for (const auto& srcPrim : scene.primitives) {
         uint32_t baseColorIndex = 0; // Default to white texture
         uint32_t materialIndex = 0;
         uint32_t normalIndex = UINT32_MAX; // Indicates no normal map
 
-        if (srcPrim.materialIndex >= 0) {
-            const auto& mat = gltfModel.materials[srcPrim.materialIndex];
+        if (srcPrim.materialIndex < scene.materials.size()) {
+            const auto& mat = scene.materials[srcPrim.materialIndex];
 
             // Load base color texture
-            if (mat.baseColorTexture >= 0 && mat.baseColorTexture < gltfModel.textures.size()) {
-                const auto& texInfo = gltfModel.textures[mat.baseColorTexture];
-                std::string path = std::string(SOURCE_RESOURCE_DIR) + "/models/sponza/" + texInfo.uri;
+            if (mat.baseColorTexture >= 0 && mat.baseColorTexture < scene.textureCount) {
+                std::string path = textureKey(mat.baseColorTexture);
 
                 if (!baseColorMap.contains(path)) {
-                    baseColorMap[path] = m_globalData.modelTextures.size();
-                    m_globalData.modelTextures.push_back(
-                        m_shared->textureManager->loadTexture(path)
-                    );
+                    const uint32_t slot = m_globalData.modelTextures.reserve(); // Assigned once decoded
+                    baseColorMap[path] = slot;
+                    textureLoads.push_back({ path, mat.baseColorTexture, VK_FORMAT_R8G8B8A8_SRGB, &m_globalData.modelTextures, slot });
                 }
                 baseColorIndex = baseColorMap[path];
             }
 
             // Load normal texture
-            if (mat.normalTexture >= 0 && mat.normalTexture < gltfModel.textures.size()) {
-                const auto& texInfo = gltfModel.textures[mat.normalTexture];
-                std::string path = std::string(SOURCE_RESOURCE_DIR) + "/models/sponza/" + texInfo.uri;
+            if (mat.normalTexture >= 0 && mat.normalTexture < scene.textureCount) {
+                std::string path = textureKey(mat.normalTexture);
 
                 if (!normalMap.contains(path)) {
-                    normalMap[path] = m_globalData.normalTextures.size();
-                    m_globalData.normalTextures.push_back(
-                        m_shared->textureManager->loadTexture(path, VK_FORMAT_R8G8B8A8_UNORM)
-                    );
+                    const uint32_t slot = m_globalData.normalTextures.reserve();
+                    normalMap[path] = slot;
+                    textureLoads.push_back({ path, mat.normalTexture, VK_FORMAT_R8G8B8A8_UNORM, &m_globalData.normalTextures, slot });
                 }
                 normalIndex = normalMap[path];
             }
 
             // Load metallic-roughness texture
-            if (mat.metallicRoughnessTexture >= 0 && mat.metallicRoughnessTexture < gltfModel.textures.size()) {
-                const auto& texInfo = gltfModel.textures[mat.metallicRoughnessTexture];
-                std::string path = std::string(SOURCE_RESOURCE_DIR) + "/models/sponza/" + texInfo.uri;
+            if (mat.metallicRoughnessTexture >= 0 && mat.metallicRoughnessTexture < scene.textureCount) {
+                std::string path = textureKey(mat.metallicRoughnessTexture);
 
                 if (!materialMap.contains(path)) {
-                    materialMap[path] = m_globalData.materialTextures.size();
-                    m_globalData.materialTextures.push_back(
-                        m_shared->textureManager->loadTexture(path, VK_FORMAT_R8G8B8A8_SRGB)
-                    );
+                    const uint32_t slot = m_globalData.materialTextures.reserve();
+                    materialMap[path] = slot;
+                    textureLoads.push_back({ path, mat.metallicRoughnessTexture, VK_FORMAT_R8G8B8A8_UNORM, &m_globalData.materialTextures, slot });
                 }
                 materialIndex = materialMap[path];
             } else {
@@ -301,9 +614,9 @@ void MainSceneController::loadModel(const std::string& modelPath) {
                     std::to_string(mat.metallicFactor) + "_" +
                     std::to_string(mat.roughnessFactor);
 
-                auto it = std::ranges::find(defaultMaterialKeys, key);
-                if (it != defaultMaterialKeys.end()) {
-                    materialIndex = std::distance(defaultMaterialKeys.begin(), it);
+                auto it = defaultMaterialMap.find(key);
+                if (it != defaultMaterialMap.end()) {
+                    materialIndex = it->second;
                 } else {
                     unsigned char data[4] = {
                         0, // Unused
@@ -311,11 +624,10 @@ void MainSceneController::loadModel(const std::string& modelPath) {
                         static_cast<unsigned char>(mat.metallicFactor * 255),
                         255
                     };
-                    m_globalData.materialTextures.push_back(
-                        m_shared->textureManager->createTexture(data, 1, 1, 4)
+                    materialIndex = m_globalData.materialTextures.add(
+                        m_shared->textureManager->createTexture(data, 1, 1, 4, key)
                     );
-                    materialIndex = m_globalData.materialTextures.size() - 1;
-                    defaultMaterialKeys.push_back(key);
+                    defaultMaterialMap.emplace(key, materialIndex);
                 }
             }
         }
@@ -325,9 +637,18 @@ void MainSceneController::loadModel(const std::string& modelPath) {
             .indexCount = srcPrim.indexCount,
             .materialIndex = baseColorIndex,
             .metalRoughTextureIndex = materialIndex,
-            .normalTextureIndex = normalIndex
+            .normalTextureIndex = normalIndex,
+            .boundsCenter = (srcPrim.boundsMin + srcPrim.boundsMax) * 0.5f,
+            .boundsExtents = (srcPrim.boundsMax - srcPrim.boundsMin) * 0.5f
         });
     }
+
+    if (cooked) {
+        uploadCookedTextures(textureLoads, cookedScene, *m_shared->textureManager);
+    } else {
+        decodeAndUploadTextures(textureLoads, gltfModel, *m_shared->threadPool, *m_shared->textureManager);
+    }
+    m_shared->textureManager->endUploadBatch();
     #endif
 }
 
@@ -346,25 +667,6 @@ void MainSceneController::createBuffers() {
             .range = uboSize
         };
 
-        // Create an omni light buffer
-        VkDeviceSize lightSize = sizeof(PointLightData);
-        m_omniLightBuffer[i] = UniformBuffer(
-            m_shared->bufferManager,
-            m_shared->allocator,
-            lightSize
-        );
-        PointLightData lightData{};
-        lightData.pointLightPosition = glm::vec3(9.0f, 2.0f, -1.0f);
-        lightData.pointLightIntensity = 100000.f;
-        lightData.pointLightColor = glm::vec3(1.f, 0.f, 0.f);
-        lightData.pointLightRadius = 10.f;
-        m_omniLightBuffer[i].update(lightData);
-        m_globalData.frameData[i].omniLightBufferInfo = {
-            .buffer = m_omniLightBuffer[i].handle(),
-            .offset = 0,
-            .range = lightSize
-        };
-
         // Create a camera exposure buffer
         constexpr VkDeviceSize exposureSize = sizeof(CameraExposure);
         m_cameraExposureBuffer[i] = UniformBuffer(
@@ -381,37 +683,20 @@ void MainSceneController::createBuffers() {
         };
     }
 
-    // Fill texture descriptor info for each frame
+    // Light SSBOs and their cluster lists, filled every frame by updateLights and the cluster pass
+    m_lightClusterer.initialize(m_shared->context, m_shared->bufferManager, m_shared->allocator,
+                                m_shared->pipelineBuilds);
     for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-        // Model textures (base color)
-        m_globalData.frameData[i].textureImageInfos.clear();
-        for (const auto& tex : m_globalData.modelTextures) {
-            m_globalData.frameData[i].textureImageInfos.push_back({
-                .sampler = tex.sampler,
-                .imageView = tex.view,
-                .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-            });
-        }
-
-        // Material textures (metallic-roughness)
-        m_globalData.frameData[i].materialImageInfos.clear();
-        for (auto& tex : m_globalData.materialTextures) {
-            m_globalData.frameData[i].materialImageInfos.push_back({
-                .sampler = tex.sampler,
-                .imageView = tex.view,
-                .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-            });
-        }
+        m_globalData.frameData[i].lightBufferInfo = m_lightClusterer.lightBufferInfo(i);
+        m_globalData.frameData[i].lightClusterBufferInfo = m_lightClusterer.clusterBufferInfo(i);
+    }
 
-        // Normal textures
-        m_globalData.frameData[i].normalImageInfos.clear();
-        for (auto& tex : m_globalData.normalTextures) {
-            m_globalData.frameData[i].normalImageInfos.push_back({
-                .sampler = tex.sampler,
-                .imageView = tex.view,
-                .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-            });
-        }
+    // Fill texture descriptor info for each frame
+    const TextureRegistry& textures = m_shared->textureManager->registry();
+    for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+        m_globalData.frameData[i].textureImageInfos = m_globalData.modelTextures.imageInfos(textures);
+        m_globalData.frameData[i].materialImageInfos = m_globalData.materialTextures.imageInfos(textures);
+        m_globalData.frameData[i].normalImageInfos = m_globalData.normalTextures.imageInfos(textures);
     }
 }
 
@@ -422,14 +707,12 @@ uint32_t MainSceneController::createDefaultMaterialTexture(float metallicFactor,
         static_cast<unsigned char>(metallicFactor * 255),
         255
     };
-    ManagedTexture tex = m_shared->textureManager->createTexture(data, 1, 1, 4);
-    m_globalData.materialTextures.push_back(tex);
-    return static_cast<uint32_t>(m_globalData.materialTextures.size() - 1);
+    return m_globalData.materialTextures.add(m_shared->textureManager->createTexture(data, 1, 1, 4));
 }
 
 void MainSceneController::createIBLResources() {
     // Load HDR
-    m_hdrEquirect = m_shared->textureManager->loadHDRTexture( std::string(SOURCE_RESOURCE_DIR) + "/textures/circus_arena.hdr");
+    const TextureHandle hdrEquirect = m_shared->textureManager->loadHDRTexture( std::string(SOURCE_RESOURCE_DIR) + "/textures/circus_arena.hdr");
 
     // Create environment cube map
     m_envCubeMap = m_cubeMapRenderer.createCubeMap(1024, VK_FORMAT_R16G16B16A16_SFLOAT);
@@ -437,17 +720,18 @@ void MainSceneController::createIBLResources() {
 
     // Convert equirect to cube
     VkCommandBuffer cmd = m_shared->commandManager->beginSingleTimeCommands();
-    m_cubeMapRenderer.renderEquirectToCube(cmd, m_hdrEquirect, m_envCubeMap);
+    m_cubeMapRenderer.renderEquirectToCube(cmd, m_shared->textureManager->get(hdrEquirect), m_envCubeMap);
     m_irradianceMap = m_cubeMapRenderer.createDiffuseIrradianceMap(cmd, m_envCubeMap, 128);
-    m_shadowPass.execute(cmd, 0, 0);
     m_shared->commandManager->endSingleTimeCommands(cmd);
 
-    // Set in dependencies
-    m_dependencies.equirectTexture = &m_hdrEquirect;
-    m_dependencies.cubeMap = &m_envCubeMap.texture;
-    m_dependencies.cubeMap->view = m_envCubeMap.cubemapView;
+    // Only the cubes are sampled from here on
+    m_shared->textureManager->release(hdrEquirect);
 
-    m_dependencies.irradianceMap = &m_irradianceMap.texture;
-    m_dependencies.irradianceMap->view = m_irradianceMap.cubemapView;
+    // Set in dependencies
+    m_shared->textureManager->setView(m_envCubeMap.texture, m_envCubeMap.cubemapView);
+    m_shared->textureManager->setView(m_irradianceMap.texture, m_irradianceMap.cubemapView);
+    // Registry entries do not move, so the passes can hold on to them
+    m_dependencies.cubeMap = &m_shared->textureManager->get(m_envCubeMap.texture);
+    m_dependencies.irradianceMap = &m_shared->textureManager->get(m_irradianceMap.texture);
 
 }
@@ -6,8 +6,11 @@
 #include "user_passes/lighting_pass.h"
 #include "user_passes/tone_mapping_pass.h"
 #include "data_structures.h"
+#include "frame_graph.h"
 #include "uniform_buffer.h"
 #include "user_passes/shadow_pass.h"
+#include "culling/frustum_culler.h"
+#include "lighting/light_clusterer.h"
 
 class MainSceneController {
 public:
@@ -16,6 +19,9 @@ public:
     void recreateSwapChain();
     void render(VkCommandBuffer cmd, uint32_t imageIndex);
     void updateUniformBuffers() const;
+    void cullPrimitives(VkCommandBuffer cmd);
+    void createCullingResources();
+    void updateLights();
 
 private:
     void createSamplers();
@@ -23,6 +29,10 @@ private:
     void createBuffers();
     uint32_t createDefaultMaterialTexture(float metallicFactor, float roughnessFactor);
     void createIBLResources();
+    void executePass(VkCommandBuffer cmd, IRenderPass& pass, const char* name, uint32_t imageIndex) const;
+    void buildFrameGraph();
+    // Reallocates the graph's attachments for the current extent and rebinds them in the passes
+    void compileFrameGraph();
 
     // Passes
     DepthPrepass m_depthPrepass;
@@ -34,17 +44,23 @@ private:
     // Shared data
     MainSceneGlobalData m_globalData;
     PassDependencies m_dependencies;
+    std::unique_ptr<FrameGraph> m_frameGraph;
+    uint32_t m_imageIndex = 0;                  // Swapchain image of the frame the graph is recording
+    FrustumCuller m_frustumCuller;
+    GpuCuller m_gpuCuller;
+    LightClusterer m_lightClusterer;
+    std::vector<LightData> m_lights;            // Scene light first, then renderSettings.stressLights generated lights
+    uint32_t m_generatedStressLights = UINT32_MAX;
     const RenderTarget::SharedResources* m_shared = nullptr;
 
     CubeMapRenderer m_cubeMapRenderer;
     CubeMapRenderer::CubeMap m_envCubeMap;
     CubeMapRenderer::CubeMap m_irradianceMap;
-    ManagedTexture m_hdrEquirect;
 
     static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+    // Its cooked copy, written by the CookScene target, is used when present and newer
     const std::string MODEL_PATH = std::string(SOURCE_RESOURCE_DIR) + "/models/sponza/Sponza.gltf";
 
     std::array<UniformBuffer, MAX_FRAMES_IN_FLIGHT> m_uniformBuffers;
-    std::array<UniformBuffer, MAX_FRAMES_IN_FLIGHT> m_omniLightBuffer;
     std::array<UniformBuffer, MAX_FRAMES_IN_FLIGHT> m_cameraExposureBuffer;
 };